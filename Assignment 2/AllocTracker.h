@@ -0,0 +1,86 @@
+#ifndef ALLOC_TRACKER_H
+#define ALLOC_TRACKER_H
+
+// ––––– ALLOCATION TRACKING ––––– //
+// Counts every operator new in total, per frame and per PROFILE_SCOPE zone by replacing the
+// global allocation functions. Build with -DENABLE_ALLOC_TRACKING to turn it on; otherwise every
+// macro below expands to nothing and the standard allocator is left alone. Allocations made with
+// malloc inside SDL or the GL driver are not seen.
+//
+//     while (running) {
+//         ALLOC_FRAME_BEGIN();
+//         ...
+//         ALLOC_FRAME_END();
+//     }
+
+#ifdef ENABLE_ALLOC_TRACKING
+
+#include <cstdint>
+#include <cstdio>
+
+constexpr int ALLOC_ZONE_CAPACITY = 128;  // Distinct zone names; later ones share a catch-all row
+
+struct AllocationCounts
+{
+    std::uint64_t allocations = 0;
+    std::uint64_t bytes = 0;
+};
+
+// Allocations are charged to the innermost zone alive on the allocating thread
+class AllocZone
+{
+private:
+    int m_previous_slot;
+
+public:
+    explicit AllocZone(const char* name);  // Must outlive the report, e.g. a string literal
+    ~AllocZone();
+
+    AllocZone(const AllocZone&) = delete;
+    AllocZone& operator=(const AllocZone&) = delete;
+};
+
+// Allocations made while one of these is alive are not counted, for debugging aids like the HUD
+class AllocExempt
+{
+public:
+    AllocExempt();
+    ~AllocExempt();
+
+    AllocExempt(const AllocExempt&) = delete;
+    AllocExempt& operator=(const AllocExempt&) = delete;
+};
+
+void alloc_tracker_begin_frame();
+
+// After warmup_frames frames, a frame that allocates lists the zones responsible and aborts
+void alloc_tracker_end_frame();
+void alloc_tracker_require_steady_state(int warmup_frames);
+
+AllocationCounts alloc_tracker_get_last_frame();
+AllocationCounts alloc_tracker_get_total();
+
+// Totals per zone, one row each
+void alloc_tracker_write_report(std::FILE* file);
+
+#define ALLOC_CONCAT_INNER(a, b) a##b
+#define ALLOC_CONCAT(a, b) ALLOC_CONCAT_INNER(a, b)
+#define ALLOC_ZONE(name) AllocZone ALLOC_CONCAT(alloc_zone_, __LINE__)(name)
+#define ALLOC_EXEMPT_SCOPE() AllocExempt ALLOC_CONCAT(alloc_exempt_, __LINE__)
+#define ALLOC_FRAME_BEGIN() alloc_tracker_begin_frame()
+#define ALLOC_FRAME_END() alloc_tracker_end_frame()
+#define ALLOC_REQUIRE_STEADY_STATE(warmup_frames) (alloc_tracker_require_steady_state(warmup_frames), true)
+#define ALLOC_WRITE_REPORT(file) alloc_tracker_write_report(file)
+
+#else
+
+#define ALLOC_ZONE(name)
+#define ALLOC_EXEMPT_SCOPE()
+#define ALLOC_FRAME_BEGIN()
+#define ALLOC_FRAME_END()
+#define ALLOC_REQUIRE_STEADY_STATE(warmup_frames) ((void)(warmup_frames), false)
+#define ALLOC_WRITE_REPORT(file) ((void)(file))
+
+#endif
+
+#endif // ALLOC_TRACKER_H
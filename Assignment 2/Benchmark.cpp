@@ -0,0 +1,93 @@
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include "Benchmark.h"
+
+// Only ever written; being volatile, every write has to happen
+static const void* volatile g_benchmark_sink;
+
+void benchmark_sink(const void* value)
+{
+    g_benchmark_sink = value;
+}
+
+void BenchmarkSuite::add_result(const char* name, double nanoseconds_per_op, std::uint64_t operations)
+{
+    m_results.push_back({ name, nanoseconds_per_op, operations });
+    std::fprintf(stderr, "%-40s %12.2f ns/op\n", name, nanoseconds_per_op);
+}
+
+void BenchmarkSuite::write_json(std::FILE* file) const
+{
+    std::fprintf(file, "{\n  \"benchmarks\": [");
+    for (std::size_t i = 0; i < m_results.size(); i++)
+    {
+        const BenchmarkResult& result = m_results[i];
+        std::fprintf(file, "%s\n    { \"name\": \"%s\", \"ns_per_op\": %.4f, \"operations\": %llu }",
+            i == 0 ? "" : ",", result.name.c_str(), result.nanoseconds_per_op, (unsigned long long)result.operations);
+    }
+    std::fprintf(file, "\n  ]\n}\n");
+}
+
+bool BenchmarkSuite::save_json(const char* filepath) const
+{
+    std::FILE* file = std::fopen(filepath, "w");
+    if (file == nullptr) return false;
+
+    write_json(file);
+    return std::fclose(file) == 0;
+}
+
+// Reads back what write_json() writes; not a general JSON parser
+static bool load_baseline(const char* filepath, std::map<std::string, double>& baseline)
+{
+    std::ifstream file(filepath);
+    if (!file) return false;
+
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    const char NAME_KEY[] = "\"name\": \"";
+    const char TIME_KEY[] = "\"ns_per_op\": ";
+
+    std::size_t cursor = 0;
+    while ((cursor = text.find(NAME_KEY, cursor)) != std::string::npos)
+    {
+        std::size_t name_start = cursor + std::strlen(NAME_KEY);
+        std::size_t name_end = text.find('"', name_start);
+        std::size_t time_start = text.find(TIME_KEY, name_end);
+        if (name_end == std::string::npos || time_start == std::string::npos) break;
+
+        baseline[text.substr(name_start, name_end - name_start)] = std::strtod(text.c_str() + time_start + std::strlen(TIME_KEY), nullptr);
+        cursor = time_start;
+    }
+    return true;
+}
+
+int BenchmarkSuite::compare_with_baseline(const char* filepath, double threshold_percent) const
+{
+    std::map<std::string, double> baseline;
+    if (!load_baseline(filepath, baseline)) return -1;
+
+    int regressions = 0;
+    std::printf("%-40s %12s %12s %9s\n", "benchmark", "baseline", "current", "change");
+
+    for (const BenchmarkResult& result : m_results)
+    {
+        auto found = baseline.find(result.name);
+        if (found == baseline.end() || found->second <= 0.0)
+        {
+            std::printf("%-40s %12s %12.2f %9s\n", result.name.c_str(), "-", result.nanoseconds_per_op, "new");
+            continue;
+        }
+
+        // Positive means slower than the baseline
+        double change = (result.nanoseconds_per_op - found->second) / found->second * 100.0;
+        bool regressed = change > threshold_percent;
+        if (regressed) regressions++;
+
+        std::printf("%-40s %12.2f %12.2f %+8.1f%%%s\n", result.name.c_str(), found->second,
+            result.nanoseconds_per_op, change, regressed ? "  REGRESSION" : "");
+    }
+    return regressions;
+}
@@ -0,0 +1,117 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// ––––– MICROBENCHMARKS ––––– //
+struct BenchmarkResult
+{
+    std::string name;
+    double nanoseconds_per_op;
+    std::uint64_t operations;  // Timed operations in the reported sample
+};
+
+// Defined out of line so the compiler has to assume the value is used
+void benchmark_sink(const void* value);
+
+class BenchmarkSuite
+{
+private:
+    static constexpr int SAMPLE_COUNT = 5;
+    static constexpr std::uint64_t MAX_CALLS = 1ull << 30;
+
+    std::vector<BenchmarkResult> m_results;
+    double m_min_sample_seconds;
+
+    void add_result(const char* name, double nanoseconds_per_op, std::uint64_t operations);
+
+public:
+    explicit BenchmarkSuite(double min_sample_seconds = 0.05) : m_min_sample_seconds(min_sample_seconds) {}
+
+    // Times body(), which does ops_per_call operations, in batches long enough to measure.
+    // The fastest of SAMPLE_COUNT samples is kept, being the one least disturbed by the system.
+    template <typename Body>
+    void run(const char* name, int ops_per_call, Body body);
+
+    // As run(), but setup() restores state before every call and is left out of the timing
+    template <typename Setup, typename Body>
+    void run_with_setup(const char* name, int ops_per_call, Setup setup, Body body);
+
+    const std::vector<BenchmarkResult>& get_results() const { return m_results; }
+
+    void write_json(std::FILE* file) const;
+    bool save_json(const char* filepath) const;
+
+    // Prints each benchmark's change against a saved run. Returns how many got slower by
+    // more than threshold_percent, or -1 if the baseline can't be read.
+    int compare_with_baseline(const char* filepath, double threshold_percent) const;
+};
+
+template <typename Body>
+void BenchmarkSuite::run(const char* name, int ops_per_call, Body body)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    std::uint64_t calls = 1;
+    double best_seconds = 0.0;
+
+    for (int sample = 0; sample < SAMPLE_COUNT; sample++)
+    {
+        double seconds;
+        for (;;)
+        {
+            Clock::time_point start = Clock::now();
+            for (std::uint64_t i = 0; i < calls; i++) body();
+            seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+            if (seconds >= m_min_sample_seconds || calls >= MAX_CALLS) break;
+            calls *= 2;
+            sample = 0;  // Only samples at the final batch size count
+            best_seconds = 0.0;
+        }
+        if (best_seconds == 0.0 || seconds < best_seconds) best_seconds = seconds;
+    }
+
+    std::uint64_t operations = calls * ops_per_call;
+    add_result(name, best_seconds * 1.0e9 / operations, operations);
+}
+
+template <typename Setup, typename Body>
+void BenchmarkSuite::run_with_setup(const char* name, int ops_per_call, Setup setup, Body body)
+{
+    typedef std::chrono::steady_clock Clock;
+
+    std::uint64_t calls = 1;
+    double best_seconds = 0.0;
+
+    for (int sample = 0; sample < SAMPLE_COUNT; sample++)
+    {
+        double seconds;
+        for (;;)
+        {
+            seconds = 0.0;
+            for (std::uint64_t i = 0; i < calls; i++)
+            {
+                setup();
+                Clock::time_point start = Clock::now();
+                body();
+                seconds += std::chrono::duration<double>(Clock::now() - start).count();
+            }
+
+            if (seconds >= m_min_sample_seconds || calls >= MAX_CALLS) break;
+            calls *= 2;
+            sample = 0;
+            best_seconds = 0.0;
+        }
+        if (best_seconds == 0.0 || seconds < best_seconds) best_seconds = seconds;
+    }
+
+    std::uint64_t operations = calls * ops_per_call;
+    add_result(name, best_seconds * 1.0e9 / operations, operations);
+}
+
+#endif // BENCHMARK_H
@@ -0,0 +1,221 @@
+#include <SDL.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "CachedShaderProgram.h"
+#include "InputLog.h"
+
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+// File layout: magic, version, the key, the driver's binary format, then the binary itself
+constexpr char SHADER_CACHE_MAGIC[4] = { 'S', 'H', 'D', 'C' };
+constexpr std::uint8_t SHADER_CACHE_VERSION = 1;
+constexpr std::size_t SHADER_CACHE_HEADER_BYTES = sizeof(SHADER_CACHE_MAGIC) + 1 + sizeof(std::uint64_t) + sizeof(std::uint32_t);
+
+// Program binaries are core only from GL 4.1, so like the HUD's timer queries they are looked up at runtime
+typedef void (APIENTRY* GetProgramBinaryFunction)(GLuint, GLsizei, GLsizei*, GLenum*, void*);
+typedef void (APIENTRY* ProgramBinaryFunction)(GLuint, GLenum, const void*, GLsizei);
+typedef void (APIENTRY* ProgramParameteriFunction)(GLuint, GLenum, GLint);
+
+static GetProgramBinaryFunction get_program_binary = nullptr;
+static ProgramBinaryFunction program_binary = nullptr;
+static ProgramParameteriFunction program_parameteri = nullptr;
+
+static bool load_program_binary_functions()
+{
+    if (program_binary != nullptr) return true;
+
+    const char* version = (const char*)glGetString(GL_VERSION);
+    int major = 0, minor = 0;
+    bool is_core = version != nullptr && std::sscanf(version, "%d.%d", &major, &minor) == 2 &&
+        (major > 4 || (major == 4 && minor >= 1));
+    const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+    if (!is_core && (extensions == nullptr || std::strstr(extensions, "GL_ARB_get_program_binary") == nullptr)) return false;
+
+    // A driver may offer the calls yet support no binary format at all
+    GLint format_count = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &format_count);
+    if (format_count <= 0) return false;
+
+    get_program_binary = (GetProgramBinaryFunction)SDL_GL_GetProcAddress("glGetProgramBinary");
+    program_parameteri = (ProgramParameteriFunction)SDL_GL_GetProcAddress("glProgramParameteri");
+    program_binary = (ProgramBinaryFunction)SDL_GL_GetProcAddress("glProgramBinary");
+    if (get_program_binary && program_parameteri && program_binary) return true;
+    program_binary = nullptr;
+    return false;
+}
+
+static bool read_text_file(const char* filepath, std::string& text)
+{
+    std::ifstream file(filepath, std::ios::binary);
+    if (!file) return false;
+
+    text.assign((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return true;
+}
+
+static std::uint64_t hash_string(const char* text, std::uint64_t hash)
+{
+    // The terminator goes in too, so moving text from one string to the next changes the key
+    return text != nullptr ? hash_bytes(text, std::strlen(text) + 1, hash) : hash_bytes("", 1, hash);
+}
+
+static GLuint compile_shader(GLenum type, const char* source, const char* label)
+{
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint compiled = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    if (!compiled)
+    {
+        char message[512];
+        glGetShaderInfoLog(shader, sizeof(message), nullptr, message);
+        std::fprintf(stderr, "%s failed to compile: %s\n", label, message);
+    }
+    return shader;
+}
+
+void CachedShaderProgram::load(const char* vertex_shader_path, const char* fragment_shader_path)
+{
+    std::string vertex_source, fragment_source;
+    if (!read_text_file(vertex_shader_path, vertex_source) || !read_text_file(fragment_shader_path, fragment_source))
+    {
+        std::fprintf(stderr, "Unable to read shaders %s and %s\n", vertex_shader_path, fragment_shader_path);
+        return;
+    }
+
+    std::uint64_t key = hash_string(vertex_source.c_str(), STATE_HASH_SEED);
+    key = hash_string(fragment_source.c_str(), key);
+    key = hash_string((const char*)glGetString(GL_VENDOR), key);
+    key = hash_string((const char*)glGetString(GL_RENDERER), key);
+    key = hash_string((const char*)glGetString(GL_VERSION), key);
+
+    std::string cache_path = std::string(vertex_shader_path) + ".cache";
+    bool has_binaries = load_program_binary_functions();
+
+    if (!has_binaries || !load_binary(cache_path.c_str(), key))
+    {
+        if (!compile(vertex_source.c_str(), fragment_source.c_str()))
+        {
+            std::fprintf(stderr, "Shaders %s and %s failed to link\n", vertex_shader_path, fragment_shader_path);
+        }
+        else if (has_binaries) save_binary(cache_path.c_str(), key);
+    }
+
+    m_model_matrix_uniform = glGetUniformLocation(m_program_id, "modelMatrix");
+    m_view_matrix_uniform = glGetUniformLocation(m_program_id, "viewMatrix");
+    m_projection_matrix_uniform = glGetUniformLocation(m_program_id, "projectionMatrix");
+    m_position_attribute = (GLuint)glGetAttribLocation(m_program_id, "position");
+    m_tex_coordinate_attribute = (GLuint)glGetAttribLocation(m_program_id, "texCoord");
+}
+
+// False for a missing or stale cache, or a binary this driver will no longer take
+bool CachedShaderProgram::load_binary(const char* cache_path, std::uint64_t key)
+{
+    std::ifstream file(cache_path, std::ios::binary);
+    if (!file) return false;
+
+    std::vector<std::uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (bytes.size() <= SHADER_CACHE_HEADER_BYTES) return false;
+    if (std::memcmp(bytes.data(), SHADER_CACHE_MAGIC, sizeof(SHADER_CACHE_MAGIC)) != 0) return false;
+    if (bytes[4] != SHADER_CACHE_VERSION) return false;
+
+    std::uint64_t cached_key;
+    std::uint32_t format;
+    std::memcpy(&cached_key, &bytes[5], sizeof(cached_key));
+    std::memcpy(&format, &bytes[5 + sizeof(cached_key)], sizeof(format));
+    if (cached_key != key) return false;
+
+    GLuint program = glCreateProgram();
+    program_binary(program, (GLenum)format, &bytes[SHADER_CACHE_HEADER_BYTES], (GLsizei)(bytes.size() - SHADER_CACHE_HEADER_BYTES));
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked)
+    {
+        glDeleteProgram(program);
+        return false;
+    }
+
+    m_program_id = program;
+    return true;
+}
+
+bool CachedShaderProgram::compile(const char* vertex_source, const char* fragment_source)
+{
+    GLuint vertex_shader = compile_shader(GL_VERTEX_SHADER, vertex_source, "Vertex shader");
+    GLuint fragment_shader = compile_shader(GL_FRAGMENT_SHADER, fragment_source, "Fragment shader");
+
+    m_program_id = glCreateProgram();
+    glAttachShader(m_program_id, vertex_shader);
+    glAttachShader(m_program_id, fragment_shader);
+    if (program_binary != nullptr) program_parameteri(m_program_id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    glLinkProgram(m_program_id);
+
+    // The linked program keeps what it needs, so the shaders can go
+    glDetachShader(m_program_id, vertex_shader);
+    glDetachShader(m_program_id, fragment_shader);
+    glDeleteShader(vertex_shader);
+    glDeleteShader(fragment_shader);
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(m_program_id, GL_LINK_STATUS, &linked);
+    return linked == GL_TRUE;
+}
+
+// Failing to write the cache only costs the next start a compile, so it is not reported
+void CachedShaderProgram::save_binary(const char* cache_path, std::uint64_t key) const
+{
+    GLint length = 0;
+    glGetProgramiv(m_program_id, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+
+    std::vector<std::uint8_t> bytes(SHADER_CACHE_HEADER_BYTES + (std::size_t)length);
+    GLenum format = 0;
+    GLsizei written = 0;
+    get_program_binary(m_program_id, length, &written, &format, &bytes[SHADER_CACHE_HEADER_BYTES]);
+    if (written <= 0) return;
+    bytes.resize(SHADER_CACHE_HEADER_BYTES + (std::size_t)written);
+
+    std::uint32_t stored_format = format;
+    std::memcpy(bytes.data(), SHADER_CACHE_MAGIC, sizeof(SHADER_CACHE_MAGIC));
+    bytes[4] = SHADER_CACHE_VERSION;
+    std::memcpy(&bytes[5], &key, sizeof(key));
+    std::memcpy(&bytes[5 + sizeof(key)], &stored_format, sizeof(stored_format));
+
+    std::ofstream file(cache_path, std::ios::binary);
+    if (file) file.write((const char*)bytes.data(), (std::streamsize)bytes.size());
+}
+
+void CachedShaderProgram::cleanup()
+{
+    glDeleteProgram(m_program_id);
+    m_program_id = 0;
+}
+
+void CachedShaderProgram::set_model_matrix(const glm::mat4& matrix)
+{
+    glUseProgram(m_program_id);
+    glUniformMatrix4fv(m_model_matrix_uniform, 1, GL_FALSE, &matrix[0][0]);
+}
+
+void CachedShaderProgram::set_view_matrix(const glm::mat4& matrix)
+{
+    glUseProgram(m_program_id);
+    glUniformMatrix4fv(m_view_matrix_uniform, 1, GL_FALSE, &matrix[0][0]);
+}
+
+void CachedShaderProgram::set_projection_matrix(const glm::mat4& matrix)
+{
+    glUseProgram(m_program_id);
+    glUniformMatrix4fv(m_projection_matrix_uniform, 1, GL_FALSE, &matrix[0][0]);
+}
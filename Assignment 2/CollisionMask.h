@@ -0,0 +1,47 @@
+#ifndef COLLISION_MASK_H
+#define COLLISION_MASK_H
+
+#include <cstdint>
+#include <vector>
+#include "glm/glm.hpp"
+#include "Fixed.h"
+
+// Solid pixels of one sprite frame, resampled to a fixed world resolution so any two
+// masks line up pixel for pixel. Each row is packed into 64-bit words, so an overlap test
+// is one shift and one AND per overlapping row and word; anything up to two units wide
+// takes a single word per row.
+class CollisionMask
+{
+private:
+    int m_width = 0, m_height = 0;
+    int m_words_per_row = 0;
+    std::vector<std::uint64_t> m_rows;  // Bottom row first; bit i of a row's word w is column 64 * w + i from the left
+
+public:
+    static constexpr float PIXELS_PER_UNIT = 32.0f;
+
+    // Samples the frame at (frame_x, frame_y, frame_width, frame_height) of an RGBA image
+    // (top row first, as stbi_load returns it) for a sprite drawn world_width by world_height.
+    void build(const unsigned char* rgba, int image_width, int image_height,
+        int frame_x, int frame_y, int frame_width, int frame_height,
+        float world_width, float world_height, unsigned char alpha_threshold = 128);
+
+    // An empty mask (e.g. the image failed to load) counts as solid, so callers fall back to the box test
+    bool is_empty() const { return m_rows.empty(); }
+    int get_width() const { return m_width; }
+    int get_height() const { return m_height; }
+    int get_words_per_row() const { return m_words_per_row; }
+
+    // The 64 columns of a row from first_col on. first_col may be negative or run past the
+    // right edge; columns outside the mask read as empty.
+    std::uint64_t get_bits(int row, int first_col) const;
+};
+
+// Exact overlap of two masks centred at the given world positions. Run it only after a box test passes.
+bool masks_overlap(const CollisionMask& a, glm::vec3 a_centre, const CollisionMask& b, glm::vec3 b_centre);
+
+// The same test in integers, for the fixed-point simulation. Agrees with the float version
+// whenever the centres are on the Q16.16 grid.
+bool masks_overlap(const CollisionMask& a, Fixed a_x, Fixed a_y, const CollisionMask& b, Fixed b_x, Fixed b_y);
+
+#endif // COLLISION_MASK_H
@@ -0,0 +1,101 @@
+#ifndef DYNAMIC_RESOLUTION_H
+#define DYNAMIC_RESOLUTION_H
+
+#include <cstdint>
+#include "glm/mat4x4.hpp"
+#include "CachedShaderProgram.h"
+
+// ––––– DYNAMIC RESOLUTION ––––– //
+// The scene is drawn into an offscreen target at a fraction of the window's resolution, then
+// scaled up to the window with nearest filtering so the pixel art stays sharp. A controller
+// picks the fraction from how long frames take to render, giving up resolution to hold the
+// frame budget on slow or software-rendered machines:
+//
+//     resolution.add_frame(work_milliseconds);     // Last frame's render time
+//     resolution.begin();                          // Before clearing
+//     ...draw the scene...
+//     resolution.end(&program, projection, view);  // Overlays drawn after this are full size
+//
+// Where framebuffer objects are missing, begin() and end() do nothing and the scene is drawn
+// straight to the window as before.
+
+struct ResolutionSettings
+{
+    float target_milliseconds = 16.0f;  // Under 60 Hz's 16.7 ms, leaving room for the swap
+    float min_scale = 0.5f;
+    float max_scale = 1.0f;
+    float scale_step = 0.1f;
+};
+
+// What the controller has done, for the HUD and the summary printed at exit
+struct ResolutionTelemetry
+{
+    float scale = 1.0f;
+    float smoothed_milliseconds = 0.0f;
+    std::uint64_t frames = 0;
+    std::uint64_t frames_over_budget = 0;
+    int scale_downs = 0;
+    int scale_ups = 0;
+    double scale_total = 0.0;  // Summed over frames, for the average
+};
+
+// Chooses the scale from one work time per frame, with no GL. Render cost is taken to follow
+// the pixel count, so the square of the scale. The hysteresis that stops it hunting between
+// two sizes comes from three places: it drops only after several frames over budget and rises
+// only after many under; it rises only if the cost predicted at the next size up still leaves
+// a margin; and after each change it lets the new size settle before judging it.
+class ResolutionController
+{
+private:
+    static constexpr int FRAMES_TO_LOWER = 6;
+    static constexpr int FRAMES_TO_RAISE = 60;
+    static constexpr int SETTLE_FRAMES = 10;
+    static constexpr float RAISE_MARGIN = 0.85f;  // Of the budget, for the predicted cost after raising
+    static constexpr float SMOOTHING = 0.1f;      // Weight of each new frame in the moving average
+
+    ResolutionSettings m_settings;
+    ResolutionTelemetry m_telemetry;
+    int m_frames_over = 0;
+    int m_frames_under = 0;
+    int m_settle_frames = 0;
+
+    void change_scale(float scale);
+
+public:
+    explicit ResolutionController(ResolutionSettings settings = ResolutionSettings());
+
+    void add_frame(float work_milliseconds);
+
+    float get_scale() const { return m_telemetry.scale; }
+    const ResolutionSettings& get_settings() const { return m_settings; }
+    const ResolutionTelemetry& get_telemetry() const { return m_telemetry; }
+};
+
+class DynamicResolution
+{
+private:
+    ResolutionController m_controller;
+    GLuint m_framebuffer = 0;
+    GLuint m_texture = 0;
+    int m_window_width = 0, m_window_height = 0;  // Also the texture's size; smaller scales use its corner
+    int m_width = 0, m_height = 0;                // Drawn at this frame
+    bool m_is_enabled = false;
+
+public:
+    // Needs a current GL context; starts at settings.max_scale
+    void initialise(int window_width, int window_height, ResolutionSettings settings);
+
+    void add_frame(float work_milliseconds) { if (m_is_enabled) m_controller.add_frame(work_milliseconds); }
+
+    void begin();
+
+    // Scales the frame up to the window, then puts back the matrices the scene was drawn with
+    void end(CachedShaderProgram* program, const glm::mat4& projection_matrix, const glm::mat4& view_matrix);
+
+    bool is_enabled() const { return m_is_enabled; }
+    int get_width() const { return m_width; }
+    int get_height() const { return m_height; }
+    const ResolutionController& get_controller() const { return m_controller; }
+};
+
+#endif // DYNAMIC_RESOLUTION_H
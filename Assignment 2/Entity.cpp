@@ -10,8 +10,10 @@
 #include <SDL_opengl.h>
 #include "glm/mat4x4.hpp"
 #include "glm/gtc/matrix_transform.hpp"
-#include "ShaderProgram.h"
+#include "CachedShaderProgram.h"
 #include "Entity.h"
+#include "PerfHud.h"
+#include "Profiler.h"
 
 // Default constructor
 Entity::Entity()
@@ -56,7 +58,7 @@ Entity::Entity(GLuint texture_id, float speed, float width, float height, Entity
 
 Entity::~Entity() { }
 
-void Entity::draw_sprite_from_texture_atlas(ShaderProgram* program, GLuint texture_id, int index)
+void Entity::draw_sprite_from_texture_atlas(CachedShaderProgram* program, GLuint texture_id, int index)
 {
     // Step 1: Calculate the UV location of the indexed frame
     float u_coord = (float)(index % m_animation_cols) / (float)m_animation_cols;
@@ -80,18 +82,18 @@ void Entity::draw_sprite_from_texture_atlas(ShaderProgram* program, GLuint textu
     };
 
     // Step 4: And render
-    glBindTexture(GL_TEXTURE_2D, texture_id);
+    counted_bind_texture(GL_TEXTURE_2D, texture_id);
 
-    glVertexAttribPointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, vertices);
-    glEnableVertexAttribArray(program->get_position_attribute());
+    traced_vertex_attrib_pointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, vertices);
+    traced_enable_vertex_attrib_array(program->get_position_attribute());
 
-    glVertexAttribPointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, tex_coords);
-    glEnableVertexAttribArray(program->get_tex_coordinate_attribute());
+    traced_vertex_attrib_pointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, tex_coords);
+    traced_enable_vertex_attrib_array(program->get_tex_coordinate_attribute());
 
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    counted_draw_arrays(GL_TRIANGLES, 0, 6);
 
-    glDisableVertexAttribArray(program->get_position_attribute());
-    glDisableVertexAttribArray(program->get_tex_coordinate_attribute());
+    traced_disable_vertex_attrib_array(program->get_position_attribute());
+    traced_disable_vertex_attrib_array(program->get_tex_coordinate_attribute());
 }
 
 bool const Entity::check_collision(Entity* other) const
@@ -164,6 +166,7 @@ void const Entity::check_collision_x(Entity* collidable_entities, int collidable
 }
 
 void Entity::update_ai(float delta_time) {
+    PROFILE_SCOPE("Entity::update_ai");
     if (m_is_ai_controlled) {
         // Moving AI up or down based on the current direction
         if (m_ai_moving_up) {
@@ -192,6 +195,7 @@ void Entity::update_ai(float delta_time) {
 
 void Entity::update(float delta_time, Entity* collidable_entities, int collidable_entity_count)
 {
+    PROFILE_SCOPE("Entity::update");
     m_collided_top = false;
     m_collided_bottom = false;
     m_collided_left = false;
@@ -235,15 +239,21 @@ void Entity::update(float delta_time, Entity* collidable_entities, int collidabl
         check_collision_x(collidable_entities, collidable_entity_count);
     }
 
+    update_model_matrix();
+}
+
+void Entity::update_model_matrix()
+{
     m_model_matrix = glm::mat4(1.0f);
     m_model_matrix = glm::translate(m_model_matrix, m_position);
     m_model_matrix = glm::scale(m_model_matrix, m_scale);
 }
 
-void Entity::render(ShaderProgram* program)
+void Entity::render(CachedShaderProgram* program)
 {
-    program->set_model_matrix(m_model_matrix);
-    glUseProgram(program->get_program_id());
+    PROFILE_SCOPE("Entity::render");
+    counted_set_model_matrix(program, m_model_matrix);
+    counted_use_program(program->get_program_id());
 
     float vertices[] =
     {
@@ -265,15 +275,15 @@ void Entity::render(ShaderProgram* program)
         0.0f, 0.0f
     };
 
-    glVertexAttribPointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, vertices);
-    glEnableVertexAttribArray(program->get_position_attribute());
+    traced_vertex_attrib_pointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, vertices);
+    traced_enable_vertex_attrib_array(program->get_position_attribute());
 
-    glVertexAttribPointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, tex_coords);
-    glEnableVertexAttribArray(program->get_tex_coordinate_attribute());
+    traced_vertex_attrib_pointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, tex_coords);
+    traced_enable_vertex_attrib_array(program->get_tex_coordinate_attribute());
 
-    glBindTexture(GL_TEXTURE_2D, m_texture_id);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    counted_bind_texture(GL_TEXTURE_2D, m_texture_id);
+    counted_draw_arrays(GL_TRIANGLES, 0, 6);
 
-    glDisableVertexAttribArray(program->get_position_attribute());
-    glDisableVertexAttribArray(program->get_tex_coordinate_attribute());
+    traced_disable_vertex_attrib_array(program->get_position_attribute());
+    traced_disable_vertex_attrib_array(program->get_tex_coordinate_attribute());
 }
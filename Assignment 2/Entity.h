@@ -2,7 +2,7 @@
 #define ENTITY_H
 
 #include "glm/glm.hpp"
-#include "ShaderProgram.h"
+#include "CachedShaderProgram.h"
 
 enum AnimationDirection { LEFT, RIGHT, UP, DOWN };
 enum EntityType { PADDLE, BALL };  // Added EntityType enum
@@ -64,13 +64,14 @@ public:
     Entity(GLuint texture_id, float speed, float width, float height, EntityType type);
     ~Entity();
 
-    void draw_sprite_from_texture_atlas(ShaderProgram* program, GLuint texture_id, int index);
+    void draw_sprite_from_texture_atlas(CachedShaderProgram* program, GLuint texture_id, int index);
     bool const check_collision(Entity* other) const;
 
     void const check_collision_y(Entity* collidable_entities, int collidable_entity_count);
     void const check_collision_x(Entity* collidable_entities, int collidable_entity_count);
     void update(float delta_time, Entity* collidable_entities, int collidable_entity_count);
-    void render(ShaderProgram* program);
+    void update_model_matrix();  // After moving the entity outside update(), e.g. restoring a snapshot
+    void render(CachedShaderProgram* program);
 
     void normalise_movement() { m_movement = glm::normalize(m_movement); }
 
@@ -104,6 +105,7 @@ public:
     bool      const get_collided_right() const { return m_collided_right; }
     bool      const get_collided_left() const { return m_collided_left; }
     bool      is_ai_controlled() const { return m_is_ai_controlled; } // Getter for AI control
+    bool      is_ai_moving_up() const { return m_ai_moving_up; }
 
     // ————— SETTERS ————— //
     void const set_position(glm::vec3 new_position) { m_position = new_position; }
@@ -136,6 +138,7 @@ public:
 
     // More AI
     void toggle_ai_control() { m_is_ai_controlled = !m_is_ai_controlled; } // Toggle for AI control
+    void set_ai_control(bool is_controlled, bool is_moving_up) { m_is_ai_controlled = is_controlled; m_ai_moving_up = is_moving_up; }
     void update_ai(float delta_time); // Method for AI update
 };
 
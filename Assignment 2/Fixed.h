@@ -0,0 +1,48 @@
+#ifndef FIXED_H
+#define FIXED_H
+
+#include <cstdint>
+
+// ––––– FIXED POINT ––––– //
+// Q16.16 numbers: an int32 counting 1/65536ths, covering +/-32768. Integer adds, multiplies
+// and shifts give the same bits on every compiler, flag and CPU, which float arithmetic does
+// not once FMA contraction or x87 precision get involved.
+//
+// Any Q16.16 value under 256 in magnitude is exactly a float (24 significant bits), so state
+// can keep the float fields it already has: converting in and out is exact, and only the
+// arithmetic between has to be done here.
+struct Fixed
+{
+    std::int32_t raw;
+
+    static constexpr int FRACTION_BITS = 16;
+    static constexpr std::int32_t ONE = 1 << FRACTION_BITS;
+
+    static constexpr Fixed from_raw(std::int32_t raw) { return { raw }; }
+
+    // Scaling by a power of two is exact, so the only rounding is the truncation toward zero
+    // of anything finer than 1/65536; values already on the grid come back unchanged
+    static constexpr Fixed from_float(float value) { return { (std::int32_t)(value * (float)ONE) }; }
+    constexpr float to_float() const { return (float)raw * (1.0f / (float)ONE); }
+};
+
+constexpr Fixed operator+(Fixed a, Fixed b) { return { a.raw + b.raw }; }
+constexpr Fixed operator-(Fixed a, Fixed b) { return { a.raw - b.raw }; }
+constexpr Fixed operator-(Fixed a) { return { -a.raw }; }
+
+// Rounds toward negative infinity, as the right shift of the 64-bit product does
+constexpr Fixed operator*(Fixed a, Fixed b)
+{
+    return { (std::int32_t)(((std::int64_t)a.raw * b.raw) >> Fixed::FRACTION_BITS) };
+}
+
+constexpr bool operator<(Fixed a, Fixed b) { return a.raw < b.raw; }
+constexpr bool operator>(Fixed a, Fixed b) { return a.raw > b.raw; }
+constexpr bool operator<=(Fixed a, Fixed b) { return a.raw <= b.raw; }
+constexpr bool operator>=(Fixed a, Fixed b) { return a.raw >= b.raw; }
+constexpr bool operator==(Fixed a, Fixed b) { return a.raw == b.raw; }
+constexpr bool operator!=(Fixed a, Fixed b) { return a.raw != b.raw; }
+
+constexpr Fixed fixed_abs(Fixed value) { return value.raw < 0 ? -value : value; }
+
+#endif // FIXED_H
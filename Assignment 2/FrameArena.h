@@ -0,0 +1,62 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <cstddef>
+#include <vector>
+
+// ––––– FRAME ARENA ––––– //
+constexpr std::size_t FRAME_ARENA_CAPACITY = 64 * 1024;
+
+// Bump allocator for temporaries that live no longer than a frame. reset() at the top of the
+// frame releases everything at once. A frame that needs more than the buffer gets the excess
+// from the heap, and the buffer grows at the next reset so later frames stop allocating.
+class FrameArena
+{
+private:
+    unsigned char* m_buffer;
+    std::size_t m_capacity;
+    std::size_t m_offset = 0;
+    std::size_t m_overflow_bytes = 0;
+    std::size_t m_high_water = 0;
+    std::vector<void*> m_overflow_blocks;
+
+public:
+    explicit FrameArena(std::size_t capacity);
+    ~FrameArena();
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    void* allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t));
+    void reset();
+
+    std::size_t get_capacity() const { return m_capacity; }
+    std::size_t get_used() const { return m_offset + m_overflow_bytes; }
+    std::size_t get_high_water() const { return m_high_water; }  // Most any frame has used
+};
+
+extern FrameArena g_frame_arena;
+
+// Standard allocator over g_frame_arena; containers using it must not outlive the frame
+template <typename T>
+struct FrameAllocator
+{
+    typedef T value_type;
+
+    FrameAllocator() = default;
+    template <typename U>
+    FrameAllocator(const FrameAllocator<U>&) {}
+
+    T* allocate(std::size_t count) { return static_cast<T*>(g_frame_arena.allocate(count * sizeof(T), alignof(T))); }
+    void deallocate(T*, std::size_t) {}  // Released in bulk by reset()
+};
+
+template <typename T, typename U>
+bool operator==(const FrameAllocator<T>&, const FrameAllocator<U>&) { return true; }
+template <typename T, typename U>
+bool operator!=(const FrameAllocator<T>&, const FrameAllocator<U>&) { return false; }
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+#endif // FRAME_ARENA_H
@@ -0,0 +1,194 @@
+#include <cstring>
+#include "GlCapture.h"
+
+GlCapture g_gl_capture;
+
+bool GlCapture::start(const char* filepath, int frames)
+{
+    finish();
+
+    m_file = std::fopen(filepath, "wb");
+    if (m_file == nullptr) return false;
+
+    GlTraceHeader header = { GL_TRACE_MAGIC, GL_TRACE_VERSION };
+    std::fwrite(&header, sizeof(header), 1, m_file);
+
+    m_frames_left = frames;
+    for (AttributeArray& attribute : m_attributes) attribute = AttributeArray();
+    return true;
+}
+
+void GlCapture::finish()
+{
+    if (m_file == nullptr) return;
+
+    std::fclose(m_file);
+    m_file = nullptr;
+}
+
+void GlCapture::write_command(GlTraceOp op, const void* payload, std::size_t payload_bytes,
+    const void* data, std::size_t data_bytes)
+{
+    GlTraceCommand command = { op, 0, (std::uint32_t)(payload_bytes + data_bytes) };
+    std::fwrite(&command, sizeof(command), 1, m_file);
+    if (payload_bytes > 0) std::fwrite(payload, payload_bytes, 1, m_file);
+    if (data_bytes > 0) std::fwrite(data, data_bytes, 1, m_file);
+}
+
+void GlCapture::end_setup()
+{
+    if (m_file != nullptr) write_command(TRACE_SETUP_END, nullptr, 0);
+}
+
+bool GlCapture::end_frame()
+{
+    if (m_file == nullptr) return false;
+
+    write_command(TRACE_FRAME_END, nullptr, 0);
+    if (--m_frames_left > 0) return false;
+
+    finish();
+    return true;
+}
+
+void GlCapture::record_viewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+    TraceViewport payload = { x, y, width, height };
+    write_command(TRACE_VIEWPORT, &payload, sizeof(payload));
+}
+
+void GlCapture::record_clear_color(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+    TraceClearColor payload = { red, green, blue, alpha };
+    write_command(TRACE_CLEAR_COLOR, &payload, sizeof(payload));
+}
+
+void GlCapture::record_clear(GLbitfield mask)
+{
+    TraceClear payload = { mask };
+    write_command(TRACE_CLEAR, &payload, sizeof(payload));
+}
+
+void GlCapture::record_enable(GLenum capability)
+{
+    TraceEnable payload = { capability };
+    write_command(TRACE_ENABLE, &payload, sizeof(payload));
+}
+
+void GlCapture::record_blend_func(GLenum source, GLenum destination)
+{
+    TraceBlendFunc payload = { source, destination };
+    write_command(TRACE_BLEND_FUNC, &payload, sizeof(payload));
+}
+
+void GlCapture::record_blend_func_separate(GLenum source_rgb, GLenum destination_rgb, GLenum source_alpha, GLenum destination_alpha)
+{
+    TraceBlendFuncSeparate payload = { source_rgb, destination_rgb, source_alpha, destination_alpha };
+    write_command(TRACE_BLEND_FUNC_SEPARATE, &payload, sizeof(payload));
+}
+
+void GlCapture::record_program(CachedShaderProgram* program)
+{
+    TraceProgram payload = { program->get_program_id(), program->get_position_attribute(), program->get_tex_coordinate_attribute() };
+    write_command(TRACE_PROGRAM, &payload, sizeof(payload));
+}
+
+void GlCapture::record_use_program(GLuint program)
+{
+    TraceUseProgram payload = { program };
+    write_command(TRACE_USE_PROGRAM, &payload, sizeof(payload));
+}
+
+void GlCapture::record_matrix(GlTraceMatrix matrix, const glm::mat4& values)
+{
+    TraceUniformMatrix payload;
+    payload.matrix = matrix;
+    std::memcpy(payload.values, &values[0][0], sizeof(payload.values));
+    write_command(TRACE_UNIFORM_MATRIX, &payload, sizeof(payload));
+}
+
+void GlCapture::record_gen_texture(GLuint texture)
+{
+    TraceTexture payload = { texture };
+    write_command(TRACE_GEN_TEXTURE, &payload, sizeof(payload));
+}
+
+void GlCapture::record_bind_texture(GLenum target, GLuint texture)
+{
+    TraceBindTexture payload = { target, texture };
+    write_command(TRACE_BIND_TEXTURE, &payload, sizeof(payload));
+}
+
+void GlCapture::record_tex_image_2d(GLenum target, GLint level, GLint internal_format, GLsizei width, GLsizei height,
+    GLenum format, GLenum type, const void* pixels)
+{
+    TraceTexImage2D payload = { target, level, internal_format, width, height, format, type };
+    bool has_pixels = pixels != nullptr && format == GL_RGBA && type == GL_UNSIGNED_BYTE;
+    write_command(TRACE_TEX_IMAGE_2D, &payload, sizeof(payload), pixels, has_pixels ? (std::size_t)width * height * 4 : 0);
+}
+
+void GlCapture::record_tex_parameter(GLenum target, GLenum name, GLint value)
+{
+    TraceTexParameter payload = { target, name, value };
+    write_command(TRACE_TEX_PARAMETER, &payload, sizeof(payload));
+}
+
+void GlCapture::record_attribute_pointer(GLuint index, GLint components, GLenum type, GLsizei stride, const void* pointer)
+{
+    if (index >= MAX_ATTRIBUTES) return;
+
+    bool packed_floats = type == GL_FLOAT && (stride == 0 || stride == components * (GLsizei)sizeof(float));
+    m_attributes[index].data = packed_floats ? static_cast<const float*>(pointer) : nullptr;
+    m_attributes[index].components = components;
+}
+
+void GlCapture::record_enable_attribute(GLuint index)
+{
+    if (index < MAX_ATTRIBUTES) m_attributes[index].enabled = true;
+
+    TraceAttributeArray payload = { index };
+    write_command(TRACE_ENABLE_ATTRIBUTE, &payload, sizeof(payload));
+}
+
+void GlCapture::record_disable_attribute(GLuint index)
+{
+    if (index < MAX_ATTRIBUTES) m_attributes[index].enabled = false;
+
+    TraceAttributeArray payload = { index };
+    write_command(TRACE_DISABLE_ATTRIBUTE, &payload, sizeof(payload));
+}
+
+void GlCapture::record_draw_arrays(GLenum mode, GLint first, GLsizei count)
+{
+    // Everything up to the last vertex drawn, so the replayer can keep the same first
+    for (GLuint index = 0; index < MAX_ATTRIBUTES; index++)
+    {
+        const AttributeArray& attribute = m_attributes[index];
+        if (!attribute.enabled || attribute.data == nullptr) continue;
+
+        TraceAttributeData payload = { index, attribute.components, first + count };
+        write_command(TRACE_ATTRIBUTE_DATA, &payload, sizeof(payload),
+            attribute.data, (std::size_t)attribute.components * (first + count) * sizeof(float));
+    }
+
+    TraceDrawArrays payload = { mode, first, count };
+    write_command(TRACE_DRAW_ARRAYS, &payload, sizeof(payload));
+}
+
+void GlCapture::record_gen_framebuffer(GLuint framebuffer)
+{
+    TraceFramebuffer payload = { framebuffer };
+    write_command(TRACE_GEN_FRAMEBUFFER, &payload, sizeof(payload));
+}
+
+void GlCapture::record_bind_framebuffer(GLenum target, GLuint framebuffer)
+{
+    TraceBindFramebuffer payload = { target, framebuffer };
+    write_command(TRACE_BIND_FRAMEBUFFER, &payload, sizeof(payload));
+}
+
+void GlCapture::record_framebuffer_texture(GLenum target, GLenum attachment, GLenum texture_target, GLuint texture, GLint level)
+{
+    TraceFramebufferTexture payload = { target, attachment, texture_target, texture, level };
+    write_command(TRACE_FRAMEBUFFER_TEXTURE, &payload, sizeof(payload));
+}
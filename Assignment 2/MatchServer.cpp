@@ -0,0 +1,901 @@
+#include <cstdio>
+#include "MatchServer.h"
+
+#ifdef __linux__
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include "PongMatch.h"
+
+// Packet layout: a MatchPacketHeader, then for MATCH_STATE the match as a GameSnapshot.
+// Native byte order, as clients and server run the same build.
+constexpr std::uint32_t MATCH_PACKET_MAGIC = 0x4D474E50;  // "PNGM" read as little-endian
+
+enum MatchPacketType : std::uint8_t { MATCH_JOIN, MATCH_INPUT, MATCH_STATE, MATCH_LEAVE };
+
+struct MatchPacketHeader
+{
+    std::uint32_t magic;
+    std::uint32_t client_id;  // Chosen by the client; players are known by it, not by their address
+    std::uint8_t type;
+    std::uint8_t player;      // MATCH_STATE: the paddle the receiver controls, 0 or 1
+    std::uint16_t buttons;    // MATCH_INPUT
+};
+
+constexpr std::size_t MATCH_PACKET_CAPACITY = sizeof(MatchPacketHeader) + sizeof(GameSnapshot);
+
+constexpr std::uint32_t PLAYER_TIMEOUT_TICKS = 300;  // Five seconds without a packet
+constexpr std::uint32_t TIMEOUT_CHECK_TICKS = 60;
+constexpr std::uint64_t MAX_CATCH_UP_TICKS = 4;       // Ticks run at once after a stall; the rest are skipped
+constexpr int SEND_BATCH_SIZE = 256;
+constexpr int RECEIVE_BATCH_SIZE = 64;
+constexpr int SOCKET_BUFFER_BYTES = 4 << 20;
+
+constexpr double JOIN_RESEND_SECONDS = 0.25;
+constexpr int BOT_SOCKETS_PER_THREAD = 64;  // Spread over enough source ports to reach every shard
+
+// Set by Ctrl+C, or when the run's time is up
+static std::atomic<bool> g_is_stopping{ false };
+
+static void handle_interrupt(int)
+{
+    g_is_stopping = true;
+}
+
+static double seconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Sorts values partway, so only call it once the values are no longer needed in order
+static double percentile(std::vector<double>& values, double fraction)
+{
+    if (values.empty()) return 0.0;
+
+    std::size_t index = std::min(values.size() - 1, (std::size_t)(fraction * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+// ––––– SOCKETS ––––– //
+static int open_udp_socket(std::uint16_t port, bool is_shared)
+{
+    int handle = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK, IPPROTO_UDP);
+    if (handle < 0) return -1;
+
+    int one = 1, buffer_bytes = SOCKET_BUFFER_BYTES;
+    if (is_shared) setsockopt(handle, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+    setsockopt(handle, SOL_SOCKET, SO_RCVBUF, &buffer_bytes, sizeof(buffer_bytes));
+    setsockopt(handle, SOL_SOCKET, SO_SNDBUF, &buffer_bytes, sizeof(buffer_bytes));
+
+    sockaddr_in address = { };
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+
+    if (bind(handle, (const sockaddr*)&address, sizeof(address)) != 0)
+    {
+        close(handle);
+        return -1;
+    }
+    return handle;
+}
+
+static int open_timer(double seconds)
+{
+    int handle = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+    if (handle < 0) return -1;
+
+    long long nanoseconds = (long long)(seconds * 1e9);
+    itimerspec interval = { };
+    interval.it_interval.tv_sec = (time_t)(nanoseconds / 1000000000);
+    interval.it_interval.tv_nsec = (long)(nanoseconds % 1000000000);
+    interval.it_value = interval.it_interval;
+    timerfd_settime(handle, 0, &interval, nullptr);
+    return handle;
+}
+
+// Expirations since the last read, or 0
+static std::uint64_t read_timer(int handle)
+{
+    std::uint64_t expirations = 0;
+    if (read(handle, &expirations, sizeof(expirations)) != (ssize_t)sizeof(expirations)) return 0;
+    return expirations;
+}
+
+static bool watch(int epoll_handle, int handle)
+{
+    epoll_event event = { };
+    event.events = EPOLLIN;
+    event.data.fd = handle;
+    return epoll_ctl(epoll_handle, EPOLL_CTL_ADD, handle, &event) == 0;
+}
+
+static bool parse_address(const char* text, sockaddr_in& address)
+{
+    const char* separator = std::strrchr(text, ':');
+    if (separator == nullptr || separator - text >= 64) return false;
+
+    char host[64];
+    std::memcpy(host, text, separator - text);
+    host[separator - text] = '\0';
+
+    address = { };
+    address.sin_family = AF_INET;
+    address.sin_port = htons((std::uint16_t)std::atoi(separator + 1));
+    return inet_pton(AF_INET, host, &address.sin_addr) == 1;
+}
+
+static bool read_header(const unsigned char* data, std::size_t size, MatchPacketHeader& header)
+{
+    if (size < sizeof(header)) return false;
+    std::memcpy(&header, data, sizeof(header));
+    return header.magic == MATCH_PACKET_MAGIC;
+}
+
+// Datagrams for one socket, gathered and sent with as few system calls as possible
+class DatagramBatch
+{
+private:
+    int m_capacity;
+    std::vector<unsigned char> m_buffers;
+    std::vector<sockaddr_in> m_addresses;
+    std::vector<iovec> m_vectors;
+    std::vector<mmsghdr> m_messages;
+    int m_count = 0;
+
+public:
+    explicit DatagramBatch(int capacity)
+        : m_capacity(capacity), m_buffers(capacity * MATCH_PACKET_CAPACITY), m_addresses(capacity),
+        m_vectors(capacity), m_messages(capacity)
+    {
+        for (int i = 0; i < capacity; i++)
+        {
+            m_vectors[i].iov_base = &m_buffers[i * MATCH_PACKET_CAPACITY];
+            m_vectors[i].iov_len = MATCH_PACKET_CAPACITY;
+            m_messages[i] = { };
+            m_messages[i].msg_hdr.msg_name = &m_addresses[i];
+            m_messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+            m_messages[i].msg_hdr.msg_iov = &m_vectors[i];
+            m_messages[i].msg_hdr.msg_iovlen = 1;
+        }
+    }
+
+    // ————— SENDING ————— //
+    bool is_full() const { return m_count == m_capacity; }
+    int get_count() const { return m_count; }
+
+    // Space for the next datagram, which add() then commits
+    unsigned char* next_buffer() { return &m_buffers[m_count * MATCH_PACKET_CAPACITY]; }
+    void add(std::size_t size, const sockaddr_in& to)
+    {
+        m_vectors[m_count].iov_len = size;
+        m_addresses[m_count] = to;
+        m_count++;
+    }
+
+    // Returns how many were sent; the rest are dropped, as the socket buffer is full
+    int send(int handle)
+    {
+        int sent = 0;
+        while (sent < m_count)
+        {
+            int result = sendmmsg(handle, &m_messages[sent], m_count - sent, 0);
+            if (result <= 0) break;
+            sent += result;
+        }
+        m_count = 0;
+        return sent;
+    }
+
+    // ————— RECEIVING ————— //
+    // How many datagrams arrived, up to the capacity; read them with get_data() and friends
+    int receive(int handle)
+    {
+        for (int i = 0; i < m_capacity; i++)
+        {
+            m_vectors[i].iov_len = MATCH_PACKET_CAPACITY;
+            m_messages[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+        }
+        int result = recvmmsg(handle, m_messages.data(), m_capacity, 0, nullptr);
+        return result < 0 ? 0 : result;
+    }
+
+    const unsigned char* get_data(int index) const { return &m_buffers[index * MATCH_PACKET_CAPACITY]; }
+    std::size_t get_size(int index) const { return m_messages[index].msg_len; }
+    const sockaddr_in& get_address(int index) const { return m_addresses[index]; }
+};
+
+// ––––– SERVER ––––– //
+struct ServerPlayer
+{
+    bool is_connected = false;
+    std::uint32_t client_id = 0;
+    sockaddr_in address = { };
+    int match = -1;                     // -1 while waiting for an opponent
+    int player = 0;
+    std::uint16_t held_buttons = 0;
+    std::uint16_t pressed_buttons = 0;  // Since the last tick, so a press between ticks is not lost
+    std::uint32_t last_heard_tick = 0;
+};
+
+// A shard's counters since the report before
+struct ShardStats
+{
+    std::vector<double> tick_seconds;
+    double step_seconds = 0.0;
+    std::uint64_t match_steps = 0;
+    std::uint64_t skipped_ticks = 0;
+    std::uint64_t matches_finished = 0;
+    std::uint64_t packets_received = 0, packets_sent = 0, packets_dropped = 0;
+    int matches = 0, players = 0;
+};
+
+class MatchShard
+{
+private:
+    int m_index;
+    const MatchServerOptions& m_options;
+    int m_socket = -1, m_epoll = -1, m_timer = -1;
+    std::thread m_thread;
+
+    // ————— MATCHES ————— //
+    // A match's players are in m_match_players at the same index; free slots are reused
+    std::vector<PongMatch> m_matches;
+    std::vector<int> m_match_players;  // Two per match, -1 for a free slot
+    std::vector<int> m_free_matches;
+    int m_match_count = 0;
+
+    std::vector<ServerPlayer> m_players;
+    std::vector<int> m_free_players;
+    std::unordered_map<std::uint32_t, int> m_player_indices;
+    int m_waiting_player = -1;
+    std::uint32_t m_tick = 0;
+
+    DatagramBatch m_sends, m_receives;
+
+    std::mutex m_stats_mutex;
+    ShardStats m_stats;
+
+    void run();
+    void run_tick();
+    void receive_packets();
+    void handle_packet(const unsigned char* data, std::size_t size, const sockaddr_in& from);
+
+    void add_player(std::uint32_t client_id, const sockaddr_in& address);
+    void remove_player(int index);
+    void find_opponent(int index);
+    void end_match(int match);
+    void drop_silent_players();
+
+    void queue_state(int match, int slot);
+    void flush_sends();
+
+public:
+    MatchShard(int index, const MatchServerOptions& options)
+        : m_index(index), m_options(options), m_sends(SEND_BATCH_SIZE), m_receives(RECEIVE_BATCH_SIZE)
+    {
+    }
+    ~MatchShard();
+
+    MatchShard(const MatchShard&) = delete;
+    MatchShard& operator=(const MatchShard&) = delete;
+
+    bool open();
+    void start() { m_thread = std::thread([this]() { run(); }); }
+    void join() { if (m_thread.joinable()) m_thread.join(); }
+
+    // The counters since the last call, which are then cleared
+    ShardStats take_stats();
+};
+
+MatchShard::~MatchShard()
+{
+    join();
+    if (m_socket >= 0) close(m_socket);
+    if (m_epoll >= 0) close(m_epoll);
+    if (m_timer >= 0) close(m_timer);
+}
+
+bool MatchShard::open()
+{
+    m_socket = open_udp_socket(m_options.port, true);
+    m_epoll = epoll_create1(0);
+    m_timer = open_timer(PONG_TIMESTEP);
+    return m_socket >= 0 && m_epoll >= 0 && m_timer >= 0 && watch(m_epoll, m_socket) && watch(m_epoll, m_timer);
+}
+
+ShardStats MatchShard::take_stats()
+{
+    std::lock_guard<std::mutex> lock(m_stats_mutex);
+    ShardStats stats;
+    std::swap(stats, m_stats);
+    m_stats.matches = stats.matches;
+    m_stats.players = stats.players;
+    return stats;
+}
+
+void MatchShard::run()
+{
+    // Pinned, so one shard's ticks are one core's work and the report can say so
+    cpu_set_t cores;
+    CPU_ZERO(&cores);
+    CPU_SET(m_index % std::max(1u, std::thread::hardware_concurrency()), &cores);
+    pthread_setaffinity_np(pthread_self(), sizeof(cores), &cores);
+
+    epoll_event events[2];
+    while (!g_is_stopping)
+    {
+        int count = epoll_wait(m_epoll, events, 2, 100);
+        for (int i = 0; i < count; i++)
+        {
+            if (events[i].data.fd == m_socket)
+            {
+                receive_packets();
+                continue;
+            }
+
+            std::uint64_t expirations = read_timer(m_timer);
+            std::uint64_t ticks = std::min(expirations, MAX_CATCH_UP_TICKS);
+            for (std::uint64_t tick = 0; tick < ticks; tick++) run_tick();
+
+            std::lock_guard<std::mutex> lock(m_stats_mutex);
+            m_stats.skipped_ticks += expirations - ticks;
+        }
+    }
+
+    // Tells every client the server has gone, so bots stop waiting on it
+    for (ServerPlayer& player : m_players)
+    {
+        if (!player.is_connected) continue;
+
+        MatchPacketHeader header = { MATCH_PACKET_MAGIC, player.client_id, MATCH_LEAVE, 0, 0 };
+        if (m_sends.is_full()) flush_sends();
+        std::memcpy(m_sends.next_buffer(), &header, sizeof(header));
+        m_sends.add(sizeof(header), player.address);
+    }
+    flush_sends();
+}
+
+// Every match on the shard steps in one pass over the match array, then every state goes
+// out in as few sendmmsg calls as the batch size allows
+void MatchShard::run_tick()
+{
+    auto tick_start = std::chrono::steady_clock::now();
+
+    std::uint64_t finished = 0;
+    for (int match = 0; match < (int)m_matches.size(); match++)
+    {
+        int* players = &m_match_players[match * 2];
+        if (players[0] < 0) continue;
+
+        std::uint16_t inputs[2];
+        for (int slot = 0; slot < 2; slot++)
+        {
+            ServerPlayer& player = m_players[players[slot]];
+            inputs[slot] = player.held_buttons | player.pressed_buttons;
+            player.pressed_buttons = 0;
+        }
+
+        PongMatch& pong = m_matches[match];
+        pong.apply_input(combine_player_buttons(inputs));
+        pong.step();
+    }
+    double step_seconds = seconds_since(tick_start);
+
+    for (int match = 0; match < (int)m_matches.size(); match++)
+    {
+        if (m_match_players[match * 2] < 0) continue;
+
+        queue_state(match, 0);
+        queue_state(match, 1);
+
+        // The winning state has gone out, so the players can start again
+        if (m_matches[match].is_game_over())
+        {
+            m_matches[match].reset();
+            finished++;
+        }
+    }
+    flush_sends();
+
+    m_tick++;
+    if (m_tick % TIMEOUT_CHECK_TICKS == 0) drop_silent_players();
+
+    std::lock_guard<std::mutex> lock(m_stats_mutex);
+    m_stats.tick_seconds.push_back(seconds_since(tick_start));
+    m_stats.step_seconds += step_seconds;
+    m_stats.match_steps += m_match_count;
+    m_stats.matches_finished += finished;
+    m_stats.matches = m_match_count;
+    m_stats.players = (int)m_player_indices.size();
+}
+
+void MatchShard::receive_packets()
+{
+    std::uint64_t received = 0;
+    int count;
+    while ((count = m_receives.receive(m_socket)) > 0)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            handle_packet(m_receives.get_data(i), m_receives.get_size(i), m_receives.get_address(i));
+        }
+        received += count;
+    }
+
+    std::lock_guard<std::mutex> lock(m_stats_mutex);
+    m_stats.packets_received += received;
+}
+
+void MatchShard::handle_packet(const unsigned char* data, std::size_t size, const sockaddr_in& from)
+{
+    MatchPacketHeader header;
+    if (!read_header(data, size, header)) return;
+
+    auto found = m_player_indices.find(header.client_id);
+    if (found == m_player_indices.end())
+    {
+        if (header.type == MATCH_JOIN) add_player(header.client_id, from);
+        return;
+    }
+
+    int index = found->second;
+    ServerPlayer& player = m_players[index];
+    player.address = from;
+    player.last_heard_tick = m_tick;
+
+    if (header.type == MATCH_LEAVE) remove_player(index);
+    else if (header.type == MATCH_INPUT && player.match >= 0)
+    {
+        std::uint16_t allowed = player.player == 0 ? PLAYER1_BUTTONS : PLAYER2_BUTTONS;
+        player.held_buttons = header.buttons & allowed & HELD_BUTTONS;
+        player.pressed_buttons |= header.buttons & allowed & ~HELD_BUTTONS;
+    }
+}
+
+void MatchShard::add_player(std::uint32_t client_id, const sockaddr_in& address)
+{
+    int index;
+    if (m_free_players.empty())
+    {
+        index = (int)m_players.size();
+        m_players.emplace_back();
+    }
+    else
+    {
+        index = m_free_players.back();
+        m_free_players.pop_back();
+    }
+
+    ServerPlayer& player = m_players[index];
+    player = ServerPlayer();
+    player.is_connected = true;
+    player.client_id = client_id;
+    player.address = address;
+    player.last_heard_tick = m_tick;
+    m_player_indices[client_id] = index;
+
+    find_opponent(index);
+}
+
+// Pairs the player with whoever is waiting, or leaves them waiting
+void MatchShard::find_opponent(int index)
+{
+    if (m_waiting_player < 0)
+    {
+        m_waiting_player = index;
+        return;
+    }
+
+    int match;
+    if (m_free_matches.empty())
+    {
+        match = (int)m_matches.size();
+        m_matches.emplace_back();
+        m_match_players.push_back(-1);
+        m_match_players.push_back(-1);
+    }
+    else
+    {
+        match = m_free_matches.back();
+        m_free_matches.pop_back();
+    }
+
+    m_matches[match].reset();
+    m_matches[match].set_masks(m_options.paddle_mask, m_options.ball_mask);
+    m_matches[match].set_fixed_point(m_options.fixed_point);
+
+    int players[2] = { m_waiting_player, index };
+    for (int slot = 0; slot < 2; slot++)
+    {
+        m_match_players[match * 2 + slot] = players[slot];
+        m_players[players[slot]].match = match;
+        m_players[players[slot]].player = slot;
+        m_players[players[slot]].held_buttons = m_players[players[slot]].pressed_buttons = 0;
+    }
+    m_waiting_player = -1;
+    m_match_count++;
+}
+
+// Frees the match; a player still connected goes back to waiting for someone new
+void MatchShard::end_match(int match)
+{
+    int players[2] = { m_match_players[match * 2], m_match_players[match * 2 + 1] };
+    m_match_players[match * 2] = m_match_players[match * 2 + 1] = -1;
+    m_free_matches.push_back(match);
+    m_match_count--;
+
+    for (int index : players)
+    {
+        m_players[index].match = -1;
+        if (m_players[index].is_connected) find_opponent(index);
+    }
+}
+
+void MatchShard::remove_player(int index)
+{
+    ServerPlayer& player = m_players[index];
+    player.is_connected = false;
+    m_player_indices.erase(player.client_id);
+
+    if (m_waiting_player == index) m_waiting_player = -1;
+    if (player.match >= 0) end_match(player.match);
+
+    m_free_players.push_back(index);
+}
+
+void MatchShard::drop_silent_players()
+{
+    for (int index = 0; index < (int)m_players.size(); index++)
+    {
+        if (m_players[index].is_connected && m_tick - m_players[index].last_heard_tick > PLAYER_TIMEOUT_TICKS)
+        {
+            remove_player(index);
+        }
+    }
+}
+
+void MatchShard::queue_state(int match, int slot)
+{
+    if (m_sends.is_full()) flush_sends();
+
+    const ServerPlayer& player = m_players[m_match_players[match * 2 + slot]];
+    MatchPacketHeader header = { MATCH_PACKET_MAGIC, player.client_id, MATCH_STATE, (std::uint8_t)slot, 0 };
+    GameSnapshot state;
+    m_matches[match].save(state);
+
+    unsigned char* buffer = m_sends.next_buffer();
+    std::memcpy(buffer, &header, sizeof(header));
+    std::memcpy(buffer + sizeof(header), &state, sizeof(state));
+    m_sends.add(sizeof(header) + sizeof(state), player.address);
+}
+
+void MatchShard::flush_sends()
+{
+    int queued = m_sends.get_count();
+    int sent = m_sends.send(m_socket);
+
+    std::lock_guard<std::mutex> lock(m_stats_mutex);
+    m_stats.packets_sent += sent;
+    m_stats.packets_dropped += queued - sent;
+}
+
+static void print_server_report(const char* label, std::vector<ShardStats>& shards, double seconds)
+{
+    int matches = 0, players = 0;
+    std::uint64_t skipped = 0, finished = 0, received = 0, sent = 0, dropped = 0, match_steps = 0;
+    double step_seconds = 0.0;
+    std::vector<double> all_ticks;
+
+    std::printf("%s, %.1f s\n", label, seconds);
+    for (int shard = 0; shard < (int)shards.size(); shard++)
+    {
+        ShardStats& stats = shards[shard];
+        std::vector<double> ticks = stats.tick_seconds;
+        double p50 = percentile(ticks, 0.50), p99 = percentile(ticks, 0.99), max = percentile(ticks, 1.0);
+
+        std::printf("  shard %d: %d matches, %d players, %zu ticks (%llu skipped), tick p50 %.1f us, p99 %.1f us, max %.1f us\n",
+            shard, stats.matches, stats.players, stats.tick_seconds.size(), (unsigned long long)stats.skipped_ticks,
+            p50 * 1e6, p99 * 1e6, max * 1e6);
+
+        matches += stats.matches;
+        players += stats.players;
+        skipped += stats.skipped_ticks;
+        finished += stats.matches_finished;
+        received += stats.packets_received;
+        sent += stats.packets_sent;
+        dropped += stats.packets_dropped;
+        match_steps += stats.match_steps;
+        step_seconds += stats.step_seconds;
+        all_ticks.insert(all_ticks.end(), stats.tick_seconds.begin(), stats.tick_seconds.end());
+    }
+
+    // How many matches one core could hold before its p99 tick took the whole tick, from the
+    // average number of matches each tick stepped, as players come and go
+    double p50 = percentile(all_ticks, 0.50), p99 = percentile(all_ticks, 0.99);
+    double matches_per_core = all_ticks.empty() ? 0.0 : (double)match_steps / all_ticks.size();
+    double budget_used = p99 / PONG_TIMESTEP;
+    std::printf("  %d matches now, %.1f per core on average, %d players, %llu finished; tick p50 %.1f us, p99 %.1f us (%.2f%% of the tick), "
+        "%.0f ns per match step, %llu skipped ticks, %.0f packets in and %.0f out per second (%llu dropped); "
+        "about %.0f matches per core at this p99\n",
+        matches, matches_per_core, players, (unsigned long long)finished, p50 * 1e6, p99 * 1e6, budget_used * 100.0,
+        match_steps > 0 ? step_seconds / match_steps * 1e9 : 0.0, (unsigned long long)skipped,
+        received / seconds, sent / seconds, (unsigned long long)dropped, budget_used > 0.0 ? matches_per_core / budget_used : 0.0);
+    std::fflush(stdout);
+}
+
+int run_match_server(const MatchServerOptions& options)
+{
+    int thread_count = options.thread_count > 0 ? options.thread_count : (int)std::max(1u, std::thread::hardware_concurrency());
+
+    std::vector<std::unique_ptr<MatchShard>> shards;
+    for (int i = 0; i < thread_count; i++)
+    {
+        shards.emplace_back(new MatchShard(i, options));
+        if (!shards.back()->open())
+        {
+            std::printf("Unable to open shard %d on port %u\n", i, (unsigned)options.port);
+            return 1;
+        }
+    }
+
+    g_is_stopping = false;
+    std::signal(SIGINT, handle_interrupt);
+    std::printf("Serving Pong on UDP port %u with %d shards\n", (unsigned)options.port, thread_count);
+    std::fflush(stdout);
+    for (auto& shard : shards) shard->start();
+
+    // Keeps every tick of the run for the final report, and each interval's for the periodic ones
+    std::vector<ShardStats> totals(thread_count);
+    auto start = std::chrono::steady_clock::now(), report_start = start;
+
+    auto gather = [&](bool is_final) {
+        std::vector<ShardStats> interval(thread_count);
+        for (int i = 0; i < thread_count; i++)
+        {
+            interval[i] = shards[i]->take_stats();
+            ShardStats& total = totals[i];
+            total.tick_seconds.insert(total.tick_seconds.end(), interval[i].tick_seconds.begin(), interval[i].tick_seconds.end());
+            total.step_seconds += interval[i].step_seconds;
+            total.match_steps += interval[i].match_steps;
+            total.skipped_ticks += interval[i].skipped_ticks;
+            total.matches_finished += interval[i].matches_finished;
+            total.packets_received += interval[i].packets_received;
+            total.packets_sent += interval[i].packets_sent;
+            total.packets_dropped += interval[i].packets_dropped;
+            total.matches = interval[i].matches;
+            total.players = interval[i].players;
+        }
+        if (is_final) print_server_report("Server run", totals, seconds_since(start));
+        else print_server_report("Server", interval, seconds_since(report_start));
+        report_start = std::chrono::steady_clock::now();
+    };
+
+    while (!g_is_stopping)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        if (options.seconds > 0.0 && seconds_since(start) >= options.seconds) g_is_stopping = true;
+        else if (seconds_since(report_start) >= options.report_seconds) gather(false);
+    }
+
+    for (auto& shard : shards) shard->join();
+    gather(true);
+    std::signal(SIGINT, SIG_DFL);
+    return 0;
+}
+
+// ––––– BOT CLIENTS ––––– //
+// A scripted player: it follows the nearest ball like the netplay bot, and as player 1 picks a
+// ball count from its id at the start of every match, so the server sees all three
+struct BotSession
+{
+    std::uint32_t client_id = 0;
+    int socket = -1;
+    int player = -1;               // -1 until the first state arrives
+    std::uint16_t ball_button = 0;
+    PongMatch match;               // The latest state from the server
+    std::uint64_t states = 0;
+    std::uint64_t matches_finished = 0;
+    bool was_game_over = false;
+};
+
+struct BotStats
+{
+    std::uint64_t states = 0, inputs = 0, matches_finished = 0;
+    int playing = 0;
+};
+
+static void send_packet(int handle, const sockaddr_in& to, std::uint32_t client_id, std::uint8_t type, std::uint16_t buttons)
+{
+    MatchPacketHeader header = { MATCH_PACKET_MAGIC, client_id, type, 0, buttons };
+    sendto(handle, &header, sizeof(header), 0, (const sockaddr*)&to, sizeof(to));
+}
+
+static void run_bot_thread(int thread_index, int first_bot, int bot_count, const sockaddr_in& server, double seconds, BotStats& result)
+{
+    std::vector<int> sockets;
+    int epoll_handle = epoll_create1(0);
+    int join_timer = open_timer(JOIN_RESEND_SECONDS);
+    watch(epoll_handle, join_timer);
+
+    int socket_count = std::min(bot_count, BOT_SOCKETS_PER_THREAD);
+    for (int i = 0; i < socket_count; i++)
+    {
+        int handle = open_udp_socket(0, false);
+        if (handle < 0) continue;
+        sockets.push_back(handle);
+        watch(epoll_handle, handle);
+    }
+    if (sockets.empty())
+    {
+        std::printf("Bot thread %d could not open any sockets\n", thread_index);
+        close(join_timer);
+        close(epoll_handle);
+        return;
+    }
+
+    // Ids only have to be unique among the server's players, so a random base does
+    std::random_device random_device;
+    std::uint32_t id_base = random_device() & 0xFFF00000u;
+    std::vector<BotSession> bots(bot_count);
+    std::unordered_map<std::uint32_t, int> bot_indices;
+    for (int i = 0; i < bot_count; i++)
+    {
+        bots[i].client_id = id_base | (std::uint32_t)(first_bot + i + 1);
+        bots[i].socket = sockets[i % sockets.size()];
+        bots[i].ball_button = (std::uint16_t)(INPUT_ONE_BALL << ((first_bot + i) % 3));
+        bot_indices[bots[i].client_id] = i;
+        send_packet(bots[i].socket, server, bots[i].client_id, MATCH_JOIN, 0);
+    }
+
+    DatagramBatch receives(RECEIVE_BATCH_SIZE);
+    std::vector<epoll_event> events(sockets.size() + 1);
+    auto start = std::chrono::steady_clock::now();
+
+    while (!g_is_stopping && seconds_since(start) < seconds)
+    {
+        int count = epoll_wait(epoll_handle, events.data(), (int)events.size(), 100);
+        for (int e = 0; e < count; e++)
+        {
+            int handle = events[e].data.fd;
+            if (handle == join_timer)
+            {
+                read_timer(join_timer);
+                for (BotSession& bot : bots)
+                {
+                    if (bot.player < 0) send_packet(bot.socket, server, bot.client_id, MATCH_JOIN, 0);
+                }
+                continue;
+            }
+
+            int received;
+            while ((received = receives.receive(handle)) > 0)
+            {
+                for (int i = 0; i < received; i++)
+                {
+                    MatchPacketHeader header;
+                    if (!read_header(receives.get_data(i), receives.get_size(i), header)) continue;
+
+                    auto found = bot_indices.find(header.client_id);
+                    if (found == bot_indices.end()) continue;
+                    BotSession& bot = bots[found->second];
+
+                    if (header.type == MATCH_LEAVE)
+                    {
+                        bot.player = -1;
+                        continue;
+                    }
+                    if (header.type != MATCH_STATE || receives.get_size(i) < sizeof(header) + sizeof(GameSnapshot)) continue;
+
+                    GameSnapshot state;
+                    std::memcpy(&state, receives.get_data(i) + sizeof(header), sizeof(state));
+                    bot.match.load(state);
+                    bot.player = header.player;
+                    bot.states++;
+
+                    if (bot.match.is_game_over() && !bot.was_game_over) bot.matches_finished++;
+                    bot.was_game_over = bot.match.is_game_over();
+
+                    std::uint16_t buttons = bot.match.get_bot_buttons(bot.player);
+                    if (bot.player == 0 && state.tick < 10) buttons |= bot.ball_button;
+                    send_packet(bot.socket, server, bot.client_id, MATCH_INPUT, buttons);
+                    result.inputs++;
+                }
+            }
+        }
+    }
+
+    for (BotSession& bot : bots)
+    {
+        send_packet(bot.socket, server, bot.client_id, MATCH_LEAVE, 0);
+        result.states += bot.states;
+        result.matches_finished += bot.matches_finished;
+        if (bot.player >= 0) result.playing++;
+    }
+
+    for (int handle : sockets) close(handle);
+    close(join_timer);
+    close(epoll_handle);
+}
+
+int run_bot_clients(const BotClientOptions& options)
+{
+    sockaddr_in server;
+    if (!parse_address(options.server_address, server))
+    {
+        std::printf("Expected an address:port for the server, not %s\n", options.server_address);
+        return 1;
+    }
+
+    int thread_count = std::max(1, std::min(options.thread_count, options.client_count));
+    std::vector<BotStats> stats(thread_count);
+    std::vector<std::thread> threads;
+
+    g_is_stopping = false;
+    std::signal(SIGINT, handle_interrupt);
+    auto start = std::chrono::steady_clock::now();
+
+    int first_bot = 0;
+    for (int i = 0; i < thread_count; i++)
+    {
+        int count = options.client_count / thread_count + (i < options.client_count % thread_count ? 1 : 0);
+        threads.emplace_back(run_bot_thread, i, first_bot, count, std::cref(server), options.seconds, std::ref(stats[i]));
+        first_bot += count;
+    }
+    for (std::thread& thread : threads) thread.join();
+    std::signal(SIGINT, SIG_DFL);
+
+    BotStats total;
+    for (const BotStats& thread_stats : stats)
+    {
+        total.states += thread_stats.states;
+        total.inputs += thread_stats.inputs;
+        total.matches_finished += thread_stats.matches_finished;
+        total.playing += thread_stats.playing;
+    }
+
+    // A server keeping up sends each bot a state every tick
+    double seconds = seconds_since(start);
+    double states_per_bot = options.client_count > 0 ? total.states / seconds / options.client_count : 0.0;
+    std::printf("Bots: %d clients over %.1f s, %d in a match at the end, %.1f states per second each (%.0f expected), "
+        "%llu inputs sent, %llu match ends seen\n",
+        options.client_count, seconds, total.playing, states_per_bot, 1.0 / PONG_TIMESTEP,
+        (unsigned long long)total.inputs, (unsigned long long)total.matches_finished);
+    return 0;
+}
+
+#else
+
+int run_match_server(const MatchServerOptions& options)
+{
+    (void)options;
+    std::printf("The match server needs Linux (epoll)\n");
+    return 1;
+}
+
+int run_bot_clients(const BotClientOptions& options)
+{
+    (void)options;
+    std::printf("The bot clients need Linux (epoll)\n");
+    return 1;
+}
+
+#endif
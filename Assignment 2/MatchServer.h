@@ -0,0 +1,50 @@
+#ifndef MATCH_SERVER_H
+#define MATCH_SERVER_H
+
+#include <cstdint>
+#include "CollisionMask.h"
+
+// ––––– MATCH SERVER ––––– //
+// Pong as a service: a headless, authoritative server hosting many PongMatch games at once,
+// and scripted bot clients to load it with from the same machine:
+//
+//     ./pong --server 7777 --server-threads 4
+//     ./pong --bot-clients 2000 --bot-server 127.0.0.1:7777
+//
+// A client sends joins until it is paired with the next client to join, then sends its
+// buttons while the server streams the match state back every tick. The server runs one shard
+// per thread, each pinned to a core with its own UDP socket on the shared port (SO_REUSEPORT,
+// so the kernel spreads clients across shards), its own epoll loop and its own tick timer.
+// A tick steps every match on the shard in one pass, then sends all the states with sendmmsg.
+// Finished matches start again straight away with the same players.
+//
+// The server prints matches per core and tick-time percentiles as it runs. Linux only;
+// elsewhere both modes say so and return.
+
+struct MatchServerOptions
+{
+    std::uint16_t port = 7777;
+    int thread_count = 0;            // 0 uses every hardware thread
+    double seconds = 0.0;            // 0 runs until interrupted
+    double report_seconds = 5.0;
+
+    // Shared by every match; without them hits are decided by the box test alone
+    const CollisionMask* paddle_mask = nullptr;
+    const CollisionMask* ball_mask = nullptr;
+
+    bool fixed_point = false;        // Runs every match with PongMatch::set_fixed_point
+};
+
+struct BotClientOptions
+{
+    const char* server_address = "127.0.0.1:7777";
+    int client_count = 100;
+    int thread_count = 1;
+    double seconds = 30.0;
+};
+
+// Both return an exit code for main()
+int run_match_server(const MatchServerOptions& options);
+int run_bot_clients(const BotClientOptions& options);
+
+#endif // MATCH_SERVER_H
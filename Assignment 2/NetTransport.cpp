@@ -0,0 +1,147 @@
+#include <cstring>
+#include "NetTransport.h"
+
+#ifdef _WINDOWS
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef int socklen_t;
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// ––––– UDP ––––– //
+static bool open_socket(std::intptr_t& handle)
+{
+#ifdef _WINDOWS
+    WSADATA data;
+    if (WSAStartup(MAKEWORD(2, 2), &data) != 0) return false;
+
+    SOCKET created = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (created == INVALID_SOCKET) return false;
+
+    u_long non_blocking = 1;
+    ioctlsocket(created, FIONBIO, &non_blocking);
+#else
+    int created = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (created < 0) return false;
+
+    fcntl(created, F_SETFL, fcntl(created, F_GETFL, 0) | O_NONBLOCK);
+#endif
+    handle = (std::intptr_t)created;
+    return true;
+}
+
+UdpTransport::~UdpTransport()
+{
+    close();
+}
+
+bool UdpTransport::host(std::uint16_t port)
+{
+    close();
+    if (!open_socket(m_socket)) return false;
+
+    sockaddr_in address = { };
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+
+    if (bind(m_socket, (const sockaddr*)&address, sizeof(address)) != 0)
+    {
+        close();
+        return false;
+    }
+    return true;
+}
+
+bool UdpTransport::join(const char* host_address, std::uint16_t port)
+{
+    close();
+
+    sockaddr_in address = { };
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    if (inet_pton(AF_INET, host_address, &address.sin_addr) != 1) return false;
+    if (!open_socket(m_socket)) return false;
+
+    static_assert(sizeof(address) <= sizeof(m_peer_address), "sockaddr_in must fit in m_peer_address");
+    std::memcpy(m_peer_address, &address, sizeof(address));
+    m_has_peer = true;
+    return true;
+}
+
+void UdpTransport::close()
+{
+    if (m_socket == -1) return;
+
+#ifdef _WINDOWS
+    closesocket((SOCKET)m_socket);
+    WSACleanup();
+#else
+    ::close((int)m_socket);
+#endif
+    m_socket = -1;
+    m_has_peer = false;
+}
+
+void UdpTransport::send(const void* data, std::size_t size)
+{
+    if (m_socket == -1 || !m_has_peer) return;
+
+    // A full send buffer is treated like any other lost packet
+    sendto(m_socket, (const char*)data, (int)size, 0, (const sockaddr*)m_peer_address, sizeof(sockaddr_in));
+}
+
+std::size_t UdpTransport::receive(void* data, std::size_t capacity)
+{
+    if (m_socket == -1) return 0;
+
+    sockaddr_in sender;
+    socklen_t sender_size = sizeof(sender);
+    int received = (int)recvfrom(m_socket, (char*)data, (int)capacity, 0, (sockaddr*)&sender, &sender_size);
+    if (received <= 0) return 0;
+
+    // The host learns its peer from the first packet, and follows it if its port changes
+    std::memcpy(m_peer_address, &sender, sizeof(sender));
+    m_has_peer = true;
+    return (std::size_t)received;
+}
+
+// ––––– LOOPBACK ––––– //
+LoopbackLink::LoopbackLink(double latency_ms, float loss_percent, std::uint32_t seed)
+    : m_latency_ms(latency_ms), m_loss_percent(loss_percent), m_random_state(seed == 0 ? 1 : seed)
+{
+}
+
+// Xorshift, so the same seed drops the same packets on every platform
+bool LoopbackLink::should_drop()
+{
+    m_random_state ^= m_random_state << 13;
+    m_random_state ^= m_random_state >> 17;
+    m_random_state ^= m_random_state << 5;
+    return (m_random_state % 10000) < (std::uint32_t)(m_loss_percent * 100.0f);
+}
+
+void LoopbackLink::send(int from_end, const void* data, std::size_t size)
+{
+    if (should_drop()) return;
+
+    const unsigned char* bytes = (const unsigned char*)data;
+    m_in_flight[from_end].push_back({ m_now_ms + m_latency_ms, std::vector<unsigned char>(bytes, bytes + size) });
+}
+
+std::size_t LoopbackLink::receive(int to_end, void* data, std::size_t capacity)
+{
+    std::deque<Packet>& queue = m_in_flight[1 - to_end];
+    if (queue.empty() || queue.front().delivery_ms > m_now_ms) return 0;
+
+    Packet& packet = queue.front();
+    std::size_t size = packet.bytes.size() < capacity ? packet.bytes.size() : capacity;
+    std::memcpy(data, packet.bytes.data(), size);
+    queue.pop_front();
+    return size;
+}
@@ -0,0 +1,90 @@
+#ifndef NET_TRANSPORT_H
+#define NET_TRANSPORT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+// ––––– NETWORK TRANSPORTS ––––– //
+// Unreliable datagrams between two peers. Packets may be lost, but neither transport
+// splits them; receive() returns one whole packet or nothing, and never blocks.
+class NetTransport
+{
+public:
+    virtual ~NetTransport() { }
+
+    virtual void send(const void* data, std::size_t size) = 0;
+
+    // Size of the packet copied into data, or 0 when nothing has arrived
+    virtual std::size_t receive(void* data, std::size_t capacity) = 0;
+};
+
+// A non-blocking UDP socket. The host binds a port and replies to whoever sent it the
+// last packet; the joining side sends to the host's address from an ephemeral port.
+class UdpTransport : public NetTransport
+{
+private:
+    std::intptr_t m_socket = -1;
+    unsigned char m_peer_address[16] = { };  // A sockaddr_in, kept opaque so callers need no socket headers
+    bool m_has_peer = false;
+
+public:
+    ~UdpTransport();
+
+    bool host(std::uint16_t port);
+    bool join(const char* address, std::uint16_t port);
+    void close();
+
+    bool has_peer() const { return m_has_peer; }
+
+    void send(const void* data, std::size_t size) override;
+    std::size_t receive(void* data, std::size_t capacity) override;
+};
+
+// Both ends of an in-process connection, with a fixed delay and a chance of dropping each
+// packet. Time is advanced by the caller, so a headless run is as repeatable as a replay.
+class LoopbackLink
+{
+private:
+    struct Packet
+    {
+        double delivery_ms;
+        std::vector<unsigned char> bytes;
+    };
+
+    // One queue per direction, indexed by the sending end
+    std::deque<Packet> m_in_flight[2];
+    double m_now_ms = 0.0;
+    double m_latency_ms;
+    float m_loss_percent;
+    std::uint32_t m_random_state;
+
+    bool should_drop();
+
+public:
+    LoopbackLink(double latency_ms, float loss_percent, std::uint32_t seed = 1);
+
+    void advance(double milliseconds) { m_now_ms += milliseconds; }
+
+    void send(int from_end, const void* data, std::size_t size);
+    std::size_t receive(int to_end, void* data, std::size_t capacity);
+
+    std::size_t get_packets_in_flight() const { return m_in_flight[0].size() + m_in_flight[1].size(); }
+};
+
+// One end (0 or 1) of a LoopbackLink, as a transport
+class LoopbackTransport : public NetTransport
+{
+private:
+    LoopbackLink* m_link;
+    int m_end;
+
+public:
+    LoopbackTransport(LoopbackLink* link, int end) : m_link(link), m_end(end) { }
+
+    void send(const void* data, std::size_t size) override { m_link->send(m_end, data, size); }
+    std::size_t receive(void* data, std::size_t capacity) override { return m_link->receive(m_end, data, capacity); }
+};
+
+#endif // NET_TRANSPORT_H
@@ -0,0 +1,471 @@
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include "PongMatch.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// The rules' sizes on the Q16.16 grid, for the fixed-point step
+constexpr Fixed FIXED_TIMESTEP = Fixed::from_float(PONG_TIMESTEP);
+constexpr Fixed FIXED_PADDLE_SPEED = Fixed::from_float(PongMatch::PADDLE_SPEED);
+constexpr Fixed FIXED_PADDLE_HALF_HEIGHT = Fixed::from_float(PongMatch::PADDLE_HEIGHT / 2.0f);
+constexpr Fixed FIXED_BALL_HALF_SIZE = Fixed::from_float(PongMatch::BALL_SIZE / 2.0f);
+constexpr Fixed FIXED_HIT_HALF_WIDTH = Fixed::from_float((PongMatch::BALL_SIZE + PongMatch::PADDLE_WIDTH) / 2.0f);
+constexpr Fixed FIXED_HIT_HALF_HEIGHT = Fixed::from_float((PongMatch::BALL_SIZE + PongMatch::PADDLE_HEIGHT) / 2.0f);
+constexpr Fixed FIXED_COURT_HALF_HEIGHT = Fixed::from_float(PongMatch::COURT_HALF_HEIGHT);
+constexpr Fixed FIXED_COURT_HALF_WIDTH = Fixed::from_float(PongMatch::COURT_HALF_WIDTH);
+
+// The SIMD kernel multiplies by the timestep in 16-bit halves, which needs it to fit in 15 bits
+static_assert(FIXED_TIMESTEP.raw > 0 && FIXED_TIMESTEP.raw < (1 << 15), "FIXED_TIMESTEP must be below 0.5");
+
+#ifdef __SSE2__
+// (value * timestep) >> 16 in each lane, rounded as Fixed's operator* rounds it. value is split
+// into its signed high and unsigned low 16 bits so that neither product needs more than 32.
+static inline __m128i multiply_timestep(__m128i value, __m128i timestep)
+{
+    __m128i high = _mm_srai_epi32(value, Fixed::FRACTION_BITS);
+    __m128i low = _mm_and_si128(value, _mm_set1_epi32(Fixed::ONE - 1));
+    return _mm_add_epi32(_mm_madd_epi16(high, timestep), _mm_mulhi_epu16(low, timestep));
+}
+
+static inline __m128i select(__m128i mask, __m128i if_set, __m128i if_clear)
+{
+    return _mm_or_si128(_mm_and_si128(mask, if_set), _mm_andnot_si128(mask, if_clear));
+}
+#endif
+
+void PongMatch::set_masks(const CollisionMask* paddle_mask, const CollisionMask* ball_mask)
+{
+    m_paddle_mask = paddle_mask;
+    m_ball_mask = ball_mask;
+}
+
+void PongMatch::reset()
+{
+    for (int player = 0; player < 2; player++)
+    {
+        m_paddles[player] = PongPaddle();
+        m_paddles[player].position = glm::vec3(player == 0 ? -PADDLE_X : PADDLE_X, 0.0f, 0.0f);
+    }
+
+    // Pre-creating three balls but only activating the first one; the others wait off the court
+    m_balls.assign(3, PongBall());
+    m_balls[0].position = glm::vec3(0.0f, 0.0f, 0.0f);
+    m_balls[0].velocity = glm::vec3(1.0f, 0.5f, 0.0f);
+    m_balls[0].is_active = true;
+    for (std::size_t i = 1; i < m_balls.size(); ++i)
+    {
+        m_balls[i].position = glm::vec3(-100.0f, -100.0f, 0.0f);
+        m_balls[i].velocity = glm::vec3(0.0f, 0.0f, 0.0f);
+    }
+
+    m_desired_ball_count = 1;
+    m_winner = 0;
+    m_tick = 0;
+}
+
+void PongMatch::apply_input(std::uint16_t buttons)
+{
+    if (is_game_over()) return;
+
+    PongPaddle& paddle1 = m_paddles[0];
+    PongPaddle& paddle2 = m_paddles[1];
+
+    if (buttons & INPUT_TOGGLE_AI) paddle2.is_ai_controlled = !paddle2.is_ai_controlled;
+    if (buttons & INPUT_ONE_BALL) m_desired_ball_count = 1;
+    if (buttons & INPUT_TWO_BALLS) m_desired_ball_count = 2;
+    if (buttons & INPUT_THREE_BALLS) m_desired_ball_count = 3;
+
+    if (buttons & INPUT_W) paddle1.movement_y = 1.0f;
+    if (buttons & INPUT_S) paddle1.movement_y = -1.0f;
+    if (!paddle2.is_ai_controlled)
+    {
+        if (buttons & INPUT_UP) paddle2.movement_y = 1.0f;
+        if (buttons & INPUT_DOWN) paddle2.movement_y = -1.0f;
+    }
+}
+
+void PongMatch::step()
+{
+    // The balls in play change only here, before anything moves them, and are always the first
+    // m_desired_ball_count of the array, so the update runs over them without testing each one
+    apply_ball_count();
+    int ball_count = std::min(m_desired_ball_count, (int)m_balls.size());
+
+    if (m_is_fixed_point)
+    {
+        // The paddles never depend on the balls, so they move first and the balls' one pass
+        // can check them against where the paddles end the tick
+        update_paddle_fixed(m_paddles[0]);
+        update_paddle_fixed(m_paddles[1]);
+        update_balls_fixed(ball_count);
+    }
+    else
+    {
+        for (int i = 0; i < ball_count; ++i) update_ball(m_balls[i]);
+        update_paddle(m_paddles[0]);
+        update_paddle(m_paddles[1]);
+        check_ball_collision();
+    }
+
+    m_tick++;
+}
+
+void PongMatch::apply_ball_count()
+{
+    // Enable or disable balls based on the desired count
+    for (int i = 0; i < (int)m_balls.size(); ++i)
+    {
+        PongBall& ball = m_balls[i];
+        if (i >= m_desired_ball_count) ball.is_active = false;
+        else if (!ball.is_active)
+        {
+            // Reseting the ball's position and velocity before activating it
+            ball.position = glm::vec3(0.0f, i + -2.0f, 0.0f);
+            ball.velocity = glm::vec3((i % 2 == 0 ? 1.0f : -1.0f), 0.5f, 0.0f);
+            ball.is_active = true;
+        }
+    }
+}
+
+void PongMatch::update_paddle(PongPaddle& paddle)
+{
+    float half_height = PADDLE_HEIGHT / 2.0f;
+
+    if (paddle.is_ai_controlled)
+    {
+        // Moving AI up or down, reversing direction at the screen edge
+        paddle.movement_y = paddle.is_ai_moving_up ? 1.0f : -1.0f;
+        float velocity_y = paddle.movement_y * PADDLE_SPEED;
+        paddle.position.y += velocity_y * PONG_TIMESTEP;
+
+        if (paddle.position.y + half_height >= COURT_HALF_HEIGHT) paddle.is_ai_moving_up = false;
+        else if (paddle.position.y - half_height <= -COURT_HALF_HEIGHT) paddle.is_ai_moving_up = true;
+
+        paddle.movement_y = 0.0f;
+    }
+
+    float velocity_y = paddle.movement_y * PADDLE_SPEED;
+    paddle.position.y += velocity_y * PONG_TIMESTEP;
+
+    // Preventing paddles from moving off the screen
+    if (paddle.position.y + half_height > COURT_HALF_HEIGHT) paddle.position.y = COURT_HALF_HEIGHT - half_height;
+    else if (paddle.position.y - half_height < -COURT_HALF_HEIGHT) paddle.position.y = -COURT_HALF_HEIGHT + half_height;
+
+    paddle.movement_y = 0.0f;
+}
+
+void PongMatch::update_ball(PongBall& ball)
+{
+    float half_size = BALL_SIZE / 2.0f;
+    ball.position += ball.velocity * PONG_TIMESTEP;
+
+    // Bouncing the ball off the top and bottom boundaries
+    if (ball.position.y + half_size > COURT_HALF_HEIGHT)
+    {
+        ball.position.y = COURT_HALF_HEIGHT - half_size;
+        ball.velocity.y = -ball.velocity.y;
+    }
+    else if (ball.position.y - half_size < -COURT_HALF_HEIGHT)
+    {
+        ball.position.y = -COURT_HALF_HEIGHT + half_size;
+        ball.velocity.y = -ball.velocity.y;
+    }
+}
+
+void PongMatch::check_ball_collision()
+{
+    float half_size = BALL_SIZE / 2.0f;
+
+    for (PongBall& ball : m_balls)
+    {
+        if (!ball.is_active) continue;
+
+        // Checking for collision with paddles: box test first, then the sprites' solid pixels
+        bool hits_paddle = false;
+        for (const PongPaddle& paddle : m_paddles)
+        {
+            bool hits_box = std::fabs(ball.position.x - paddle.position.x) - (BALL_SIZE + PADDLE_WIDTH) / 2.0f < 0.0f &&
+                std::fabs(ball.position.y - paddle.position.y) - (BALL_SIZE + PADDLE_HEIGHT) / 2.0f < 0.0f;
+            if (hits_box && (m_ball_mask == nullptr || m_paddle_mask == nullptr ||
+                masks_overlap(*m_ball_mask, ball.position, *m_paddle_mask, paddle.position)))
+            {
+                hits_paddle = true;
+            }
+        }
+        if (hits_paddle) ball.velocity.x = -ball.velocity.x;
+
+        // Checking for collision with the top and bottom of the screen
+        if (ball.position.y + half_size > COURT_HALF_HEIGHT || ball.position.y - half_size < -COURT_HALF_HEIGHT)
+        {
+            ball.velocity.y = -ball.velocity.y;
+        }
+
+        // Checking for collision with the left and right of the screen (endgame condition)
+        if (ball.position.x < -COURT_HALF_WIDTH)
+        {
+            m_winner = 2;
+            return;
+        }
+        else if (ball.position.x > COURT_HALF_WIDTH)
+        {
+            m_winner = 1;
+            return;
+        }
+    }
+}
+
+// ––––– FIXED-POINT STEP ––––– //
+// The same rules as above, worked in Q16.16. Positions and velocities are read from their float
+// fields and written back exactly (Fixed.h), so everything else sees ordinary PongBalls.
+
+void PongMatch::update_paddle_fixed(PongPaddle& paddle)
+{
+    Fixed position_y = Fixed::from_float(paddle.position.y);
+
+    if (paddle.is_ai_controlled)
+    {
+        Fixed movement_y = Fixed::from_raw(paddle.is_ai_moving_up ? Fixed::ONE : -Fixed::ONE);
+        position_y = position_y + movement_y * FIXED_PADDLE_SPEED * FIXED_TIMESTEP;
+
+        if (position_y + FIXED_PADDLE_HALF_HEIGHT >= FIXED_COURT_HALF_HEIGHT) paddle.is_ai_moving_up = false;
+        else if (position_y - FIXED_PADDLE_HALF_HEIGHT <= -FIXED_COURT_HALF_HEIGHT) paddle.is_ai_moving_up = true;
+    }
+
+    Fixed velocity_y = Fixed::from_float(paddle.movement_y) * FIXED_PADDLE_SPEED;
+    position_y = position_y + velocity_y * FIXED_TIMESTEP;
+
+    if (position_y + FIXED_PADDLE_HALF_HEIGHT > FIXED_COURT_HALF_HEIGHT) position_y = FIXED_COURT_HALF_HEIGHT - FIXED_PADDLE_HALF_HEIGHT;
+    else if (position_y - FIXED_PADDLE_HALF_HEIGHT < -FIXED_COURT_HALF_HEIGHT) position_y = -FIXED_COURT_HALF_HEIGHT + FIXED_PADDLE_HALF_HEIGHT;
+
+    paddle.position.y = position_y.to_float();
+    paddle.movement_y = 0.0f;
+}
+
+void PongMatch::update_ball_fixed(PongBall& ball)
+{
+    Fixed position_x = Fixed::from_float(ball.position.x), position_y = Fixed::from_float(ball.position.y);
+    Fixed velocity_x = Fixed::from_float(ball.velocity.x), velocity_y = Fixed::from_float(ball.velocity.y);
+
+    position_x = position_x + velocity_x * FIXED_TIMESTEP;
+    position_y = position_y + velocity_y * FIXED_TIMESTEP;
+
+    if (position_y + FIXED_BALL_HALF_SIZE > FIXED_COURT_HALF_HEIGHT)
+    {
+        position_y = FIXED_COURT_HALF_HEIGHT - FIXED_BALL_HALF_SIZE;
+        velocity_y = -velocity_y;
+    }
+    else if (position_y - FIXED_BALL_HALF_SIZE < -FIXED_COURT_HALF_HEIGHT)
+    {
+        position_y = -FIXED_COURT_HALF_HEIGHT + FIXED_BALL_HALF_SIZE;
+        velocity_y = -velocity_y;
+    }
+
+    ball.position.x = position_x.to_float();
+    ball.position.y = position_y.to_float();
+    ball.velocity.x = velocity_x.to_float();
+    ball.velocity.y = velocity_y.to_float();
+}
+
+// Everything check_ball_collision does for one ball, which must already have moved this tick.
+// Returns false once the ball reaches a goal, which ends the checks for the balls after it.
+bool PongMatch::collide_ball_fixed(PongBall& ball, const Fixed paddle_x[2], const Fixed paddle_y[2])
+{
+    Fixed position_x = Fixed::from_float(ball.position.x), position_y = Fixed::from_float(ball.position.y);
+
+    // Negating a float is exact, so the velocities are flipped in place
+    bool hits_paddle = false;
+    for (int player = 0; player < 2; player++)
+    {
+        bool hits_box = fixed_abs(position_x - paddle_x[player]) < FIXED_HIT_HALF_WIDTH &&
+            fixed_abs(position_y - paddle_y[player]) < FIXED_HIT_HALF_HEIGHT;
+        if (hits_box && (m_ball_mask == nullptr || m_paddle_mask == nullptr ||
+            masks_overlap(*m_ball_mask, position_x, position_y, *m_paddle_mask, paddle_x[player], paddle_y[player])))
+        {
+            hits_paddle = true;
+        }
+    }
+    if (hits_paddle) ball.velocity.x = -ball.velocity.x;
+
+    if (position_y + FIXED_BALL_HALF_SIZE > FIXED_COURT_HALF_HEIGHT || position_y - FIXED_BALL_HALF_SIZE < -FIXED_COURT_HALF_HEIGHT)
+    {
+        ball.velocity.y = -ball.velocity.y;
+    }
+
+    if (position_x < -FIXED_COURT_HALF_WIDTH)
+    {
+        m_winner = 2;
+        return false;
+    }
+    else if (position_x > FIXED_COURT_HALF_WIDTH)
+    {
+        m_winner = 1;
+        return false;
+    }
+    return true;
+}
+
+// Moves the first count balls, which are the ones in play, and then checks each against the
+// paddles as check_ball_collision does; the paddles must already have moved. Where SSE2 is
+// available, four balls move at a time and only groups with a ball near a paddle, a wall or a
+// goal take the scalar collision check. Both paths give the same bits, so builds with and
+// without it stay in step.
+void PongMatch::update_balls_fixed(int count)
+{
+    Fixed paddle_x[2], paddle_y[2];
+    for (int player = 0; player < 2; player++)
+    {
+        paddle_x[player] = Fixed::from_float(m_paddles[player].position.x);
+        paddle_y[player] = Fixed::from_float(m_paddles[player].position.y);
+    }
+
+    bool is_colliding = true;  // Until a goal, as check_ball_collision stops at the first
+    int i = 0;
+
+#ifdef __SSE2__
+    // Each ball's position.x, .y, .z and velocity.x are loaded and stored as one row
+    static_assert(offsetof(PongBall, velocity) == offsetof(PongBall, position) + 3 * sizeof(float), "PongBall must be packed floats");
+
+    const __m128 to_fixed = _mm_set1_ps((float)Fixed::ONE), to_float = _mm_set1_ps(1.0f / (float)Fixed::ONE);
+    const __m128i timestep = _mm_set1_epi32(FIXED_TIMESTEP.raw);
+    const __m128i half_size = _mm_set1_epi32(FIXED_BALL_HALF_SIZE.raw);
+    const __m128i top = _mm_set1_epi32(FIXED_COURT_HALF_HEIGHT.raw), bottom = _mm_set1_epi32(-FIXED_COURT_HALF_HEIGHT.raw);
+    const __m128i top_limit = _mm_set1_epi32((FIXED_COURT_HALF_HEIGHT - FIXED_BALL_HALF_SIZE).raw);
+    const __m128i bottom_limit = _mm_set1_epi32((-FIXED_COURT_HALF_HEIGHT + FIXED_BALL_HALF_SIZE).raw);
+    const __m128i right_goal = _mm_set1_epi32(FIXED_COURT_HALF_WIDTH.raw), left_goal = _mm_set1_epi32(-FIXED_COURT_HALF_WIDTH.raw);
+    const __m128i zero = _mm_setzero_si128();
+
+    // A ball is near a paddle when inside the box test's bounds around it
+    __m128i near_left[2], near_right[2], near_bottom[2], near_top[2];
+    for (int player = 0; player < 2; player++)
+    {
+        near_left[player] = _mm_set1_epi32((paddle_x[player] - FIXED_HIT_HALF_WIDTH).raw);
+        near_right[player] = _mm_set1_epi32((paddle_x[player] + FIXED_HIT_HALF_WIDTH).raw);
+        near_bottom[player] = _mm_set1_epi32((paddle_y[player] - FIXED_HIT_HALF_HEIGHT).raw);
+        near_top[player] = _mm_set1_epi32((paddle_y[player] + FIXED_HIT_HALF_HEIGHT).raw);
+    }
+
+    for (; i + 4 <= count; i += 4)
+    {
+        PongBall* balls = &m_balls[i];
+        __m128 row0 = _mm_loadu_ps(&balls[0].position.x), row1 = _mm_loadu_ps(&balls[1].position.x);
+        __m128 row2 = _mm_loadu_ps(&balls[2].position.x), row3 = _mm_loadu_ps(&balls[3].position.x);
+        _MM_TRANSPOSE4_PS(row0, row1, row2, row3);  // Now x, y, z and velocity x of all four
+
+        __m128i position_x = _mm_cvttps_epi32(_mm_mul_ps(row0, to_fixed));
+        __m128i position_y = _mm_cvttps_epi32(_mm_mul_ps(row1, to_fixed));
+        __m128i velocity_x = _mm_cvttps_epi32(_mm_mul_ps(row3, to_fixed));
+        __m128i velocity_y = _mm_cvttps_epi32(_mm_mul_ps(_mm_setr_ps(balls[0].velocity.y, balls[1].velocity.y, balls[2].velocity.y, balls[3].velocity.y), to_fixed));
+
+        position_x = _mm_add_epi32(position_x, multiply_timestep(velocity_x, timestep));
+        position_y = _mm_add_epi32(position_y, multiply_timestep(velocity_y, timestep));
+
+        __m128i above = _mm_cmpgt_epi32(_mm_add_epi32(position_y, half_size), top);
+        __m128i below = _mm_andnot_si128(above, _mm_cmplt_epi32(_mm_sub_epi32(position_y, half_size), bottom));
+        position_y = select(above, top_limit, select(below, bottom_limit, position_y));
+        velocity_y = select(_mm_or_si128(above, below), _mm_sub_epi32(zero, velocity_y), velocity_y);
+
+        row0 = _mm_mul_ps(_mm_cvtepi32_ps(position_x), to_float);
+        row1 = _mm_mul_ps(_mm_cvtepi32_ps(position_y), to_float);
+        row3 = _mm_mul_ps(_mm_cvtepi32_ps(velocity_x), to_float);
+        float new_velocity_y[4];
+        _mm_storeu_ps(new_velocity_y, _mm_mul_ps(_mm_cvtepi32_ps(velocity_y), to_float));
+        _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+        _mm_storeu_ps(&balls[0].position.x, row0);
+        _mm_storeu_ps(&balls[1].position.x, row1);
+        _mm_storeu_ps(&balls[2].position.x, row2);
+        _mm_storeu_ps(&balls[3].position.x, row3);
+        for (int lane = 0; lane < 4; lane++) balls[lane].velocity.y = new_velocity_y[lane];
+
+        if (!is_colliding) continue;
+
+        // The wall bounce above leaves every ball inside the top and bottom, so only paddles and
+        // goals can need the full check
+        __m128i needs_check = _mm_or_si128(_mm_cmpgt_epi32(position_x, right_goal), _mm_cmplt_epi32(position_x, left_goal));
+        for (int player = 0; player < 2; player++)
+        {
+            __m128i near_paddle = _mm_and_si128(
+                _mm_and_si128(_mm_cmpgt_epi32(position_x, near_left[player]), _mm_cmplt_epi32(position_x, near_right[player])),
+                _mm_and_si128(_mm_cmpgt_epi32(position_y, near_bottom[player]), _mm_cmplt_epi32(position_y, near_top[player])));
+            needs_check = _mm_or_si128(needs_check, near_paddle);
+        }
+        if (_mm_movemask_epi8(needs_check) == 0) continue;
+
+        for (int lane = 0; lane < 4 && is_colliding; lane++) is_colliding = collide_ball_fixed(balls[lane], paddle_x, paddle_y);
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        update_ball_fixed(m_balls[i]);
+        if (is_colliding) is_colliding = collide_ball_fixed(m_balls[i], paddle_x, paddle_y);
+    }
+}
+
+void PongMatch::save(GameSnapshot& snapshot) const
+{
+    snapshot.tick = m_tick;
+    snapshot.paddle_y[0] = m_paddles[0].position.y;
+    snapshot.paddle_y[1] = m_paddles[1].position.y;
+    snapshot.desired_ball_count = (std::uint8_t)m_desired_ball_count;
+    snapshot.winner = (std::uint8_t)m_winner;
+    snapshot.is_paddle2_ai_controlled = m_paddles[1].is_ai_controlled;
+    snapshot.is_paddle2_ai_moving_up = m_paddles[1].is_ai_moving_up;
+
+    int ball_count = std::min((int)m_balls.size(), GAME_SNAPSHOT_BALLS);
+    for (int i = 0; i < ball_count; i++)
+    {
+        const PongBall& ball = m_balls[i];
+        snapshot.balls[i] = { ball.position.x, ball.position.y, ball.velocity.x, ball.velocity.y, ball.is_active };
+    }
+}
+
+void PongMatch::load(const GameSnapshot& snapshot)
+{
+    m_tick = snapshot.tick;
+    m_desired_ball_count = snapshot.desired_ball_count;
+    m_winner = snapshot.winner;
+
+    for (int i = 0; i < 2; i++)
+    {
+        m_paddles[i].position = glm::vec3(m_paddles[i].position.x, snapshot.paddle_y[i], 0.0f);
+    }
+    m_paddles[1].is_ai_controlled = snapshot.is_paddle2_ai_controlled;
+    m_paddles[1].is_ai_moving_up = snapshot.is_paddle2_ai_moving_up;
+
+    int ball_count = std::min((int)m_balls.size(), GAME_SNAPSHOT_BALLS);
+    for (int i = 0; i < ball_count; i++)
+    {
+        const GameSnapshot::Ball& saved = snapshot.balls[i];
+        m_balls[i].position = glm::vec3(saved.x, saved.y, 0.0f);
+        m_balls[i].velocity = glm::vec3(saved.velocity_x, saved.velocity_y, 0.0f);
+        m_balls[i].is_active = saved.is_active;
+    }
+}
+
+std::uint16_t PongMatch::get_bot_buttons(int player) const
+{
+    const PongPaddle& paddle = m_paddles[player];
+    const PongBall* target = nullptr;
+    float target_distance = 0.0f;
+
+    for (const PongBall& ball : m_balls)
+    {
+        if (!ball.is_active) continue;
+
+        float distance = std::fabs(ball.position.x - paddle.position.x);
+        if (target == nullptr || distance < target_distance)
+        {
+            target = &ball;
+            target_distance = distance;
+        }
+    }
+    if (target == nullptr) return 0;
+
+    float offset = target->position.y - paddle.position.y;
+    if (offset > BOT_DEAD_ZONE) return player == 0 ? INPUT_W : INPUT_UP;
+    if (offset < -BOT_DEAD_ZONE) return player == 0 ? INPUT_S : INPUT_DOWN;
+    return 0;
+}
@@ -0,0 +1,151 @@
+#ifndef PONG_MATCH_H
+#define PONG_MATCH_H
+
+#include <cstdint>
+#include <vector>
+#include "glm/glm.hpp"
+#include "CollisionMask.h"
+#include "Fixed.h"
+
+// ––––– PONG MATCH ––––– //
+// One game of Pong as plain data: the paddles, the balls and the rules that move them, with
+// no window, textures or GL. The game steps one of these and draws it; the match server steps
+// thousands of them. Each step is one FIXED_TIMESTEP tick:
+//
+//     match.apply_input(buttons);
+//     match.step();
+//
+// Stepping goes on after a win, as it always has in the game, so the balls keep moving
+// behind the message; only input stops.
+//
+// By default the rules run in float, whose results can change with compiler flags and FMA
+// contraction. set_fixed_point(true) runs them in Q16.16 integers instead (Fixed.h), which
+// give the same bits on every build and machine, so peers in a networked match never drift
+// apart. Every peer and replay of a match must use the same mode.
+
+// Buttons a tick's input is made of, one bit each so a frame's input fits in an InputFrame
+constexpr std::uint16_t INPUT_W = 1 << 0,
+INPUT_S = 1 << 1,
+INPUT_UP = 1 << 2,
+INPUT_DOWN = 1 << 3,
+INPUT_TOGGLE_AI = 1 << 4,  // Pressed this frame, not held
+INPUT_ONE_BALL = 1 << 5,
+INPUT_TWO_BALLS = 1 << 6,
+INPUT_THREE_BALLS = 1 << 7;
+
+// Buttons each player sends in a networked match, where player 1 also owns the match
+// settings. Held buttons are predicted to stay down until the peer says otherwise.
+constexpr std::uint16_t PLAYER1_BUTTONS = INPUT_W | INPUT_S | INPUT_TOGGLE_AI | INPUT_ONE_BALL | INPUT_TWO_BALLS | INPUT_THREE_BALLS,
+PLAYER2_BUTTONS = INPUT_UP | INPUT_DOWN,
+HELD_BUTTONS = INPUT_W | INPUT_S | INPUT_UP | INPUT_DOWN;
+
+constexpr float PONG_TIMESTEP = 0.0166666f;  // FIXED_TIMESTEP in main.cpp
+constexpr float BOT_DEAD_ZONE = 0.2f;
+constexpr int GAME_SNAPSHOT_BALLS = 3;
+
+// Everything a tick reads or writes, small enough to save every tick
+struct GameSnapshot
+{
+    std::uint32_t tick;
+    float paddle_y[2];
+    std::uint8_t desired_ball_count;
+    std::uint8_t winner;              // 0 while playing, otherwise the winning player's number
+    bool is_paddle2_ai_controlled;
+    bool is_paddle2_ai_moving_up;
+
+    struct Ball
+    {
+        float x, y, velocity_x, velocity_y;
+        bool is_active;
+    } balls[GAME_SNAPSHOT_BALLS];
+};
+
+struct PongPaddle
+{
+    glm::vec3 position;
+    float movement_y = 0.0f;
+    bool is_ai_controlled = false;
+    bool is_ai_moving_up = true;  // AI starts by moving up
+};
+
+struct PongBall
+{
+    glm::vec3 position;
+    glm::vec3 velocity;
+    bool is_active = false;
+};
+
+class PongMatch
+{
+private:
+    PongPaddle m_paddles[2];
+    std::vector<PongBall> m_balls;
+    int m_desired_ball_count = 1;
+    int m_winner = 0;
+    std::uint32_t m_tick = 0;
+    bool m_is_fixed_point = false;
+
+    // Shared and read-only, so one pair serves every match on every thread
+    const CollisionMask* m_paddle_mask = nullptr;
+    const CollisionMask* m_ball_mask = nullptr;
+
+    void apply_ball_count();
+    void update_paddle(PongPaddle& paddle);
+    void update_ball(PongBall& ball);
+    void check_ball_collision();
+
+    void update_paddle_fixed(PongPaddle& paddle);
+    void update_ball_fixed(PongBall& ball);
+    void update_balls_fixed(int count);
+    bool collide_ball_fixed(PongBall& ball, const Fixed paddle_x[2], const Fixed paddle_y[2]);
+
+public:
+    // ————— SIZES ————— //
+    static constexpr float PADDLE_SPEED = 2.0f;
+    static constexpr float PADDLE_X = 4.5f;
+    static constexpr float PADDLE_WIDTH = 0.5f, PADDLE_HEIGHT = 1.5f;
+    static constexpr float BALL_SIZE = 0.5f;
+    static constexpr float COURT_HALF_HEIGHT = 3.75f, COURT_HALF_WIDTH = 5.0f;
+
+    PongMatch() { reset(); }
+
+    // Masks refine the box test for ball and paddle hits; without them the box test decides
+    void set_masks(const CollisionMask* paddle_mask, const CollisionMask* ball_mask);
+
+    // Back to the opening layout: three balls, only the first of them in play
+    void reset();
+
+    void apply_input(std::uint16_t buttons);
+    void step();
+
+    void save(GameSnapshot& snapshot) const;
+    void load(const GameSnapshot& snapshot);
+
+    // A stand-in player that moves its paddle (0 or 1) toward the nearest active ball
+    std::uint16_t get_bot_buttons(int player) const;
+
+    // ————— GETTERS ————— //
+    std::uint32_t get_tick() const { return m_tick; }
+    bool is_game_over() const { return m_winner != 0; }
+    int get_winner() const { return m_winner; }
+    int get_desired_ball_count() const { return m_desired_ball_count; }
+    bool is_fixed_point() const { return m_is_fixed_point; }
+    const PongPaddle& get_paddle(int player) const { return m_paddles[player]; }
+    const std::vector<PongBall>& get_balls() const { return m_balls; }
+
+    // ————— SETTERS ————— //
+    // For stress scenes, which replace the balls wholesale
+    std::vector<PongBall>& get_balls() { return m_balls; }
+    void set_desired_ball_count(int count) { m_desired_ball_count = count; }
+
+    // Not part of the state; left alone by reset() and snapshots
+    void set_fixed_point(bool is_fixed_point) { m_is_fixed_point = is_fixed_point; }
+};
+
+// Both players' buttons as one tick's input, each limited to what that player controls
+inline std::uint16_t combine_player_buttons(const std::uint16_t inputs[2])
+{
+    return (inputs[0] & PLAYER1_BUTTONS) | (inputs[1] & PLAYER2_BUTTONS);
+}
+
+#endif // PONG_MATCH_H
@@ -0,0 +1,84 @@
+#include "Profiler.h"
+
+#ifdef ENABLE_PROFILER
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+struct ProfileEvent
+{
+    const char* name;
+    std::uint64_t start_ns;
+    std::uint64_t end_ns;
+};
+
+// One per thread that has recorded a zone. Only the owning thread writes to it.
+struct ProfileRing
+{
+    int thread_index;
+    std::atomic<std::uint64_t> count{ 0 };
+    ProfileEvent events[PROFILE_RING_CAPACITY];
+};
+
+static std::mutex g_rings_mutex;
+static std::vector<ProfileRing*> g_rings;  // Never freed, so a finished thread's zones still export
+static thread_local ProfileRing* t_ring = nullptr;
+
+static const std::chrono::steady_clock::time_point PROFILER_EPOCH = std::chrono::steady_clock::now();
+
+std::uint64_t profiler_now_ns()
+{
+    return (std::uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - PROFILER_EPOCH).count();
+}
+
+void profiler_record(const char* name, std::uint64_t start_ns, std::uint64_t end_ns)
+{
+    if (t_ring == nullptr)
+    {
+        // Registration is the only time a thread takes the lock
+        std::lock_guard<std::mutex> lock(g_rings_mutex);
+        t_ring = new ProfileRing();
+        t_ring->thread_index = (int)g_rings.size();
+        g_rings.push_back(t_ring);
+    }
+
+    std::uint64_t count = t_ring->count.load(std::memory_order_relaxed);
+    t_ring->events[count % PROFILE_RING_CAPACITY] = { name, start_ns, end_ns };
+    t_ring->count.store(count + 1, std::memory_order_release);
+}
+
+bool profiler_write_chrome_trace(const char* filepath)
+{
+    std::FILE* file = std::fopen(filepath, "w");
+    if (file == nullptr) return false;
+
+    std::fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    bool first = true;
+
+    std::lock_guard<std::mutex> lock(g_rings_mutex);
+    for (const ProfileRing* ring : g_rings)
+    {
+        std::uint64_t count = ring->count.load(std::memory_order_acquire);
+        std::uint64_t oldest = count > (std::uint64_t)PROFILE_RING_CAPACITY ? count - PROFILE_RING_CAPACITY : 0;
+
+        for (std::uint64_t i = oldest; i < count; i++)
+        {
+            const ProfileEvent& event = ring->events[i % PROFILE_RING_CAPACITY];
+
+            // Complete ("X") events, timestamps in microseconds
+            std::fprintf(file, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                first ? "" : ",", event.name, ring->thread_index,
+                event.start_ns / 1000.0, (event.end_ns - event.start_ns) / 1000.0);
+            first = false;
+        }
+    }
+
+    std::fprintf(file, "\n]}\n");
+    return std::fclose(file) == 0;
+}
+
+#endif
@@ -0,0 +1,131 @@
+#include <cstring>
+#include "Rollback.h"
+
+// Packet layout: an InputPacketHeader, then count buttons values for the ticks from
+// first_tick on. Native byte order, as both peers run the same build.
+constexpr std::uint32_t INPUT_PACKET_MAGIC = 0x474E4F50;  // "PONG" read as little-endian
+
+struct InputPacketHeader
+{
+    std::uint32_t magic;
+    std::uint32_t first_tick;
+    std::uint32_t acknowledged_end;  // Ticks of the receiver's input the sender has confirmed
+    std::uint16_t count;
+    std::uint16_t reserved;
+};
+
+constexpr std::size_t INPUT_PACKET_CAPACITY = sizeof(InputPacketHeader) + INPUT_HISTORY_SIZE * sizeof(std::uint16_t);
+
+RollbackSession::RollbackSession(int local_player, std::uint16_t held_buttons)
+    : m_local_player(local_player), m_held_buttons(held_buttons)
+{
+}
+
+void RollbackSession::reset(std::uint32_t tick)
+{
+    m_start_tick = m_local_end = m_remote_end = m_acknowledged_end = tick;
+    m_rollback_tick = UINT32_MAX;
+    m_stats = RollbackStats();
+}
+
+void RollbackSession::receive(NetTransport& transport, std::uint32_t current_tick)
+{
+    unsigned char packet[INPUT_PACKET_CAPACITY];
+    std::size_t size;
+
+    while ((size = transport.receive(packet, sizeof(packet))) >= sizeof(InputPacketHeader))
+    {
+        InputPacketHeader header;
+        std::memcpy(&header, packet, sizeof(header));
+        if (header.magic != INPUT_PACKET_MAGIC || header.count > INPUT_HISTORY_SIZE) continue;
+        if (size < sizeof(header) + header.count * sizeof(std::uint16_t)) continue;
+
+        if (header.acknowledged_end > m_acknowledged_end && header.acknowledged_end <= m_local_end)
+        {
+            m_acknowledged_end = header.acknowledged_end;
+        }
+
+        // Only the next tick in order is taken; anything past a gap is resent until acknowledged
+        for (std::uint32_t i = 0; i < header.count; i++)
+        {
+            std::uint32_t tick = header.first_tick + i;
+            if (tick < m_remote_end) continue;
+            if (tick > m_remote_end) break;
+
+            std::uint16_t buttons;
+            std::memcpy(&buttons, packet + sizeof(header) + i * sizeof(buttons), sizeof(buttons));
+
+            int slot = tick % INPUT_HISTORY_SIZE;
+            m_remote_inputs[slot] = buttons;
+            if (tick < current_tick && buttons != m_used_remote_inputs[slot] && tick < m_rollback_tick)
+            {
+                m_rollback_tick = tick;
+            }
+            m_remote_end++;
+        }
+    }
+}
+
+void RollbackSession::finish_rollback(std::uint32_t current_tick, double seconds)
+{
+    int depth = (int)(current_tick - m_rollback_tick);
+
+    m_stats.rollbacks++;
+    m_stats.resimulated_ticks += depth;
+    m_stats.resimulation_seconds += seconds;
+    if (depth > m_stats.max_depth) m_stats.max_depth = depth;
+
+    m_rollback_tick = UINT32_MAX;
+}
+
+bool RollbackSession::can_advance(std::uint32_t tick)
+{
+    bool can_predict = (std::int64_t)tick - m_remote_end < MAX_ROLLBACK_TICKS;
+    bool can_resend = (std::int64_t)tick - m_acknowledged_end < INPUT_HISTORY_SIZE;
+    if (can_predict && can_resend) return true;
+
+    m_stats.stalled_ticks++;
+    return false;
+}
+
+void RollbackSession::add_local_input(std::uint32_t tick, std::uint16_t buttons)
+{
+    if (tick != m_local_end) return;
+
+    m_local_inputs[tick % INPUT_HISTORY_SIZE] = buttons;
+    m_local_end++;
+}
+
+void RollbackSession::send(NetTransport& transport) const
+{
+    InputPacketHeader header;
+    header.magic = INPUT_PACKET_MAGIC;
+    header.first_tick = m_acknowledged_end;
+    header.acknowledged_end = m_remote_end;
+    header.count = (std::uint16_t)(m_local_end - m_acknowledged_end);
+    header.reserved = 0;
+
+    unsigned char packet[INPUT_PACKET_CAPACITY];
+    std::memcpy(packet, &header, sizeof(header));
+    for (std::uint32_t i = 0; i < header.count; i++)
+    {
+        std::uint16_t buttons = m_local_inputs[(header.first_tick + i) % INPUT_HISTORY_SIZE];
+        std::memcpy(packet + sizeof(header) + i * sizeof(buttons), &buttons, sizeof(buttons));
+    }
+
+    transport.send(packet, sizeof(header) + header.count * sizeof(std::uint16_t));
+}
+
+void RollbackSession::get_inputs(std::uint32_t tick, std::uint16_t inputs[2])
+{
+    int slot = tick % INPUT_HISTORY_SIZE;
+    std::uint16_t remote;
+
+    if (tick < m_remote_end) remote = m_remote_inputs[slot];
+    else if (m_remote_end == m_start_tick) remote = 0;
+    else remote = m_remote_inputs[(m_remote_end - 1) % INPUT_HISTORY_SIZE] & m_held_buttons;
+
+    m_used_remote_inputs[slot] = remote;
+    inputs[m_local_player] = m_local_inputs[slot];
+    inputs[1 - m_local_player] = remote;
+}
@@ -0,0 +1,89 @@
+#ifndef ROLLBACK_H
+#define ROLLBACK_H
+
+#include <cstdint>
+#include "NetTransport.h"
+#include "PongMatch.h"
+
+// ––––– ROLLBACK NETCODE ––––– //
+// Each peer simulates every tick as soon as its own input is in, predicting that the remote
+// player is still holding what they last sent. Every tick's starting state is kept, so when
+// the real input arrives and differs, the game restores the state from the first wrong tick
+// and re-simulates up to the present:
+//
+//     session.receive(transport, g_tick);
+//     if (session.needs_rollback()) { restore the tick's snapshot, re-run to the present }
+//     if (session.can_advance(g_tick)) { add_local_input, save the snapshot, run the tick }
+//     session.send(transport);
+//
+// The session only handles inputs and snapshots; simulating is left to the caller.
+
+constexpr int MAX_ROLLBACK_TICKS = 15;           // How far a peer may run ahead of confirmed input
+constexpr int SNAPSHOT_RING_SIZE = MAX_ROLLBACK_TICKS + 1;
+constexpr int INPUT_HISTORY_SIZE = 64;           // Local inputs kept for resending until acknowledged
+
+struct RollbackStats
+{
+    std::uint64_t rollbacks = 0;
+    std::uint64_t resimulated_ticks = 0;
+    std::uint64_t stalled_ticks = 0;     // Ticks not run because the peer fell too far behind
+    int max_depth = 0;
+    double resimulation_seconds = 0.0;
+};
+
+class RollbackSession
+{
+private:
+    int m_local_player;                  // 0 or 1
+    std::uint16_t m_held_buttons;        // Buttons that are predicted to stay down; the rest are presses
+
+    std::uint16_t m_local_inputs[INPUT_HISTORY_SIZE] = { };
+    std::uint16_t m_remote_inputs[INPUT_HISTORY_SIZE] = { };
+    std::uint16_t m_used_remote_inputs[INPUT_HISTORY_SIZE] = { };  // What each simulated tick assumed
+    GameSnapshot m_snapshots[SNAPSHOT_RING_SIZE];
+
+    std::uint32_t m_start_tick = 0;
+    std::uint32_t m_local_end = 0;         // Ticks with local input
+    std::uint32_t m_remote_end = 0;        // Ticks with confirmed remote input, all contiguous
+    std::uint32_t m_acknowledged_end = 0;  // Local ticks the peer has confirmed
+    std::uint32_t m_rollback_tick = UINT32_MAX;
+
+    RollbackStats m_stats;
+
+public:
+    RollbackSession(int local_player, std::uint16_t held_buttons);
+
+    void reset(std::uint32_t tick);
+
+    // ————— NETWORK ————— //
+    // Reads every packet that has arrived. Any confirmed input that differs from what a tick
+    // before current_tick was simulated with marks that tick for a rollback.
+    void receive(NetTransport& transport, std::uint32_t current_tick);
+    bool needs_rollback() const { return m_rollback_tick != UINT32_MAX; }
+    std::uint32_t get_rollback_tick() const { return m_rollback_tick; }
+
+    // Records the rollback's cost and clears it
+    void finish_rollback(std::uint32_t current_tick, double seconds);
+
+    // False while the peer's confirmed input or acknowledgements are too far behind, in
+    // which case the tick waits for them rather than predicting further
+    bool can_advance(std::uint32_t tick);
+
+    void add_local_input(std::uint32_t tick, std::uint16_t buttons);
+
+    // Sends every local input the peer has not acknowledged, so lost packets are covered.
+    // Called every tick, stalled or not, so a stall is never waiting on a lost packet.
+    void send(NetTransport& transport) const;
+
+    // ————— SIMULATION ————— //
+    // Both players' buttons for the tick, predicting the remote player's when unconfirmed
+    void get_inputs(std::uint32_t tick, std::uint16_t inputs[2]);
+
+    GameSnapshot& get_snapshot(std::uint32_t tick) { return m_snapshots[tick % SNAPSHOT_RING_SIZE]; }
+
+    int get_local_player() const { return m_local_player; }
+    std::uint32_t get_confirmed_end() const { return m_remote_end < m_local_end ? m_remote_end : m_local_end; }
+    const RollbackStats& get_stats() const { return m_stats; }
+};
+
+#endif // ROLLBACK_H
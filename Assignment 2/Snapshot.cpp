@@ -0,0 +1,196 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include "Snapshot.h"
+
+constexpr char SNAPSHOT_MAGIC[4] = { 'S', 'N', 'A', 'P' };
+constexpr std::uint8_t SNAPSHOT_VERSION = 1;
+
+static std::uint32_t low_bits_mask(int bits)
+{
+    return bits >= 32 ? 0xFFFFFFFFu : (1u << bits) - 1;
+}
+
+// Bits needed to hold every value from 0 to range
+static int bits_required(std::uint32_t range)
+{
+    int bits = 0;
+    while (bits < 32 && (range >> bits) != 0) bits++;
+    return bits;
+}
+
+void SnapshotStream::begin_write(SnapshotPrecision precision, const SnapshotFields* baseline)
+{
+    m_words.assign(1, 0);
+    m_fields.clear();
+    m_scratch = 0;
+    m_scratch_bits = 0;
+    m_bit_position = 0;
+    m_is_reading = false;
+    m_has_error = false;
+    m_precision = precision;
+    m_baseline = baseline;
+}
+
+void SnapshotStream::begin_read(const std::uint8_t* data, std::size_t size, SnapshotPrecision precision, const SnapshotFields* baseline)
+{
+    m_fields.clear();
+    m_read_data = data;
+    m_read_size = size;
+    m_scratch = 0;
+    m_scratch_bits = 0;
+    m_bit_position = 0;
+    m_is_reading = true;
+    m_has_error = false;
+    m_precision = precision;
+    m_baseline = baseline;
+}
+
+// Least significant bits first. Bits gather in a 64-bit scratch and are only ever stored, never
+// read back from memory, with the partial word kept current so the data is complete at any point.
+void SnapshotStream::write_bits(std::uint32_t value, int bits)
+{
+    m_scratch |= (std::uint64_t)(value & low_bits_mask(bits)) << m_scratch_bits;
+    m_scratch_bits += bits;
+    m_bit_position += bits;
+
+    if (m_scratch_bits >= 32)
+    {
+        m_words.back() = (std::uint32_t)m_scratch;
+        m_scratch >>= 32;
+        m_scratch_bits -= 32;
+        m_words.push_back((std::uint32_t)m_scratch);
+    }
+    else
+    {
+        m_words.back() = (std::uint32_t)m_scratch;
+    }
+}
+
+std::uint32_t SnapshotStream::read_bits(int bits)
+{
+    if (m_has_error) return 0;
+    if (m_bit_position + bits > m_read_size * 8)
+    {
+        m_has_error = true;
+        return 0;
+    }
+
+    if (m_scratch_bits < bits)
+    {
+        // The last word may be short; it is zero-filled rather than read past the end
+        std::size_t byte = (m_bit_position + m_scratch_bits) >> 3;
+        std::uint32_t word = 0;
+        std::memcpy(&word, m_read_data + byte, std::min<std::size_t>(sizeof(word), m_read_size - byte));
+
+        m_scratch |= (std::uint64_t)word << m_scratch_bits;
+        m_scratch_bits += 32;
+    }
+
+    std::uint32_t value = (std::uint32_t)m_scratch & low_bits_mask(bits);
+    m_scratch >>= bits;
+    m_scratch_bits -= bits;
+    m_bit_position += bits;
+    return value;
+}
+
+void SnapshotStream::serialize_bits(std::uint32_t& value, int bits)
+{
+    if (!m_is_reading) value &= low_bits_mask(bits);
+
+    if (m_baseline == nullptr)
+    {
+        if (m_is_reading) value = read_bits(bits);
+        else write_bits(value, bits);
+    }
+    else
+    {
+        // Fields past the end of the baseline are compared against zero
+        std::size_t index = m_fields.size();
+        std::uint32_t baseline_value = index < m_baseline->size() ? (*m_baseline)[index] : 0;
+
+        if (m_is_reading)
+        {
+            bool is_unchanged = read_bits(1) != 0;
+            value = is_unchanged ? baseline_value : read_bits(bits);
+        }
+        else
+        {
+            bool is_unchanged = value == baseline_value;
+            write_bits(is_unchanged ? 1 : 0, 1);
+            if (!is_unchanged) write_bits(value, bits);
+        }
+    }
+
+    m_fields.push_back(value);
+}
+
+void SnapshotStream::serialize_bool(bool& value)
+{
+    std::uint32_t bits = value ? 1 : 0;
+    serialize_bits(bits, 1);
+    value = bits != 0;
+}
+
+void SnapshotStream::serialize_int(int& value, int min, int max)
+{
+    std::uint32_t range = (std::uint32_t)(max - min);
+    std::uint32_t offset = m_is_reading ? 0 : (std::uint32_t)(std::min(std::max(value, min), max) - min);
+    serialize_bits(offset, bits_required(range));
+
+    if (!m_is_reading) return;
+    if (offset > range)
+    {
+        m_has_error = true;
+        offset = 0;
+    }
+    value = (int)(min + (std::int64_t)offset);
+}
+
+void SnapshotStream::serialize_float(float& value, float min, float max, int bits)
+{
+    if (m_precision == SNAPSHOT_LOSSLESS)
+    {
+        std::uint32_t raw;
+        std::memcpy(&raw, &value, sizeof(raw));
+        serialize_bits(raw, 32);
+        if (m_is_reading) std::memcpy(&value, &raw, sizeof(value));
+        return;
+    }
+
+    double steps = (double)low_bits_mask(bits);
+    std::uint32_t quantized = 0;
+    if (!m_is_reading)
+    {
+        double normalized = ((double)std::min(std::max(value, min), max) - min) / ((double)max - min);
+        quantized = (std::uint32_t)(normalized * steps + 0.5);
+    }
+    serialize_bits(quantized, bits);
+    if (m_is_reading) value = (float)(min + quantized / steps * ((double)max - min));
+}
+
+bool save_snapshot_file(const char* filepath, const SnapshotStream& stream)
+{
+    std::ofstream file(filepath, std::ios::binary);
+    if (!file) return false;
+
+    file.write(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    file.put((char)SNAPSHOT_VERSION);
+    file.write((const char*)stream.get_data(), (std::streamsize)stream.get_size());
+    return (bool)file;
+}
+
+bool load_snapshot_file(const char* filepath, std::vector<std::uint8_t>& bytes)
+{
+    std::ifstream file(filepath, std::ios::binary);
+    if (!file) return false;
+
+    std::vector<std::uint8_t> contents((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (contents.size() < 5) return false;
+    if (std::memcmp(contents.data(), SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) return false;
+    if (contents[4] != SNAPSHOT_VERSION) return false;
+
+    bytes.assign(contents.begin() + 5, contents.end());
+    return true;
+}
@@ -0,0 +1,83 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// ––––– STATE SNAPSHOTS ––––– //
+// The simulation state as a bit-packed run of fields. The game has one serialize function that
+// visits every field in a fixed order and is used for both directions, so what is written and
+// what is read back cannot drift apart:
+//
+//     int lives = g_lives;
+//     stream.serialize_int(lives, 0, MAX_LIVES);
+//     if (stream.is_reading()) g_lives = lives;
+//
+// Lossless streams keep each float's exact bits, so a restored game carries on exactly as the
+// original would have; that is what saves, restarts and replays need. Quantized streams round
+// each float into its range with the given number of bits, for replication, where only what the
+// player sees has to match.
+//
+// Given a baseline (the fields of an earlier snapshot), each field costs a single bit when it
+// matches the baseline field in the same position, so a delta against the previous tick is
+// mostly whatever moved. Reading needs the same baseline the snapshot was written against.
+
+enum SnapshotPrecision { SNAPSHOT_LOSSLESS, SNAPSHOT_QUANTIZED };
+
+// Every field of a snapshot, unpacked, in the order they were serialized
+typedef std::vector<std::uint32_t> SnapshotFields;
+
+class SnapshotStream
+{
+private:
+    std::vector<std::uint32_t> m_words;  // Cleared rather than freed, so steady-state use does not allocate
+    const std::uint8_t* m_read_data = nullptr;
+    std::size_t m_read_size = 0;
+    std::uint64_t m_scratch = 0;         // Bits on their way to or from the buffer
+    int m_scratch_bits = 0;
+    std::size_t m_bit_position = 0;
+
+    bool m_is_reading = false;
+    bool m_has_error = false;  // Set on reading past the end or an out-of-range value; later reads return 0
+    SnapshotPrecision m_precision = SNAPSHOT_LOSSLESS;
+
+    const SnapshotFields* m_baseline = nullptr;
+    SnapshotFields m_fields;
+
+    void write_bits(std::uint32_t value, int bits);
+    std::uint32_t read_bits(int bits);
+
+public:
+    // The baseline, when given, must stay alive and unchanged until the stream is done with it
+    void begin_write(SnapshotPrecision precision, const SnapshotFields* baseline = nullptr);
+    void begin_read(const std::uint8_t* data, std::size_t size, SnapshotPrecision precision, const SnapshotFields* baseline = nullptr);
+
+    // ————— FIELDS ————— //
+    void serialize_bits(std::uint32_t& value, int bits);
+    void serialize_bool(bool& value);
+    void serialize_int(int& value, int min, int max);
+    // Lossless streams ignore the range and store all 32 bits
+    void serialize_float(float& value, float min, float max, int bits);
+
+    // Marks a read as failed, for checks only the game can make (such as an entity count)
+    void set_error() { m_has_error = true; }
+
+    bool is_reading() const { return m_is_reading; }
+    bool has_error() const { return m_has_error; }
+
+    // ————— RESULT ————— //
+    const std::uint8_t* get_data() const { return (const std::uint8_t*)m_words.data(); }
+    std::size_t get_size() const { return (m_bit_position + 7) / 8; }
+
+    // Unpacked fields of the snapshot just written or read; copy them to use as the next baseline
+    const SnapshotFields& get_fields() const { return m_fields; }
+};
+
+// ––––– FILES ––––– //
+// "SNAP", a version byte, then the packed bytes of a lossless snapshot written without a baseline.
+// The bytes are 32-bit words in native order, so files move between little-endian machines only.
+bool save_snapshot_file(const char* filepath, const SnapshotStream& stream);
+bool load_snapshot_file(const char* filepath, std::vector<std::uint8_t>& bytes);
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,153 @@
+#include "stb_image.h"
+#include "GlCapture.h"
+#include "TextureResidency.h"
+
+TextureResidency g_texture_residency;
+
+static std::size_t texture_bytes(int width, int height)
+{
+    return (std::size_t)width * height * 4;
+}
+
+// The residency's own binds are not the game's, so they skip counted_bind_texture
+static void bind_texture(GLuint id)
+{
+    if (g_gl_capture.is_recording()) g_gl_capture.record_bind_texture(GL_TEXTURE_2D, id);
+    glBindTexture(GL_TEXTURE_2D, id);
+}
+
+GLuint TextureResidency::load(const char* filepath)
+{
+    for (const Texture& texture : m_textures)
+    {
+        if (texture.filepath == filepath) return texture.id;
+    }
+
+    Texture texture;
+    texture.filepath = filepath;
+    return add(texture);
+}
+
+GLuint TextureResidency::create(int width, int height, const unsigned char* pixels)
+{
+    Texture texture;
+    texture.width = width;
+    texture.height = height;
+    texture.pixels.assign(pixels, pixels + texture_bytes(width, height));
+    return add(texture);
+}
+
+GLuint TextureResidency::add(Texture texture)
+{
+    traced_gen_texture(&texture.id);
+    texture.last_used_frame = m_frame;
+
+    if (!upload(texture))
+    {
+        glDeleteTextures(1, &texture.id);
+        return 0;
+    }
+
+    traced_tex_parameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    traced_tex_parameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+    traced_tex_parameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    traced_tex_parameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+    m_textures.push_back(std::move(texture));
+    enforce_budget();
+    return m_textures.back().id;
+}
+
+bool TextureResidency::upload(Texture& texture)
+{
+    const unsigned char* pixels = texture.pixels.data();
+    unsigned char* image = nullptr;
+
+    if (texture.pixels.empty())
+    {
+        int number_of_components;
+        image = stbi_load(texture.filepath.c_str(), &texture.width, &texture.height, &number_of_components, STBI_rgb_alpha);
+        if (image == nullptr) return false;
+        pixels = image;
+    }
+
+    bind_texture(texture.id);
+    traced_tex_image_2d(GL_TEXTURE_2D, 0, GL_RGBA, texture.width, texture.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    if (image != nullptr) stbi_image_free(image);
+
+    texture.is_resident = true;
+    m_resident_bytes += texture_bytes(texture.width, texture.height);
+    return true;
+}
+
+void TextureResidency::evict(Texture& texture)
+{
+    bind_texture(texture.id);
+    traced_tex_image_2d(GL_TEXTURE_2D, 0, GL_RGBA, 0, 0, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+
+    texture.is_resident = false;
+    m_resident_bytes -= texture_bytes(texture.width, texture.height);
+    m_evictions++;
+}
+
+void TextureResidency::enforce_budget()
+{
+    while (m_budget_bytes != 0 && m_resident_bytes > m_budget_bytes)
+    {
+        Texture* oldest = nullptr;
+        for (Texture& texture : m_textures)
+        {
+            if (!texture.is_resident || texture.last_used_frame >= m_frame) continue;
+            if (oldest == nullptr || texture.last_used_frame < oldest->last_used_frame) oldest = &texture;
+        }
+
+        // Everything left is in use this frame
+        if (oldest == nullptr) return;
+        evict(*oldest);
+    }
+}
+
+void TextureResidency::touch_managed(GLuint id)
+{
+    for (Texture& texture : m_textures)
+    {
+        if (texture.id != id) continue;
+
+        texture.last_used_frame = m_frame;
+        if (!texture.is_resident && upload(texture))
+        {
+            m_reloads++;
+            enforce_budget();
+        }
+        return;
+    }
+}
+
+void TextureResidency::end_frame()
+{
+    enforce_budget();
+    m_frame++;
+}
+
+void TextureResidency::shutdown()
+{
+    for (Texture& texture : m_textures) glDeleteTextures(1, &texture.id);
+    m_textures.clear();
+    m_resident_bytes = 0;
+}
+
+TextureResidencyStats TextureResidency::get_stats() const
+{
+    TextureResidencyStats stats;
+    for (const Texture& texture : m_textures)
+    {
+        if (texture.is_resident) stats.resident_textures++;
+        else stats.evicted_textures++;
+    }
+    stats.resident_bytes = m_resident_bytes;
+    stats.budget_bytes = m_budget_bytes;
+    stats.evictions = m_evictions;
+    stats.reloads = m_reloads;
+    return stats;
+}
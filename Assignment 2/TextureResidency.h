@@ -0,0 +1,83 @@
+#ifndef TEXTURE_RESIDENCY_H
+#define TEXTURE_RESIDENCY_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "ShaderProgram.h"
+
+// ––––– TEXTURE RESIDENCY ––––– //
+// Owns the game's textures and keeps the memory they take on the GPU under a byte budget. Every
+// bind goes through counted_bind_texture (PerfHud.h), which marks the texture used this frame.
+// Whenever the textures resident take more than the budget, the least recently used lose their
+// storage: their image is replaced with an empty one, which frees it but keeps the texture's name
+// and parameters, so whatever holds the id never notices. The next bind uploads the image again,
+// decoding the file anew or, for textures made in code, from the copy kept in memory.
+//
+// Textures used in the current frame are never evicted, so a budget smaller than one frame's
+// textures is exceeded rather than reloaded every frame. With no budget nothing is evicted and
+// each bind costs one branch. A game has a handful of textures, so lookups are a linear scan.
+
+struct TextureResidencyStats
+{
+    int resident_textures = 0;
+    int evicted_textures = 0;  // Out of memory now, reloaded on their next bind
+    std::size_t resident_bytes = 0;
+    std::size_t budget_bytes = 0;  // 0 for none
+    std::uint64_t evictions = 0;
+    std::uint64_t reloads = 0;
+};
+
+class TextureResidency
+{
+private:
+    struct Texture
+    {
+        GLuint id = 0;
+        int width = 0, height = 0;
+        std::string filepath;               // Reloaded from this file...
+        std::vector<unsigned char> pixels;  // ...or, for textures made in code, these RGBA pixels
+        std::uint64_t last_used_frame = 0;
+        bool is_resident = false;
+    };
+
+    std::vector<Texture> m_textures;
+    std::size_t m_budget_bytes = 0;
+    std::size_t m_resident_bytes = 0;
+    std::uint64_t m_frame = 0;
+    std::uint64_t m_evictions = 0;
+    std::uint64_t m_reloads = 0;
+
+    GLuint add(Texture texture);
+    bool upload(Texture& texture);
+    void evict(Texture& texture);
+    void enforce_budget();
+    void touch_managed(GLuint id);
+
+public:
+    // 0 for no budget
+    void set_budget(std::size_t bytes) { m_budget_bytes = bytes; }
+
+    // Needs a current GL context. Returns 0 if the file cannot be read; a file already loaded
+    // gives back the same texture.
+    GLuint load(const char* filepath);
+
+    // A texture from RGBA pixels made in code; they are copied, to reload from
+    GLuint create(int width, int height, const unsigned char* pixels);
+
+    // Called by counted_bind_texture before each bind; uploads the texture again if it was evicted
+    void touch(GLuint id) { if (m_budget_bytes != 0) touch_managed(id); }
+
+    // Evicts what the budget needs from the textures the frame did not use
+    void end_frame();
+
+    // Deletes every texture; needs the GL context still current
+    void shutdown();
+
+    TextureResidencyStats get_stats() const;
+};
+
+extern TextureResidency g_texture_residency;
+
+#endif // TEXTURE_RESIDENCY_H
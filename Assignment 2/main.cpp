@@ -22,12 +22,33 @@
 #include <SDL_opengl.h>
 #include "glm/mat4x4.hpp"
 #include "glm/gtc/matrix_transform.hpp"
-#include "ShaderProgram.h"
+#include "CachedShaderProgram.h"
 #include "stb_image.h"
 #include <vector>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include "AllocTracker.h"
+#include "DynamicResolution.h"
 #include "Entity.h"
+#include "Benchmark.h"
+#include "InputLog.h"
+#include "PerfHud.h"
+#include "Profiler.h"
+#include "CollisionMask.h"
+#include "FrameArena.h"
+#include "PongMatch.h"
+#include "MatchServer.h"
+#include "Rollback.h"
+#include "Snapshot.h"
 
 // ––––– STRUCTS AND ENUMS ––––– //
+// Sprites the match is drawn with, moved to it by sync_scene() each frame
 struct GameState
 {
     std::vector<Entity*> balls; // Multiple balls
@@ -57,46 +78,111 @@ constexpr float MILLISECONDS_IN_SECOND = 1000.0f;
 constexpr char PADDLE_FILEPATH[] = "Pong_Sweet_White_Tail.png";
 constexpr char BALL_FILEPATH[] = "Pong_Candy.png";
 
-constexpr int NUMBER_OF_TEXTURES = 1;
-constexpr GLint LEVEL_OF_DETAIL = 0;
-constexpr GLint TEXTURE_BORDER = 0;
-
 
 constexpr int FONTBANK_SIZE_U = 16;
 constexpr int FONTBANK_SIZE_V = 7;
 
+constexpr double NET_LATENCY_MS = 60.0;  // Loopback defaults, one way
+constexpr float NET_LOSS_PERCENT = 0.0f;
+constexpr int ROLLBACK_TEST_TICKS = 3600;
+
 // ––––– GLOBAL VARIABLES ––––– //
 GameState g_game_state;
-int g_desired_ball_count = 1;  // Starting with one ball
+PongMatch g_match;  // The simulation itself; everything else only draws or drives it
+
+// Pixel masks for the paddle and candy sprites, refined after the box test
+CollisionMask g_paddle_mask;
+CollisionMask g_ball_mask;
 
 
 SDL_Window* g_display_window;
 AppStatus g_app_status = TERMINATED;
 
-ShaderProgram g_shader_program;
+CachedShaderProgram g_shader_program;
 glm::mat4 g_view_matrix, g_projection_matrix;
 
 float g_previous_ticks = 0.0f;
 float g_accumulator = 0.0f;
 
-bool g_game_over = false;
-std::string g_endgame_message = "";
+// Input recording and replay
+InputLog g_input_log;
+const char* g_record_filepath = nullptr;
+
+// F3 toggles the frame time and GL call overlay
+PerfHud g_perf_hud;
+const glm::vec3 HUD_ORIGIN(-4.8f, 3.55f, 0.0f);
+constexpr float HUD_FONT_SIZE = 0.2f,
+HUD_GRAPH_CELL_SIZE = 0.08f;
+constexpr int HUD_GRAPH_COLUMNS = 60,
+HUD_GRAPH_ROWS = 8;
+
+// Chrome trace of the profiler zones, written on F9 and at exit when built with ENABLE_PROFILER
+const char* g_profile_filepath = "profile.json";
+
+constexpr int GL_CAPTURE_FRAMES = 300;
+const char* g_gl_capture_filepath = nullptr;
+
+// --dynamic-resolution draws the scene at a lower resolution while frames run over budget
+DynamicResolution g_dynamic_resolution;
+ResolutionSettings g_resolution_settings;
+bool g_use_dynamic_resolution = false;
+float g_swap_milliseconds = 0.0f;  // Spent in the last SDL_GL_SwapWindow, mostly waiting for the display
+
+// --fixed-point runs the match in Q16.16 integers, the same on every build and machine
+bool g_use_fixed_point = false;
+
+// Networked play, set up by --net-host, --net-join or --net-loopback
+struct NetPeer
+{
+    RollbackSession session;
+    LoopbackTransport transport;
+    GameSnapshot state;  // A peer simulated in this process keeps its state here between ticks
+};
+
+RollbackSession* g_rollback_session = nullptr;
+NetTransport* g_net_transport = nullptr;
+LoopbackLink* g_loopback_link = nullptr;
+NetPeer* g_loopback_bot = nullptr;      // The opponent on the far end of --net-loopback
+Uint16 g_net_held_buttons = 0;          // Sampled by process_input() for the next tick
+Uint16 g_net_pressed_buttons = 0;       // Pressed since the last tick ran
+
+// F5 keeps a snapshot of the game (in g_state_filepath too, when given) and F8 goes back to it.
+// One is taken as the game starts, so F8 before any F5 restarts the game.
+constexpr float SNAPSHOT_POSITION_RANGE = 128.0f,  // Quantized snapshots cover +/- these
+SNAPSHOT_VELOCITY_RANGE = 8.0f;
+constexpr int SNAPSHOT_POSITION_BITS = 20,
+SNAPSHOT_VELOCITY_BITS = 12;
+SnapshotStream g_snapshot_stream;
+std::vector<std::uint8_t> g_quick_save;
+const char* g_state_filepath = nullptr;
 
 
 // Texture ID for the font
 GLuint FONT_TEXTURE_ID;
 
 void initialise();
+void initialise_scene(GLuint paddle_texture_id, GLuint ball_texture_id);
 void process_input();
 void update();
+void update_tick();
+void sync_scene();
+void update_netplay_tick();
+void log_rollback_stats(const char* label, const RollbackStats& stats);
 void render();
+void render_perf_hud();
 void shutdown();
 GLuint load_texture(const char* filepath);
+void load_collision_mask(const char* filepath, float world_width, float world_height, CollisionMask& mask);
+void build_stress_balls(PongMatch& match, int count);
+void start_snapshots();
+void quick_save();
+void quick_load();
 
 // Function to draw text
 
-void draw_text(ShaderProgram* shader_program, GLuint font_texture_id, std::string text,
-    float font_size, float spacing, glm::vec3 position)
+// Quads and UVs for a line of text in the font sheet, one character after another
+void build_text_mesh(const char* text, float font_size, float spacing,
+    FrameVector<float>& vertices, FrameVector<float>& texture_coordinates)
 {
     // Scale the size of the fontbank in the UV-plane
     // We will use this for spacing and positioning
@@ -104,12 +190,15 @@ void draw_text(ShaderProgram* shader_program, GLuint font_texture_id, std::strin
     float height = 1.0f / FONTBANK_SIZE_V;
 
     // Instead of having a single pair of arrays, we'll have a series of pairs—one for
-    // each character. Don't forget to include <vector>!
-    std::vector<float> vertices;
-    std::vector<float> texture_coordinates;
+    // each character.
+    int length = (int)std::strlen(text);
+    vertices.clear();
+    texture_coordinates.clear();
+    vertices.reserve(length * 12);
+    texture_coordinates.reserve(length * 12);
 
     // For every character...
-    for (int i = 0; i < text.size(); i++) {
+    for (int i = 0; i < length; i++) {
         // 1. Get their index in the spritesheet, as well as their offset (i.e. their
         //    position relative to the whole sentence)
         // int spritesheet_index = (int)text[i];  // ascii value of character
@@ -142,58 +231,68 @@ void draw_text(ShaderProgram* shader_program, GLuint font_texture_id, std::strin
             u_coordinate, v_coordinate + height,
             });
     }
+}
+
+void draw_text(CachedShaderProgram* shader_program, GLuint font_texture_id, const char* text,
+    float font_size, float spacing, glm::vec3 position)
+{
+    PROFILE_SCOPE("draw_text");
+    FrameVector<float> vertices;
+    FrameVector<float> texture_coordinates;
+    build_text_mesh(text, font_size, spacing, vertices, texture_coordinates);
 
     // 4. And render all of them using the pairs
     glm::mat4 model_matrix = glm::mat4(1.0f);
     model_matrix = glm::translate(model_matrix, position);
 
-    shader_program->set_model_matrix(model_matrix);
-    glUseProgram(shader_program->get_program_id());
+    counted_set_model_matrix(shader_program, model_matrix);
+    counted_use_program(shader_program->get_program_id());
 
-    glVertexAttribPointer(shader_program->get_position_attribute(), 2, GL_FLOAT, false, 0,
+    traced_vertex_attrib_pointer(shader_program->get_position_attribute(), 2, GL_FLOAT, false, 0,
         vertices.data());
-    glEnableVertexAttribArray(shader_program->get_position_attribute());
+    traced_enable_vertex_attrib_array(shader_program->get_position_attribute());
 
-    glVertexAttribPointer(shader_program->get_tex_coordinate_attribute(), 2, GL_FLOAT,
+    traced_vertex_attrib_pointer(shader_program->get_tex_coordinate_attribute(), 2, GL_FLOAT,
         false, 0, texture_coordinates.data());
-    glEnableVertexAttribArray(shader_program->get_tex_coordinate_attribute());
+    traced_enable_vertex_attrib_array(shader_program->get_tex_coordinate_attribute());
 
-    glBindTexture(GL_TEXTURE_2D, font_texture_id);
-    glDrawArrays(GL_TRIANGLES, 0, (int)(text.size() * 6));
+    counted_bind_texture(GL_TEXTURE_2D, font_texture_id);
+    counted_draw_arrays(GL_TRIANGLES, 0, (int)(vertices.size() / 2));
 
-    glDisableVertexAttribArray(shader_program->get_position_attribute());
-    glDisableVertexAttribArray(shader_program->get_tex_coordinate_attribute());
+    traced_disable_vertex_attrib_array(shader_program->get_position_attribute());
+    traced_disable_vertex_attrib_array(shader_program->get_tex_coordinate_attribute());
 }
 
 
 GLuint load_texture(const char* filepath)
 {
-    int width, height, number_of_components;
-    unsigned char* image = stbi_load(filepath, &width, &height, &number_of_components,
-        STBI_rgb_alpha);
+    PROFILE_SCOPE("load_texture");
+    GLuint textureID = g_texture_residency.load(filepath);
 
-    if (image == NULL)
+    if (textureID == 0)
     {
         LOG("Unable to load image. Make sure the path is correct.");
         assert(false);
     }
 
-    GLuint textureID;
-    glGenTextures(NUMBER_OF_TEXTURES, &textureID);
-
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, LEVEL_OF_DETAIL, GL_RGBA, width, height, TEXTURE_BORDER,
-        GL_RGBA, GL_UNSIGNED_BYTE, image);
+    return textureID;
+}
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+// Builds a mask from the image's alpha channel; no GL needed, so replays get the same masks
+void load_collision_mask(const char* filepath, float world_width, float world_height, CollisionMask& mask)
+{
+    int width, height, number_of_components;
+    unsigned char* image = stbi_load(filepath, &width, &height, &number_of_components,
+        STBI_rgb_alpha);
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    if (image == NULL)
+    {
+        LOG("Unable to load collision mask. Make sure the path is correct.");
+        return;
+    }
 
+    mask.build(image, width, height, 0, 0, width, height, world_width, world_height);
     stbi_image_free(image);
-
-    return textureID;
 }
 
 void add_ball() {
@@ -206,6 +305,7 @@ void add_ball() {
 
 void initialise()
 {
+    PROFILE_SCOPE("initialise");
     SDL_Init(SDL_INIT_VIDEO);
     g_display_window = SDL_CreateWindow("Pong Game",
         SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
@@ -227,56 +327,59 @@ void initialise()
 
     g_app_status = RUNNING;
 
-    glViewport(VIEWPORT_X, VIEWPORT_Y, VIEWPORT_WIDTH, WINDOW_HEIGHT);
+    traced_viewport(VIEWPORT_X, VIEWPORT_Y, VIEWPORT_WIDTH, WINDOW_HEIGHT);
 
-    g_shader_program.load(V_SHADER_PATH, F_SHADER_PATH);
+    traced_load_program(&g_shader_program, V_SHADER_PATH, F_SHADER_PATH);
 
     g_view_matrix = glm::mat4(1.0f);
     g_projection_matrix = glm::ortho(-5.0f, 5.0f, -3.75f, 3.75f, -1.0f, 1.0f);
 
-    g_shader_program.set_projection_matrix(g_projection_matrix);
-    g_shader_program.set_view_matrix(g_view_matrix);
+    traced_set_projection_matrix(&g_shader_program, g_projection_matrix);
+    traced_set_view_matrix(&g_shader_program, g_view_matrix);
 
-    glUseProgram(g_shader_program.get_program_id());
+    counted_use_program(g_shader_program.get_program_id());
 
-    glClearColor(BG_RED, BG_BLUE, BG_GREEN, BG_OPACITY);
+    traced_clear_color(BG_RED, BG_BLUE, BG_GREEN, BG_OPACITY);
 
     // Loading textures
     GLuint paddle_texture_id = load_texture(PADDLE_FILEPATH);
     GLuint ball_texture_id = load_texture(BALL_FILEPATH);
     FONT_TEXTURE_ID = load_texture("MisterF_Fonts_Sprite_Sheet.png");  // Loading font texture
 
-    // Initializing paddles
-    g_game_state.paddle1 = new Entity(paddle_texture_id, 2.0f, 0.5f, 1.5f, PADDLE);
-    g_game_state.paddle2 = new Entity(paddle_texture_id, 2.0f, 0.5f, 1.5f, PADDLE);
-    g_game_state.paddle1->set_position(glm::vec3(-4.5f, 0.0f, 0.0f));
-    g_game_state.paddle2->set_position(glm::vec3(4.5f, 0.0f, 0.0f));
+    initialise_scene(paddle_texture_id, ball_texture_id);
 
-    // Pre-creating three balls but only activating the first one initially
-    for (int i = 0; i < 3; i++) {
-        Entity* ball = new Entity(ball_texture_id, 2.0f, 0.5f, 0.5f, BALL);
-        ball->set_position(glm::vec3(0.0f, 0.0f, 0.0f)); // Center the ball at the start
-        ball->set_velocity(glm::vec3((i % 2 == 0 ? 1.0f : -1.0f), 0.5f, 0.0f)); // Velocity
-        ball->set_active(i == 0); // Only the first ball is active initially
-        g_game_state.balls.push_back(ball);
-    }
+    traced_enable(GL_BLEND);
+    traced_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-    // Setting the desired ball count to 1 initially
-    g_desired_ball_count = 1;
+    g_perf_hud.initialise();
+    if (g_use_dynamic_resolution) g_dynamic_resolution.initialise(VIEWPORT_WIDTH, WINDOW_HEIGHT, g_resolution_settings);
+}
 
-    // Ensuring only the first ball is active
-    for (size_t i = g_desired_ball_count; i < g_game_state.balls.size(); ++i) {
-        g_game_state.balls[i]->set_position(glm::vec3(-100.0f, -100.0f, 0.0f));
-        g_game_state.balls[i]->set_velocity(glm::vec3(0.0f, 0.0f, 0.0f));
-    }
+// Everything the simulation needs, with no window or GL calls, so replays can run headless
+void initialise_scene(GLuint paddle_texture_id, GLuint ball_texture_id)
+{
+    load_collision_mask(PADDLE_FILEPATH, 0.5f, 1.5f, g_paddle_mask);
+    load_collision_mask(BALL_FILEPATH, 0.5f, 0.5f, g_ball_mask);
+
+    g_match.reset();
+    g_match.set_masks(&g_paddle_mask, &g_ball_mask);
+    g_match.set_fixed_point(g_use_fixed_point);
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    // Initializing the sprites; the match has three balls to start with
+    g_game_state.paddle1 = new Entity(paddle_texture_id, 2.0f, 0.5f, 1.5f, PADDLE);
+    g_game_state.paddle2 = new Entity(paddle_texture_id, 2.0f, 0.5f, 1.5f, PADDLE);
+    for (int i = 0; i < 3; i++) {
+        g_game_state.balls.push_back(new Entity(ball_texture_id, 2.0f, 0.5f, 0.5f, BALL));
+    }
+    sync_scene();
 }
 
 
 void process_input()
 {
+    PROFILE_SCOPE("process_input");
+    Uint16 buttons = 0;
+
     SDL_Event event;
     while (SDL_PollEvent(&event))
     {
@@ -292,24 +395,28 @@ void process_input()
                 g_app_status = TERMINATED;
                 break;
             case SDLK_t:
-                if (!g_game_over) {
-                    g_game_state.paddle2->toggle_ai_control();
-                }
+                buttons |= INPUT_TOGGLE_AI;
                 break;
             case SDLK_1:
-                if (!g_game_over) {
-                    g_desired_ball_count = 1;  // Set desired ball count
-                }
+                buttons |= INPUT_ONE_BALL;
                 break;
             case SDLK_2:
-                if (!g_game_over) {
-                    g_desired_ball_count = 2;
-                }
+                buttons |= INPUT_TWO_BALLS;
                 break;
             case SDLK_3:
-                if (!g_game_over) {
-                    g_desired_ball_count = 3;
-                }
+                buttons |= INPUT_THREE_BALLS;
+                break;
+            case SDLK_F3:
+                g_perf_hud.toggle();
+                break;
+            case SDLK_F9:
+                if (PROFILE_WRITE_TRACE(g_profile_filepath)) LOG("Wrote profile to " << g_profile_filepath);
+                break;
+            case SDLK_F5:
+                quick_save();
+                break;
+            case SDLK_F8:
+                quick_load();
                 break;
             default:
                 break;
@@ -319,48 +426,27 @@ void process_input()
 
     const Uint8* key_state = SDL_GetKeyboardState(NULL);
 
-    if (!g_game_over) {
-        if (key_state[SDL_SCANCODE_W]) g_game_state.paddle1->move_up();
-        if (key_state[SDL_SCANCODE_S]) g_game_state.paddle1->move_down();
-        if (!g_game_state.paddle2->is_ai_controlled())
-        {
-            if (key_state[SDL_SCANCODE_UP]) g_game_state.paddle2->move_up();
-            if (key_state[SDL_SCANCODE_DOWN]) g_game_state.paddle2->move_down();
-        }
-    }
-}
+    if (key_state[SDL_SCANCODE_W]) buttons |= INPUT_W;
+    if (key_state[SDL_SCANCODE_S]) buttons |= INPUT_S;
+    if (key_state[SDL_SCANCODE_UP]) buttons |= INPUT_UP;
+    if (key_state[SDL_SCANCODE_DOWN]) buttons |= INPUT_DOWN;
 
-void check_ball_collision() {
-    for (Entity* ball : g_game_state.balls) {
-        if (!ball->is_active()) continue; // Skip inactive balls
-
-        // Checking for collision with paddles
-        if (ball->check_collision(g_game_state.paddle1) || ball->check_collision(g_game_state.paddle2)) {
-            ball->set_velocity(glm::vec3(-ball->get_velocity().x, ball->get_velocity().y, 0.0f));
-        }
+    if (g_rollback_session != nullptr)
+    {
+        // Networked ticks take their input from the rollback session instead
+        g_net_held_buttons = buttons & HELD_BUTTONS;
+        g_net_pressed_buttons |= buttons & ~HELD_BUTTONS;
+        return;
+    }
 
-        // Checking for collision with the top and bottom of the screen
-        if (ball->get_position().y + (ball->get_height() / 2) > 3.75f ||
-            ball->get_position().y - (ball->get_height() / 2) < -3.75f) {
-            ball->set_velocity(glm::vec3(ball->get_velocity().x, -ball->get_velocity().y, 0.0f));
-        }
+    if (g_record_filepath != nullptr) g_input_log.record(g_match.get_tick(), buttons);
 
-        // Checking for collision with the left and right of the screen (endgame condition)
-        if (ball->get_position().x < -5.0f) {
-            g_game_over = true;
-            g_endgame_message = "Player 2 Wins!";
-            return;  // Exit function early if game is over
-        }
-        else if (ball->get_position().x > 5.0f) {
-            g_game_over = true;
-            g_endgame_message = "Player 1 Wins!";
-            return;  // Exit function early if game is over
-        }
-    }
+    g_match.apply_input(buttons);
 }
 
 void update()
 {
+    PROFILE_SCOPE("update");
     float ticks = (float)SDL_GetTicks() / MILLISECONDS_IN_SECOND;
     float delta_time = ticks - g_previous_ticks;
     g_previous_ticks = ticks;
@@ -375,56 +461,168 @@ void update()
 
     while (delta_time >= FIXED_TIMESTEP)
     {
-        // Enable or disable balls based on the desired count
-        for (int i = 0; i < 3; ++i) {
-            if (i < g_desired_ball_count) {
-                // Reseting the ball's position and velocity before activating it
-                if (!g_game_state.balls[i]->is_active()) {
-                    g_game_state.balls[i]->set_position(glm::vec3(0.0f, i + -2.0f, 0.0f)); // Center the ball
-                    g_game_state.balls[i]->set_velocity(glm::vec3((i % 2 == 0 ? 1.0f : -1.0f), 0.5f, 0.0f)); // Give it an initial velocity
-                    g_game_state.balls[i]->set_active(true); // Activate the ball
-                }
-                g_game_state.balls[i]->update(FIXED_TIMESTEP, NULL, 0); // Update active balls
-            }
-            else {
-                g_game_state.balls[i]->set_active(false); // Deactivate the ball
-            }
-        }
+        if (g_rollback_session != nullptr) update_netplay_tick();
+        else update_tick();
+        delta_time -= FIXED_TIMESTEP;
+    }
 
-        g_game_state.paddle1->update(FIXED_TIMESTEP, NULL, 0);
-        g_game_state.paddle2->update(FIXED_TIMESTEP, NULL, 0);
+    g_accumulator = delta_time;
+}
 
-        check_ball_collision();
+void update_tick()
+{
+    PROFILE_SCOPE("update_tick");
+    g_match.step();
+}
 
-        delta_time -= FIXED_TIMESTEP;
+// Moves the sprites to the match's paddles and balls, adding ball sprites when a stress
+// scene has more balls than there are sprites
+void sync_scene()
+{
+    Entity* paddles[] = { g_game_state.paddle1, g_game_state.paddle2 };
+    for (int i = 0; i < 2; i++) {
+        paddles[i]->set_position(g_match.get_paddle(i).position);
+        paddles[i]->update_model_matrix();
     }
 
-    g_accumulator = delta_time;
+    const std::vector<PongBall>& balls = g_match.get_balls();
+    while (g_game_state.balls.size() < balls.size()) {
+        g_game_state.balls.push_back(new Entity(g_game_state.balls[0]->get_texture_id(), 2.0f, 0.5f, 0.5f, BALL));
+    }
+    for (size_t i = 0; i < balls.size(); i++) {
+        g_game_state.balls[i]->set_position(balls[i].position);
+        g_game_state.balls[i]->set_active(balls[i].is_active);
+        g_game_state.balls[i]->update_model_matrix();
+    }
 }
 
 
 void render()
 {
-    glClear(GL_COLOR_BUFFER_BIT);
+    PROFILE_SCOPE("render");
+    g_perf_hud.begin_frame();
+
+    // Last frame's render time: the GPU's when the driver reports it, otherwise the whole frame
+    // less the time the swap spent waiting for the display
+    float work_milliseconds = g_perf_hud.get_gpu_milliseconds();
+    if (work_milliseconds < 0.0f) work_milliseconds = g_perf_hud.get_last_frame_milliseconds() - g_swap_milliseconds;
+    g_dynamic_resolution.add_frame(work_milliseconds);
+
+    g_dynamic_resolution.begin();
+    traced_clear(GL_COLOR_BUFFER_BIT);
+    sync_scene();
 
-    for (int i = 0; i < g_desired_ball_count; ++i) {
+    for (int i = 0; i < g_match.get_desired_ball_count(); ++i) {
         g_game_state.balls[i]->render(&g_shader_program);
     }
     g_game_state.paddle1->render(&g_shader_program);
     g_game_state.paddle2->render(&g_shader_program);
 
-    if (g_game_over) {
-        draw_text(&g_shader_program, FONT_TEXTURE_ID, g_endgame_message, 0.5f, -0.25f, glm::vec3(-2.0f, 0.0f, 0.0f));
+    if (g_match.is_game_over()) {
+        const char* endgame_message = g_match.get_winner() == 1 ? "Player 1 Wins!" : "Player 2 Wins!";
+        draw_text(&g_shader_program, FONT_TEXTURE_ID, endgame_message, 0.5f, -0.25f, glm::vec3(-2.0f, 0.0f, 0.0f));
     }
 
-    SDL_GL_SwapWindow(g_display_window);
+    g_dynamic_resolution.end(&g_shader_program, g_projection_matrix, g_view_matrix);
+
+    // The overlay is drawn after the counters are read, so it does not count itself, and at
+    // full resolution
+    g_perf_hud.end_frame();
+    if (g_perf_hud.is_visible()) render_perf_hud();
+    g_texture_residency.end_frame();
+
+    {
+        PROFILE_SCOPE("SDL_GL_SwapWindow");
+        if (g_gl_capture.end_frame()) LOG("Wrote GL trace to " << g_gl_capture_filepath);
+        Uint64 swap_start = SDL_GetPerformanceCounter();
+        SDL_GL_SwapWindow(g_display_window);
+        g_swap_milliseconds = (float)((SDL_GetPerformanceCounter() - swap_start) * 1000.0 / SDL_GetPerformanceFrequency());
+    }
 }
 
 
+void render_perf_hud()
+{
+    ALLOC_EXEMPT_SCOPE();  // A debugging aid, so it is left out of the steady-state check
+    glm::vec3 position = HUD_ORIGIN;
+
+    for (const std::string& line : g_perf_hud.get_text_lines()) {
+        draw_text(&g_shader_program, FONT_TEXTURE_ID, line.c_str(), HUD_FONT_SIZE, 0.0f, position);
+        position.y -= HUD_FONT_SIZE;
+    }
+
+    TextureResidencyStats textures = g_texture_residency.get_stats();
+    char texture_text[96];
+    if (textures.budget_bytes == 0)
+    {
+        std::snprintf(texture_text, sizeof(texture_text), "TEX %d RESIDENT %dKB",
+            textures.resident_textures, (int)(textures.resident_bytes / 1024));
+    }
+    else
+    {
+        std::snprintf(texture_text, sizeof(texture_text), "TEX %d RESIDENT %dKB OF %dKB %d EVICTED %llu RELOADS",
+            textures.resident_textures, (int)(textures.resident_bytes / 1024), (int)(textures.budget_bytes / 1024),
+            textures.evicted_textures, (unsigned long long)textures.reloads);
+    }
+    draw_text(&g_shader_program, FONT_TEXTURE_ID, texture_text, HUD_FONT_SIZE, 0.0f, position);
+    position.y -= HUD_FONT_SIZE;
+
+    if (g_dynamic_resolution.is_enabled())
+    {
+        const ResolutionTelemetry& resolution = g_dynamic_resolution.get_controller().get_telemetry();
+        char resolution_text[64];
+        std::snprintf(resolution_text, sizeof(resolution_text), "RES %d%% %dX%d %.1f MS",
+            (int)std::lround(resolution.scale * 100.0f), g_dynamic_resolution.get_width(), g_dynamic_resolution.get_height(),
+            resolution.smoothed_milliseconds);
+        draw_text(&g_shader_program, FONT_TEXTURE_ID, resolution_text, HUD_FONT_SIZE, 0.0f, position);
+        position.y -= HUD_FONT_SIZE;
+    }
+
+    for (const std::string& row : g_perf_hud.get_graph_rows(HUD_GRAPH_COLUMNS, HUD_GRAPH_ROWS)) {
+        draw_text(&g_shader_program, FONT_TEXTURE_ID, row.c_str(), HUD_GRAPH_CELL_SIZE, 0.0f, position);
+        position.y -= HUD_GRAPH_CELL_SIZE;
+    }
+}
+
 void shutdown()
 {
+    if (g_rollback_session != nullptr)
+    {
+        log_rollback_stats("Rollback", g_rollback_session->get_stats());
+        delete g_rollback_session;
+        delete g_net_transport;
+        delete g_loopback_bot;
+        delete g_loopback_link;
+    }
+
+    g_gl_capture.finish();
+
+    if (g_dynamic_resolution.is_enabled())
+    {
+        const ResolutionController& controller = g_dynamic_resolution.get_controller();
+        const ResolutionTelemetry& telemetry = controller.get_telemetry();
+        if (telemetry.frames > 0)
+        {
+            LOG("Dynamic resolution: average scale " << telemetry.scale_total / telemetry.frames
+                << ", " << telemetry.scale_downs << " down and " << telemetry.scale_ups << " up, "
+                << 100.0 * telemetry.frames_over_budget / telemetry.frames << "% of " << telemetry.frames
+                << " frames over " << controller.get_settings().target_milliseconds << " ms");
+        }
+    }
+
+    g_perf_hud.shutdown();
+    g_texture_residency.shutdown();
     SDL_Quit();
 
+    if (g_record_filepath != nullptr)
+    {
+        g_input_log.set_end_tick(g_match.get_tick());
+        if (!g_input_log.save(g_record_filepath)) LOG("Unable to save input recording to " << g_record_filepath);
+    }
+
+    PROFILE_WRITE_TRACE(g_profile_filepath);
+    ALLOC_WRITE_REPORT(stderr);
+
     delete g_game_state.paddle1;
     delete g_game_state.paddle2;
 
@@ -433,15 +631,810 @@ void shutdown()
     }
 }
 
+// Fingerprint of everything the simulation touches, compared across replays
+std::uint64_t hash_game_state()
+{
+    std::uint32_t tick = g_match.get_tick();
+    bool is_game_over = g_match.is_game_over();
+    std::uint64_t hash = hash_bytes(&tick, sizeof(tick));
+    hash = hash_bytes(&is_game_over, sizeof(is_game_over), hash);
+
+    for (int player = 0; player < 2; player++)
+    {
+        glm::vec3 position = g_match.get_paddle(player).position;
+        hash = hash_bytes(&position, sizeof(position), hash);
+    }
+
+    for (const PongBall& ball : g_match.get_balls())
+    {
+        hash = hash_bytes(&ball.position, sizeof(ball.position), hash);
+        hash = hash_bytes(&ball.velocity, sizeof(ball.velocity), hash);
+        hash = hash_bytes(&ball.is_active, sizeof(ball.is_active), hash);
+    }
+
+    return hash;
+}
+
+// ––––– SNAPSHOTS ––––– //
+// The GameSnapshot that rollback keeps, bit-packed. Inactive balls wait at (-100, -100), so
+// the position range has to reach them.
+void serialize_game_snapshot(SnapshotStream& stream, GameSnapshot& snapshot)
+{
+    int desired_ball_count = snapshot.desired_ball_count;
+    int winner = snapshot.winner;
+
+    stream.serialize_bits(snapshot.tick, 32);
+    stream.serialize_int(desired_ball_count, 1, GAME_SNAPSHOT_BALLS);
+    stream.serialize_int(winner, 0, 2);
+    stream.serialize_bool(snapshot.is_paddle2_ai_controlled);
+    stream.serialize_bool(snapshot.is_paddle2_ai_moving_up);
+
+    for (float& paddle_y : snapshot.paddle_y)
+    {
+        stream.serialize_float(paddle_y, -SNAPSHOT_POSITION_RANGE, SNAPSHOT_POSITION_RANGE, SNAPSHOT_POSITION_BITS);
+    }
+
+    for (GameSnapshot::Ball& ball : snapshot.balls)
+    {
+        stream.serialize_float(ball.x, -SNAPSHOT_POSITION_RANGE, SNAPSHOT_POSITION_RANGE, SNAPSHOT_POSITION_BITS);
+        stream.serialize_float(ball.y, -SNAPSHOT_POSITION_RANGE, SNAPSHOT_POSITION_RANGE, SNAPSHOT_POSITION_BITS);
+        stream.serialize_float(ball.velocity_x, -SNAPSHOT_VELOCITY_RANGE, SNAPSHOT_VELOCITY_RANGE, SNAPSHOT_VELOCITY_BITS);
+        stream.serialize_float(ball.velocity_y, -SNAPSHOT_VELOCITY_RANGE, SNAPSHOT_VELOCITY_RANGE, SNAPSHOT_VELOCITY_BITS);
+        stream.serialize_bool(ball.is_active);
+    }
+
+    snapshot.desired_ball_count = (std::uint8_t)desired_ball_count;
+    snapshot.winner = (std::uint8_t)winner;
+}
+
+// Reading only touches the live game once the whole snapshot has read back cleanly
+void serialize_game_state(SnapshotStream& stream)
+{
+    PROFILE_SCOPE("serialize_game_state");
+    GameSnapshot snapshot;
+    if (!stream.is_reading()) g_match.save(snapshot);
+
+    serialize_game_snapshot(stream, snapshot);
+
+    if (stream.is_reading() && !stream.has_error()) g_match.load(snapshot);
+}
+
+void capture_state(std::vector<std::uint8_t>& bytes)
+{
+    g_snapshot_stream.begin_write(SNAPSHOT_LOSSLESS);
+    serialize_game_state(g_snapshot_stream);
+    bytes.assign(g_snapshot_stream.get_data(), g_snapshot_stream.get_data() + g_snapshot_stream.get_size());
+}
+
+bool restore_state(const std::vector<std::uint8_t>& bytes)
+{
+    g_snapshot_stream.begin_read(bytes.data(), bytes.size(), SNAPSHOT_LOSSLESS);
+    serialize_game_state(g_snapshot_stream);
+    return !g_snapshot_stream.has_error();
+}
+
+// Resumes from g_state_filepath if it holds a snapshot, then keeps the state for F8
+void start_snapshots()
+{
+    std::vector<std::uint8_t> saved;
+    if (g_state_filepath != nullptr && load_snapshot_file(g_state_filepath, saved))
+    {
+        if (g_record_filepath != nullptr) LOG("Not resuming from " << g_state_filepath << ", recordings start from a new game");
+        else if (g_rollback_session != nullptr) LOG("Not resuming from " << g_state_filepath << ", networked games start together");
+        else if (restore_state(saved)) LOG("Resumed from " << g_state_filepath << " at tick " << g_match.get_tick());
+        else LOG("Unable to read the state in " << g_state_filepath);
+    }
+    capture_state(g_quick_save);
+}
+
+void quick_save()
+{
+    capture_state(g_quick_save);
+    if (g_state_filepath != nullptr && !save_snapshot_file(g_state_filepath, g_snapshot_stream))
+    {
+        LOG("Unable to save state to " << g_state_filepath);
+    }
+}
+
+void quick_load()
+{
+    // A recording has to run forwards from the start to replay, and a networked game
+    // can only go back as far as rollback allows
+    if (g_record_filepath != nullptr || g_rollback_session != nullptr)
+    {
+        LOG("Quick load is off while recording or networked");
+        return;
+    }
+    if (!restore_state(g_quick_save)) return;
+
+    g_previous_ticks = (float)SDL_GetTicks() / MILLISECONDS_IN_SECOND;
+    g_accumulator = 0.0f;
+}
+
+// Size and cost of snapshots over a replay, gathered by --snapshot-check
+struct SnapshotCheck
+{
+    SnapshotStream stream;
+    SnapshotFields baseline, quantized_baseline;
+    std::vector<std::uint8_t> delta;
+
+    std::uint64_t ticks = 0;
+    std::uint64_t full_bytes = 0, delta_bytes = 0;
+    std::uint64_t quantized_bytes = 0, quantized_delta_bytes = 0;
+    double encode_seconds = 0.0, restore_seconds = 0.0;
+};
+
+// Encodes the state in full and as a delta against the last tick, both lossless and quantized,
+// then restores the lossless delta over the live state. Anything the snapshot misses or gets
+// wrong then shows up as a different end state for the replay.
+void check_snapshot_round_trip(SnapshotCheck& check)
+{
+    SnapshotStream& stream = check.stream;
+
+    stream.begin_write(SNAPSHOT_QUANTIZED);
+    serialize_game_state(stream);
+    check.quantized_bytes += stream.get_size();
+
+    stream.begin_write(SNAPSHOT_QUANTIZED, &check.quantized_baseline);
+    serialize_game_state(stream);
+    check.quantized_delta_bytes += stream.get_size();
+    check.quantized_baseline = stream.get_fields();
+
+    stream.begin_write(SNAPSHOT_LOSSLESS);
+    serialize_game_state(stream);
+    check.full_bytes += stream.get_size();
+
+    auto encode_start = std::chrono::steady_clock::now();
+    stream.begin_write(SNAPSHOT_LOSSLESS, &check.baseline);
+    serialize_game_state(stream);
+    check.encode_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - encode_start).count();
+
+    check.delta.assign(stream.get_data(), stream.get_data() + stream.get_size());
+    check.delta_bytes += check.delta.size();
+
+    auto restore_start = std::chrono::steady_clock::now();
+    stream.begin_read(check.delta.data(), check.delta.size(), SNAPSHOT_LOSSLESS, &check.baseline);
+    serialize_game_state(stream);
+    check.restore_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - restore_start).count();
+
+    if (stream.has_error()) LOG("Snapshot failed to read back at tick " << g_match.get_tick());
+    check.baseline = stream.get_fields();
+    check.ticks++;
+}
+
+void log_snapshot_check(const SnapshotCheck& check)
+{
+    if (check.ticks == 0) return;
+
+    double ticks = (double)check.ticks;
+    std::printf("Snapshots per tick: %.1f bytes full, %.1f delta, quantized %.1f full, %.1f delta; "
+        "encode %.2f us, restore %.2f us\n",
+        check.full_bytes / ticks, check.delta_bytes / ticks,
+        check.quantized_bytes / ticks, check.quantized_delta_bytes / ticks,
+        check.encode_seconds / ticks * 1e6, check.restore_seconds / ticks * 1e6);
+}
+
+// Runs a recorded session headless and as fast as possible. Returns non-zero if the
+// end state does not match expected_hash (when one is given). With check_snapshots, every
+// tick's state also goes through a snapshot and back.
+int replay(const char* filepath, const char* expected_hash, bool check_snapshots)
+{
+    if (!g_input_log.load(filepath))
+    {
+        LOG("Unable to load input recording " << filepath);
+        return 1;
+    }
+
+    initialise_scene(0, 0);
+    g_app_status = RUNNING;
+
+    SnapshotCheck check;
+    auto run_tick = [&]() {
+        update_tick();
+        if (check_snapshots) check_snapshot_round_trip(check);
+    };
+
+    while (g_input_log.has_next())
+    {
+        ALLOC_FRAME_BEGIN();
+        g_frame_arena.reset();
+
+        const InputFrame& frame = g_input_log.next();
+        while (g_match.get_tick() < frame.tick) run_tick();
+        g_match.apply_input(frame.buttons);
+
+        ALLOC_FRAME_END();
+    }
+    while (g_match.get_tick() < g_input_log.get_end_tick()) run_tick();
+
+    std::uint64_t hash = hash_game_state();
+    LOG("Replayed " << g_input_log.get_frame_count() << " frames, " << g_match.get_tick() << " ticks, end state " << std::hex << hash << std::dec);
+    log_snapshot_check(check);
+    PROFILE_WRITE_TRACE(g_profile_filepath);
+    ALLOC_WRITE_REPORT(stderr);
+
+    delete g_game_state.paddle1;
+    delete g_game_state.paddle2;
+    for (Entity* ball : g_game_state.balls) delete ball;
+
+    if (expected_hash != nullptr && std::strtoull(expected_hash, nullptr, 16) != hash)
+    {
+        LOG("End state does not match " << expected_hash);
+        return 1;
+    }
+    return 0;
+}
+
+// ––––– NETWORKED PLAY ––––– //
+void run_netplay_tick(RollbackSession& session)
+{
+    g_match.save(session.get_snapshot(g_match.get_tick()));
+
+    Uint16 inputs[2];
+    session.get_inputs(g_match.get_tick(), inputs);
+    g_match.apply_input(combine_player_buttons(inputs));
+    update_tick();
+}
+
+// One fixed step of a networked match on the live game state: takes in whatever the peer
+// has sent, re-simulates from the first tick it predicted wrongly, then runs the next tick
+// unless it is at end_tick or has to wait for the peer. Returns whether that tick ran.
+bool step_netplay(RollbackSession& session, NetTransport& transport, Uint16 local_buttons, Uint32 end_tick)
+{
+    PROFILE_SCOPE("step_netplay");
+    session.receive(transport, g_match.get_tick());
+
+    if (session.needs_rollback())
+    {
+        PROFILE_SCOPE("rollback");
+        auto start = std::chrono::steady_clock::now();
+
+        Uint32 present_tick = g_match.get_tick();
+        g_match.load(session.get_snapshot(session.get_rollback_tick()));
+        while (g_match.get_tick() < present_tick) run_netplay_tick(session);
+
+        session.finish_rollback(present_tick, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    bool has_advanced = g_match.get_tick() < end_tick && session.can_advance(g_match.get_tick());
+    if (has_advanced)
+    {
+        session.add_local_input(g_match.get_tick(), local_buttons);
+        run_netplay_tick(session);
+    }
+
+    session.send(transport);
+    return has_advanced;
+}
+
+// Steps a bot peer whose state lives in its NetPeer, using the live game state to run it
+bool step_bot_peer(NetPeer& peer, int player, Uint32 end_tick, Uint16& buttons)
+{
+    g_match.load(peer.state);
+    buttons = g_match.get_bot_buttons(player);
+
+    bool has_advanced = step_netplay(peer.session, peer.transport, buttons, end_tick);
+    g_match.save(peer.state);
+    return has_advanced;
+}
+
+void update_netplay_tick()
+{
+    Uint16 player_buttons = g_rollback_session->get_local_player() == 0 ? PLAYER1_BUTTONS : PLAYER2_BUTTONS;
+    Uint16 buttons = (g_net_held_buttons | g_net_pressed_buttons) & player_buttons;
+    if (step_netplay(*g_rollback_session, *g_net_transport, buttons, UINT32_MAX)) g_net_pressed_buttons = 0;
+
+    if (g_loopback_bot == nullptr) return;
+
+    // The bot takes its turn on the live entities, which then get the player's state back
+    g_loopback_link->advance(FIXED_TIMESTEP * MILLISECONDS_IN_SECOND);
+
+    GameSnapshot live_state;
+    g_match.save(live_state);
+    Uint16 bot_buttons;
+    step_bot_peer(*g_loopback_bot, 1, UINT32_MAX, bot_buttons);
+    g_match.load(live_state);
+}
+
+// Sets up a networked match once the scene exists: hosting on a port, joining an
+// "address:port" as player 2, or playing a bot over an in-process loopback link
+bool start_netplay(const char* host_port, const char* join_address, bool loopback, double latency_ms, float loss_percent)
+{
+    if (loopback)
+    {
+        g_loopback_link = new LoopbackLink(latency_ms, loss_percent);
+        g_net_transport = new LoopbackTransport(g_loopback_link, 0);
+        g_loopback_bot = new NetPeer{ RollbackSession(1, HELD_BUTTONS), LoopbackTransport(g_loopback_link, 1), GameSnapshot() };
+        g_match.save(g_loopback_bot->state);
+        g_loopback_bot->session.reset(g_match.get_tick());
+    }
+    else
+    {
+        UdpTransport* udp = new UdpTransport();
+        g_net_transport = udp;
+
+        if (host_port != nullptr)
+        {
+            if (!udp->host((std::uint16_t)std::atoi(host_port))) return false;
+        }
+        else
+        {
+            const char* separator = std::strrchr(join_address, ':');
+            if (separator == nullptr || separator - join_address >= 64) return false;
+
+            char address[64];
+            std::memcpy(address, join_address, separator - join_address);
+            address[separator - join_address] = '\0';
+            if (!udp->join(address, (std::uint16_t)std::atoi(separator + 1))) return false;
+        }
+    }
+
+    g_rollback_session = new RollbackSession(join_address != nullptr ? 1 : 0, HELD_BUTTONS);
+    g_rollback_session->reset(g_match.get_tick());
+    return true;
+}
+
+void log_rollback_stats(const char* label, const RollbackStats& stats)
+{
+    double milliseconds = stats.resimulation_seconds * MILLISECONDS_IN_SECOND;
+    LOG(label << ": " << stats.rollbacks << " rollbacks, " << stats.resimulated_ticks << " ticks re-simulated (deepest "
+        << stats.max_depth << "), " << stats.stalled_ticks << " ticks stalled, " << milliseconds << " ms re-simulating, "
+        << (milliseconds > 0.0 ? stats.resimulated_ticks / milliseconds : 0.0) << " ticks per ms");
+}
+
+// Plays a bot-against-bot match between two peers over a loopback link, checks that both end
+// in the same state as a plain run of the inputs they sent, and prints what rollback cost
+int run_rollback_test(int ticks, double latency_ms, float loss_percent)
+{
+    initialise_scene(0, 0);
+
+    GameSnapshot start;
+    g_match.save(start);
+
+    LoopbackLink link(latency_ms, loss_percent);
+    NetPeer peers[2] = {
+        { RollbackSession(0, HELD_BUTTONS), LoopbackTransport(&link, 0), start },
+        { RollbackSession(1, HELD_BUTTONS), LoopbackTransport(&link, 1), start }
+    };
+    std::vector<Uint16> sent_buttons[2];
+    for (int player = 0; player < 2; player++)
+    {
+        peers[player].session.reset(start.tick);
+        sent_buttons[player].reserve(ticks);
+    }
+
+    // Both peers run until every tick has been simulated with confirmed input, or give up if
+    // the link is so lossy that they are mostly stalled
+    Uint32 end_tick = start.tick + ticks;
+    int steps_left = ticks * 10 + 1000;
+    auto is_settled = [&](const NetPeer& peer) {
+        return peer.state.tick == end_tick && peer.session.get_confirmed_end() == end_tick;
+    };
+
+    while ((!is_settled(peers[0]) || !is_settled(peers[1])) && steps_left-- > 0)
+    {
+        link.advance(FIXED_TIMESTEP * MILLISECONDS_IN_SECOND);
+        for (int player = 0; player < 2; player++)
+        {
+            Uint16 buttons;
+            if (step_bot_peer(peers[player], player, end_tick, buttons)) sent_buttons[player].push_back(buttons);
+        }
+    }
+
+    LOG("Rollback test: " << ticks << " ticks, " << latency_ms << " ms latency, " << loss_percent << "% loss");
+    log_rollback_stats("Player 1", peers[0].session.get_stats());
+    log_rollback_stats("Player 2", peers[1].session.get_stats());
+
+    if (!is_settled(peers[0]) || !is_settled(peers[1]))
+    {
+        LOG("Peers did not confirm every tick");
+        return 1;
+    }
+
+    g_match.load(start);
+    for (int i = 0; i < ticks; i++)
+    {
+        Uint16 inputs[2] = { sent_buttons[0][i], sent_buttons[1][i] };
+        g_match.apply_input(combine_player_buttons(inputs));
+        update_tick();
+    }
+    std::uint64_t expected_hash = hash_game_state();
+
+    bool is_matching = true;
+    for (NetPeer& peer : peers)
+    {
+        g_match.load(peer.state);
+        is_matching = is_matching && hash_game_state() == expected_hash;
+    }
+
+    delete g_game_state.paddle1;
+    delete g_game_state.paddle2;
+    for (Entity* ball : g_game_state.balls) delete ball;
+
+    if (!is_matching)
+    {
+        LOG("Peers ended in different states from a plain run of their inputs");
+        return 1;
+    }
+    LOG("Both peers match a plain run of their inputs, end state " << std::hex << expected_hash << std::dec);
+    return 0;
+}
+
+// ––––– BENCHMARKS ––––– //
+constexpr double BENCHMARK_REGRESSION_PERCENT = 10.0;
+constexpr int STEP_BENCHMARK_BALLS = 1000;
+
+// Hot paths timed without a window. Results go to save_filepath as JSON, or to stdout when
+// there is neither a save file nor a baseline; with a baseline, prints the change for each
+// benchmark and returns non-zero if anything got slower by more than the threshold.
+int run_benchmarks(const char* save_filepath, const char* baseline_filepath)
+{
+    BenchmarkSuite suite;
+
+    // A ball tested against a field of entities, about a tenth of them touching it
+    const int entity_counts[] = { 100, 1000 };
+    for (int count : entity_counts)
+    {
+        std::vector<Entity> entities;
+        for (int i = 0; i < count; i++)
+        {
+            Entity entity(0, 1.0f, 0.5f, 0.5f, PADDLE);
+            entity.set_position(glm::vec3((i % 10) - 4.5f, (i / 10 % 10) * 0.75f - 3.5f, 0.0f));
+            entities.push_back(entity);
+        }
+        Entity ball(0, 1.0f, 0.5f, 0.5f, BALL);
+
+        std::string name = "Entity::check_collision/" + std::to_string(count);
+        suite.run(name.c_str(), count, [&]() {
+            int hits = 0;
+            for (Entity& entity : entities) hits += ball.check_collision(&entity);
+            benchmark_sink(&hits);
+        });
+
+        auto reset_ball = [&]() {
+            ball.set_position(glm::vec3(0.2f, 0.1f, 0.0f));
+            ball.set_velocity(glm::vec3(1.0f, 1.0f, 0.0f));
+        };
+        name = "Entity::check_collision_x/" + std::to_string(count);
+        suite.run_with_setup(name.c_str(), count, reset_ball, [&]() {
+            ball.check_collision_x(entities.data(), count);
+        });
+        name = "Entity::check_collision_y/" + std::to_string(count);
+        suite.run_with_setup(name.c_str(), count, reset_ball, [&]() {
+            ball.check_collision_y(entities.data(), count);
+        });
+    }
+
+    // Fresh vectors from the frame arena each call, as draw_text does
+    const char* message_text = "Player 1 Wins!";
+    const char* hud_text = "FRAME 16.7 MS  P50 16.6  P99 18.0";
+    suite.run("build_text_mesh/message", 1, [&]() {
+        g_frame_arena.reset();
+        FrameVector<float> vertices, texture_coordinates;
+        build_text_mesh(message_text, 0.5f, -0.25f, vertices, texture_coordinates);
+        benchmark_sink(vertices.data());
+    });
+    suite.run("build_text_mesh/hud", 1, [&]() {
+        g_frame_arena.reset();
+        FrameVector<float> vertices, texture_coordinates;
+        build_text_mesh(hud_text, HUD_FONT_SIZE, 0.0f, vertices, texture_coordinates);
+        benchmark_sink(vertices.data());
+    });
+
+    // The decode half of load_texture, from memory so disk speed doesn't count
+    std::ifstream file(BALL_FILEPATH, std::ios::binary);
+    std::vector<unsigned char> encoded((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (encoded.empty()) LOG("Skipping image decode, " << BALL_FILEPATH << " not found");
+    else
+    {
+        suite.run("load_texture/decode", 1, [&]() {
+            int width, height, number_of_components;
+            unsigned char* image = stbi_load_from_memory(encoded.data(), (int)encoded.size(), &width, &height, &number_of_components, STBI_rgb_alpha);
+            benchmark_sink(image);
+            stbi_image_free(image);
+        });
+    }
+
+    // One tick of the rules over the stress test's balls, in float and in fixed point
+    PongMatch stress_match;
+    for (bool is_fixed_point : { false, true })
+    {
+        stress_match.set_fixed_point(is_fixed_point);
+        std::string name = std::string("PongMatch::step/") + (is_fixed_point ? "fixed/" : "float/") + std::to_string(STEP_BENCHMARK_BALLS);
+        suite.run_with_setup(name.c_str(), STEP_BENCHMARK_BALLS, [&]() {
+            build_stress_balls(stress_match, STEP_BENCHMARK_BALLS);
+        }, [&]() {
+            stress_match.step();
+        });
+    }
+
+    // The live game with all three balls out, each delta taken against the tick before
+    initialise_scene(0, 0);
+    g_match.set_desired_ball_count(3);
+    for (int i = 0; i < 30; i++) update_tick();
+
+    SnapshotStream stream;
+    stream.begin_write(SNAPSHOT_LOSSLESS);
+    serialize_game_state(stream);
+    SnapshotFields baseline = stream.get_fields();
+    update_tick();
+
+    suite.run("serialize_game_state/encode", 1, [&]() {
+        stream.begin_write(SNAPSHOT_LOSSLESS);
+        serialize_game_state(stream);
+        benchmark_sink(stream.get_data());
+    });
+    suite.run("serialize_game_state/encode_delta", 1, [&]() {
+        stream.begin_write(SNAPSHOT_LOSSLESS, &baseline);
+        serialize_game_state(stream);
+        benchmark_sink(stream.get_data());
+    });
+    suite.run("serialize_game_state/encode_quantized", 1, [&]() {
+        stream.begin_write(SNAPSHOT_QUANTIZED);
+        serialize_game_state(stream);
+        benchmark_sink(stream.get_data());
+    });
+
+    // Restoring the current tick's delta over itself leaves the state unchanged between runs
+    stream.begin_write(SNAPSHOT_LOSSLESS, &baseline);
+    serialize_game_state(stream);
+    std::vector<std::uint8_t> delta(stream.get_data(), stream.get_data() + stream.get_size());
+    suite.run("serialize_game_state/restore_delta", 1, [&]() {
+        stream.begin_read(delta.data(), delta.size(), SNAPSHOT_LOSSLESS, &baseline);
+        serialize_game_state(stream);
+        benchmark_sink(g_match.get_balls().data());
+    });
+
+    delete g_game_state.paddle1;
+    delete g_game_state.paddle2;
+    for (Entity* ball : g_game_state.balls) delete ball;
+
+    if (save_filepath != nullptr)
+    {
+        if (!suite.save_json(save_filepath)) LOG("Unable to save benchmark results to " << save_filepath);
+    }
+    else if (baseline_filepath == nullptr) suite.write_json(stdout);
+
+    if (baseline_filepath == nullptr) return 0;
+
+    int regressions = suite.compare_with_baseline(baseline_filepath, BENCHMARK_REGRESSION_PERCENT);
+    if (regressions < 0) LOG("Unable to read benchmark baseline " << baseline_filepath);
+    return regressions == 0 ? 0 : 1;
+}
+
+// ––––– STRESS TEST ––––– //
+const int STRESS_COUNTS[] = { 10, 100, 1000, 10000, 100000 };
+constexpr int STRESS_TICKS = 120;
+
+// Replaces the balls with count of them, spread around the middle of the court and moving
+// mostly vertically so none reaches a goal during the run
+void build_stress_balls(PongMatch& match, int count)
+{
+    std::vector<PongBall>& balls = match.get_balls();
+    balls.clear();
+
+    for (int i = 0; i < count; i++)
+    {
+        float spread = std::fmod(i * 0.618034f, 1.0f);
+        PongBall ball;
+        ball.position = glm::vec3(spread - 0.5f, std::fmod(i * 0.754878f, 1.0f) * 6.0f - 3.0f, 0.0f);
+        ball.velocity = glm::vec3(0.4f * spread - 0.2f, i % 2 == 0 ? 1.5f : -1.5f, 0.0f);
+        ball.is_active = true;
+        balls.push_back(ball);
+    }
+    match.set_desired_ball_count(count);
+}
+
+// Runs the game's own tick for the given number of ticks at each size in STRESS_COUNTS, and
+// prints update and render time per tick as CSV. Headless runs leave the render column empty.
+int run_stress_test(bool windowed, int ticks)
+{
+    if (windowed)
+    {
+        initialise();
+        SDL_GL_SetSwapInterval(0);  // Time the work, not the display's refresh
+    }
+    else initialise_scene(0, 0);
+
+    std::printf("scene,entities,ticks,update_us_per_tick,render_us_per_tick\n");
+
+    for (int count : STRESS_COUNTS)
+    {
+        build_stress_balls(g_match, count);
+
+        double update_seconds = 0.0, render_seconds = 0.0;
+        for (int tick = 0; tick < ticks; tick++)
+        {
+            auto update_start = std::chrono::steady_clock::now();
+            update_tick();
+            update_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - update_start).count();
+
+            if (!windowed) continue;
+
+            auto render_start = std::chrono::steady_clock::now();
+            render();
+            render_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - render_start).count();
+        }
+
+        if (windowed) std::printf("balls,%d,%d,%.2f,%.2f\n", count, ticks, update_seconds * 1.0e6 / ticks, render_seconds * 1.0e6 / ticks);
+        else std::printf("balls,%d,%d,%.2f,\n", count, ticks, update_seconds * 1.0e6 / ticks);
+        std::fflush(stdout);
+    }
+
+    if (windowed) shutdown();
+    return 0;
+}
+
+// ––––– MATCH SERVER ––––– //
+// Serves matches with the game's own collision masks, so they play out as a local game would
+int serve_matches(MatchServerOptions& options)
+{
+    load_collision_mask(PADDLE_FILEPATH, PongMatch::PADDLE_WIDTH, PongMatch::PADDLE_HEIGHT, g_paddle_mask);
+    load_collision_mask(BALL_FILEPATH, PongMatch::BALL_SIZE, PongMatch::BALL_SIZE, g_ball_mask);
+    options.paddle_mask = &g_paddle_mask;
+    options.ball_mask = &g_ball_mask;
+    return run_match_server(options);
+}
+
+// Usage: --record <file> to capture a session, --replay <file> [--expect <hash>] to re-run one,
+// --profile <file> to choose where a profiler build writes its trace, --benchmark to time the
+// hot paths, with --benchmark-save <file> to keep the results and --benchmark-baseline <file>
+// to compare against kept results, --stress or --stress-windowed [--stress-ticks <n>] to print
+// a CSV scaling curve, --zero-alloc-after <frames> to abort on any frame that allocates once
+// warmed up (needs a build with -DENABLE_ALLOC_TRACKING), --gl-capture <file> [--gl-capture-frames <n>]
+// to record the GL calls of the first frames for the GL Replay tool, --net-host <port> or
+// --net-join <address:port> to play over UDP, --net-loopback to play a bot over a simulated
+// link, --rollback-test [--rollback-ticks <n>] to check two bots over one headless, with
+// --net-latency <ms> and --net-loss <percent> setting the simulated link, --state-file <file> to
+// resume from and quick save (F5) to a file, --snapshot-check with --replay to put every tick's
+// state through a snapshot and back and print snapshot sizes and times, --server <port>
+// [--server-threads <n>] [--server-seconds <s>] to host headless matches over UDP, and
+// --bot-clients <n> [--bot-server <address:port>] [--bot-threads <n>] [--bot-seconds <s>] to load
+// a server with scripted players, --dynamic-resolution <ms> to lower the scene's resolution
+// whenever rendering takes longer than that, --texture-budget <KB> to cap the memory textures
+// take on the GPU, reloading evicted ones when next drawn, and --fixed-point to run the match in
+// fixed-point integers so every build and machine computes the same ticks
 int main(int argc, char* argv[])
 {
+    const char* replay_filepath = nullptr;
+    const char* expected_hash = nullptr;
+    const char* benchmark_save_filepath = nullptr;
+    const char* benchmark_baseline_filepath = nullptr;
+    bool benchmark = false;
+    bool stress = false, stress_windowed = false;
+    int stress_ticks = STRESS_TICKS;
+    int gl_capture_frames = GL_CAPTURE_FRAMES;
+    const char* net_host_port = nullptr;
+    const char* net_join_address = nullptr;
+    bool net_loopback = false, rollback_test = false;
+    int rollback_ticks = ROLLBACK_TEST_TICKS;
+    double net_latency_ms = NET_LATENCY_MS;
+    float net_loss_percent = NET_LOSS_PERCENT;
+    bool check_snapshots = false;
+    MatchServerOptions server_options;
+    BotClientOptions bot_options;
+    bool server = false, bots = false;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (std::strcmp(argv[i], "--benchmark") == 0)
+        {
+            benchmark = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--stress") == 0)
+        {
+            stress = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--stress-windowed") == 0)
+        {
+            stress = stress_windowed = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--net-loopback") == 0)
+        {
+            net_loopback = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--rollback-test") == 0)
+        {
+            rollback_test = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--snapshot-check") == 0)
+        {
+            check_snapshots = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--fixed-point") == 0)
+        {
+            g_use_fixed_point = server_options.fixed_point = true;
+            continue;
+        }
+        if (i + 1 >= argc) break;
+
+        if (std::strcmp(argv[i], "--record") == 0) g_record_filepath = argv[++i];
+        else if (std::strcmp(argv[i], "--replay") == 0) replay_filepath = argv[++i];
+        else if (std::strcmp(argv[i], "--expect") == 0) expected_hash = argv[++i];
+        else if (std::strcmp(argv[i], "--profile") == 0) g_profile_filepath = argv[++i];
+        else if (std::strcmp(argv[i], "--gl-capture") == 0) g_gl_capture_filepath = argv[++i];
+        else if (std::strcmp(argv[i], "--gl-capture-frames") == 0) gl_capture_frames = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--benchmark-save") == 0) benchmark_save_filepath = argv[++i];
+        else if (std::strcmp(argv[i], "--benchmark-baseline") == 0) benchmark_baseline_filepath = argv[++i];
+        else if (std::strcmp(argv[i], "--stress-ticks") == 0) stress_ticks = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--net-host") == 0) net_host_port = argv[++i];
+        else if (std::strcmp(argv[i], "--net-join") == 0) net_join_address = argv[++i];
+        else if (std::strcmp(argv[i], "--net-latency") == 0) net_latency_ms = std::max(0.0, std::atof(argv[++i]));
+        else if (std::strcmp(argv[i], "--net-loss") == 0) net_loss_percent = (float)std::atof(argv[++i]);
+        else if (std::strcmp(argv[i], "--rollback-ticks") == 0) rollback_ticks = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--state-file") == 0) g_state_filepath = argv[++i];
+        else if (std::strcmp(argv[i], "--texture-budget") == 0) g_texture_residency.set_budget((std::size_t)std::max(0, std::atoi(argv[++i])) * 1024);
+        else if (std::strcmp(argv[i], "--dynamic-resolution") == 0)
+        {
+            g_use_dynamic_resolution = true;
+            g_resolution_settings.target_milliseconds = std::max(1.0f, (float)std::atof(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--server") == 0)
+        {
+            server = true;
+            server_options.port = (std::uint16_t)std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--server-threads") == 0) server_options.thread_count = std::max(0, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--server-seconds") == 0) server_options.seconds = std::max(0.0, std::atof(argv[++i]));
+        else if (std::strcmp(argv[i], "--bot-clients") == 0)
+        {
+            bots = true;
+            bot_options.client_count = std::max(1, std::atoi(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--bot-server") == 0) bot_options.server_address = argv[++i];
+        else if (std::strcmp(argv[i], "--bot-threads") == 0) bot_options.thread_count = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--bot-seconds") == 0) bot_options.seconds = std::max(0.0, std::atof(argv[++i]));
+        else if (std::strcmp(argv[i], "--zero-alloc-after") == 0)
+        {
+            if (!ALLOC_REQUIRE_STEADY_STATE(std::atoi(argv[++i]))) LOG("--zero-alloc-after needs a build with -DENABLE_ALLOC_TRACKING");
+        }
+    }
+
+    if (server) return serve_matches(server_options);
+    if (bots) return run_bot_clients(bot_options);
+    if (stress) return run_stress_test(stress_windowed, stress_ticks);
+    if (rollback_test) return run_rollback_test(rollback_ticks, net_latency_ms, net_loss_percent);
+
+    if (benchmark || benchmark_save_filepath != nullptr || benchmark_baseline_filepath != nullptr)
+    {
+        return run_benchmarks(benchmark_save_filepath, benchmark_baseline_filepath);
+    }
+    if (replay_filepath != nullptr) return replay(replay_filepath, expected_hash, check_snapshots);
+
+    if (g_gl_capture_filepath != nullptr && !g_gl_capture.start(g_gl_capture_filepath, gl_capture_frames))
+    {
+        LOG("Unable to write GL trace to " << g_gl_capture_filepath);
+    }
+
     initialise();
+    g_gl_capture.end_setup();
+
+    bool is_networked = net_loopback || net_host_port != nullptr || net_join_address != nullptr;
+    if (is_networked && !start_netplay(net_host_port, net_join_address, net_loopback, net_latency_ms, net_loss_percent))
+    {
+        LOG("Unable to open a connection for networked play");
+        shutdown();
+        return 1;
+    }
+    start_snapshots();
 
     while (g_app_status == RUNNING)
     {
+        PROFILE_SCOPE("frame");
+        ALLOC_FRAME_BEGIN();
+        g_frame_arena.reset();
+
         process_input();
         update();
         render();
+
+        ALLOC_FRAME_END();
     }
 
     shutdown();
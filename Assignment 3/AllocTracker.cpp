@@ -0,0 +1,165 @@
+#include "AllocTracker.h"
+
+#ifdef ENABLE_ALLOC_TRACKING
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+struct ZoneCounters {
+    std::atomic<const char*> name{ nullptr };
+    std::atomic<std::uint64_t> allocations{ 0 };
+    std::atomic<std::uint64_t> bytes{ 0 };
+    std::atomic<std::uint64_t> frame_allocations{ 0 };
+    std::atomic<std::uint64_t> frame_bytes{ 0 };
+};
+
+// Nothing here may allocate, since it all runs inside operator new
+static constexpr int NO_ZONE_SLOT = 0;
+static constexpr int OVERFLOW_SLOT = ALLOC_ZONE_CAPACITY - 1;
+
+static ZoneCounters g_zones[ALLOC_ZONE_CAPACITY];
+static std::atomic<std::uint64_t> g_total_allocations{ 0 };
+static std::atomic<std::uint64_t> g_total_bytes{ 0 };
+
+static thread_local int t_zone_slot = NO_ZONE_SLOT;
+static thread_local int t_exempt_depth = 0;
+
+// Frame bookkeeping belongs to the thread that runs the frame loop
+static AllocationCounts g_frame_start;
+static AllocationCounts g_last_frame;
+static int g_frame_index = 0;
+static int g_warmup_frames = -1;  // Negative while steady state is not required
+
+// Same-named zones from different translation units share a slot
+static int find_zone_slot(const char* name) {
+    for (int slot = NO_ZONE_SLOT + 1; slot < OVERFLOW_SLOT; slot++) {
+        const char* existing = g_zones[slot].name.load(std::memory_order_acquire);
+        if (existing == nullptr && g_zones[slot].name.compare_exchange_strong(existing, name, std::memory_order_acq_rel)) {
+            return slot;
+        }
+        if (existing == name || std::strcmp(existing, name) == 0) return slot;
+    }
+    return OVERFLOW_SLOT;
+}
+
+static const char* get_zone_label(int slot) {
+    if (slot == NO_ZONE_SLOT) return "(no zone)";
+    if (slot == OVERFLOW_SLOT) return "(other zones)";
+    return g_zones[slot].name.load(std::memory_order_acquire);
+}
+
+static void note_allocation(std::size_t size) {
+    if (t_exempt_depth > 0) return;
+
+    g_total_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_total_bytes.fetch_add(size, std::memory_order_relaxed);
+
+    ZoneCounters& zone = g_zones[t_zone_slot];
+    zone.allocations.fetch_add(1, std::memory_order_relaxed);
+    zone.bytes.fetch_add(size, std::memory_order_relaxed);
+    zone.frame_allocations.fetch_add(1, std::memory_order_relaxed);
+    zone.frame_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+
+static void* tracked_allocate(std::size_t size) {
+    void* pointer = std::malloc(size == 0 ? 1 : size);
+    if (pointer == nullptr) throw std::bad_alloc();
+
+    note_allocation(size);
+    return pointer;
+}
+
+static void* tracked_allocate_nothrow(std::size_t size) noexcept {
+    void* pointer = std::malloc(size == 0 ? 1 : size);
+    if (pointer != nullptr) note_allocation(size);
+    return pointer;
+}
+
+void* operator new(std::size_t size) { return tracked_allocate(size); }
+void* operator new[](std::size_t size) { return tracked_allocate(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return tracked_allocate_nothrow(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return tracked_allocate_nothrow(size); }
+
+void operator delete(void* pointer) noexcept { std::free(pointer); }
+void operator delete[](void* pointer) noexcept { std::free(pointer); }
+void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, std::size_t) noexcept { std::free(pointer); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { std::free(pointer); }
+
+AllocZone::AllocZone(const char* name) : m_previous_slot(t_zone_slot) {
+    t_zone_slot = find_zone_slot(name);
+}
+
+AllocZone::~AllocZone() {
+    t_zone_slot = m_previous_slot;
+}
+
+AllocExempt::AllocExempt() {
+    t_exempt_depth++;
+}
+
+AllocExempt::~AllocExempt() {
+    t_exempt_depth--;
+}
+
+AllocationCounts alloc_tracker_get_total() {
+    AllocationCounts total;
+    total.allocations = g_total_allocations.load(std::memory_order_relaxed);
+    total.bytes = g_total_bytes.load(std::memory_order_relaxed);
+    return total;
+}
+
+AllocationCounts alloc_tracker_get_last_frame() {
+    return g_last_frame;
+}
+
+void alloc_tracker_require_steady_state(int warmup_frames) {
+    g_warmup_frames = warmup_frames < 0 ? 0 : warmup_frames;
+}
+
+void alloc_tracker_begin_frame() {
+    g_frame_start = alloc_tracker_get_total();
+    for (ZoneCounters& zone : g_zones) {
+        zone.frame_allocations.store(0, std::memory_order_relaxed);
+        zone.frame_bytes.store(0, std::memory_order_relaxed);
+    }
+}
+
+void alloc_tracker_end_frame() {
+    AllocationCounts total = alloc_tracker_get_total();
+    g_last_frame.allocations = total.allocations - g_frame_start.allocations;
+    g_last_frame.bytes = total.bytes - g_frame_start.bytes;
+    g_frame_index++;
+
+    if (g_warmup_frames < 0 || g_frame_index <= g_warmup_frames || g_last_frame.allocations == 0) return;
+
+    std::fprintf(stderr, "Frame %d made %llu allocations (%llu bytes) after %d warm-up frames:\n", g_frame_index,
+        (unsigned long long)g_last_frame.allocations, (unsigned long long)g_last_frame.bytes, g_warmup_frames);
+    for (int slot = 0; slot < ALLOC_ZONE_CAPACITY; slot++) {
+        std::uint64_t allocations = g_zones[slot].frame_allocations.load(std::memory_order_relaxed);
+        if (allocations == 0) continue;
+
+        std::fprintf(stderr, "  %-32s %8llu allocations %10llu bytes\n", get_zone_label(slot),
+            (unsigned long long)allocations, (unsigned long long)g_zones[slot].frame_bytes.load(std::memory_order_relaxed));
+    }
+    std::abort();
+}
+
+void alloc_tracker_write_report(std::FILE* file) {
+    std::fprintf(file, "%-32s %12s %14s\n", "zone", "allocations", "bytes");
+    for (int slot = 0; slot < ALLOC_ZONE_CAPACITY; slot++) {
+        std::uint64_t allocations = g_zones[slot].allocations.load(std::memory_order_relaxed);
+        if (allocations == 0) continue;
+
+        std::fprintf(file, "%-32s %12llu %14llu\n", get_zone_label(slot),
+            (unsigned long long)allocations, (unsigned long long)g_zones[slot].bytes.load(std::memory_order_relaxed));
+    }
+
+    AllocationCounts total = alloc_tracker_get_total();
+    std::fprintf(file, "%-32s %12llu %14llu\n", "total", (unsigned long long)total.allocations, (unsigned long long)total.bytes);
+}
+
+#endif
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <cstdint>
+#include "glm/mat4x4.hpp"
+#include "ShaderProgram.h"
+
+// ––––– CACHED SHADER PROGRAM ––––– //
+// Stands in for the framework's ShaderProgram, with the same uniforms and attributes, but keeps
+// the linked program's binary next to the vertex shader (vertex_textured.glsl.cache) so later
+// starts skip compiling and linking. The cache is keyed by an FNV-1a hash of both sources and the
+// GL_VENDOR, GL_RENDERER and GL_VERSION strings, so an edited shader or a new driver misses it.
+// A miss, a binary the driver rejects, or a driver without program binaries (core from GL 4.1,
+// else ARB_get_program_binary) compiles from source as before and writes the cache again.
+class CachedShaderProgram {
+private:
+    GLuint m_program_id = 0;
+    GLint m_model_matrix_uniform = -1, m_view_matrix_uniform = -1, m_projection_matrix_uniform = -1;
+    GLuint m_position_attribute = 0, m_tex_coordinate_attribute = 0;
+
+    bool load_binary(const char* cache_path, std::uint64_t key);
+    bool compile(const char* vertex_source, const char* fragment_source);
+    void save_binary(const char* cache_path, std::uint64_t key) const;
+
+public:
+    void load(const char* vertex_shader_path, const char* fragment_shader_path);
+    void cleanup();
+
+    // Each binds the program first, as ShaderProgram's do, so they can come before glUseProgram
+    void set_model_matrix(const glm::mat4& matrix);
+    void set_view_matrix(const glm::mat4& matrix);
+    void set_projection_matrix(const glm::mat4& matrix);
+
+    GLuint get_program_id() const { return m_program_id; }
+    GLuint get_position_attribute() const { return m_position_attribute; }
+    GLuint get_tex_coordinate_attribute() const { return m_tex_coordinate_attribute; }
+};
@@ -0,0 +1,146 @@
+#include <algorithm>
+#include <cmath>
+#include "DynamicResolution.h"
+#include "Framebuffer.h"
+#include "PerfHud.h"
+#include "Profiler.h"
+
+// ––––– CONTROLLER ––––– //
+ResolutionController::ResolutionController(ResolutionSettings settings)
+    : m_settings(settings) {
+    m_telemetry.scale = settings.max_scale;
+}
+
+void ResolutionController::change_scale(float scale) {
+    // The average so far was at the old size; carry it over as an estimate for the new one
+    float ratio = scale / m_telemetry.scale;
+    m_telemetry.smoothed_milliseconds *= ratio * ratio;
+
+    if (scale < m_telemetry.scale) m_telemetry.scale_downs++;
+    else m_telemetry.scale_ups++;
+    m_telemetry.scale = scale;
+
+    m_frames_over = 0;
+    m_frames_under = 0;
+    m_settle_frames = SETTLE_FRAMES;
+}
+
+void ResolutionController::add_frame(float work_milliseconds) {
+    ResolutionTelemetry& telemetry = m_telemetry;
+    float target = m_settings.target_milliseconds;
+
+    telemetry.frames++;
+    telemetry.scale_total += telemetry.scale;
+    if (work_milliseconds > target) telemetry.frames_over_budget++;
+
+    if (telemetry.frames == 1) telemetry.smoothed_milliseconds = work_milliseconds;
+    else telemetry.smoothed_milliseconds += (work_milliseconds - telemetry.smoothed_milliseconds) * SMOOTHING;
+
+    if (m_settle_frames > 0) {
+        m_settle_frames--;
+        return;
+    }
+
+    float scale = telemetry.scale;
+    float smoothed = telemetry.smoothed_milliseconds;
+    float next_up = std::min(m_settings.max_scale, scale + m_settings.scale_step);
+
+    if (smoothed > target) {
+        m_frames_over++;
+        m_frames_under = 0;
+    }
+    else {
+        float ratio = next_up / scale;
+        bool would_fit = next_up > scale && smoothed * ratio * ratio < target * RAISE_MARGIN;
+        m_frames_under = would_fit ? m_frames_under + 1 : 0;
+        m_frames_over = 0;
+    }
+
+    if (m_frames_over >= FRAMES_TO_LOWER && scale > m_settings.min_scale) {
+        // Straight to the size predicted to fit, in whole steps, rather than one step at a time
+        float fitting = scale * std::sqrt(target / smoothed);
+        float lower = std::floor(fitting / m_settings.scale_step) * m_settings.scale_step;
+        change_scale(std::max(m_settings.min_scale, std::min(lower, scale - m_settings.scale_step)));
+    }
+    else if (m_frames_under >= FRAMES_TO_RAISE) {
+        change_scale(next_up);
+    }
+}
+
+// ––––– RENDER TARGET ––––– //
+void DynamicResolution::initialise(int window_width, int window_height, ResolutionSettings settings) {
+    m_controller = ResolutionController(settings);
+    m_window_width = m_width = window_width;
+    m_window_height = m_height = window_height;
+    if (!load_framebuffer_functions()) return;
+
+    m_texture = create_target_texture(window_width, window_height);
+    traced_gen_framebuffer(&m_framebuffer);
+
+    traced_bind_framebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    traced_framebuffer_texture_2d(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_texture, 0);
+    m_is_enabled = is_framebuffer_complete();
+    traced_bind_framebuffer(GL_FRAMEBUFFER, 0);
+}
+
+void DynamicResolution::begin() {
+    if (!m_is_enabled) return;
+
+    float scale = m_controller.get_scale();
+    m_width = std::max(1, (int)std::lround(m_window_width * scale));
+    m_height = std::max(1, (int)std::lround(m_window_height * scale));
+
+    traced_bind_framebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    traced_viewport(0, 0, m_width, m_height);
+}
+
+void DynamicResolution::end(CachedShaderProgram* program, const glm::mat4& projection_matrix, const glm::mat4& view_matrix) {
+    PROFILE_SCOPE("DynamicResolution::end");
+    if (!m_is_enabled) return;
+
+    traced_bind_framebuffer(GL_FRAMEBUFFER, 0);
+    traced_viewport(0, 0, m_window_width, m_window_height);
+
+    // One quad over the whole window in clip space, sampling only the corner drawn this frame
+    traced_set_projection_matrix(program, glm::mat4(1.0f));
+    traced_set_view_matrix(program, glm::mat4(1.0f));
+    counted_set_model_matrix(program, glm::mat4(1.0f));
+
+    float u = (float)m_width / m_window_width;
+    float v = (float)m_height / m_window_height;
+    float vertices[] = {
+        -1.0f, -1.0f,
+        1.0f, -1.0f,
+        1.0f, 1.0f,
+        -1.0f, -1.0f,
+        1.0f, 1.0f,
+        -1.0f, 1.0f
+    };
+    float tex_coords[] = {
+        0.0f, 0.0f,
+        u, 0.0f,
+        u, v,
+        0.0f, 0.0f,
+        u, v,
+        0.0f, v
+    };
+
+    counted_bind_texture(GL_TEXTURE_2D, m_texture);
+
+    traced_vertex_attrib_pointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, vertices);
+    traced_enable_vertex_attrib_array(program->get_position_attribute());
+
+    traced_vertex_attrib_pointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, tex_coords);
+    traced_enable_vertex_attrib_array(program->get_tex_coordinate_attribute());
+
+    // A straight copy; the frame's alpha is whatever blending left behind and means nothing here
+    traced_blend_func(GL_ONE, GL_ZERO);
+    counted_draw_arrays(GL_TRIANGLES, 0, 6);
+    traced_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    traced_disable_vertex_attrib_array(program->get_position_attribute());
+    traced_disable_vertex_attrib_array(program->get_tex_coordinate_attribute());
+
+    traced_set_projection_matrix(program, projection_matrix);
+    traced_set_view_matrix(program, view_matrix);
+}
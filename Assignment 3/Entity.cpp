@@ -10,18 +10,30 @@
 #include <SDL_opengl.h>
 #include "glm/mat4x4.hpp"
 #include "glm/gtc/matrix_transform.hpp"
-#include "ShaderProgram.h"
+#include "CachedShaderProgram.h"
 #include "Entity.h"
+#include "PerfHud.h"
+#include "Profiler.h"
+
+// Forces are constant over a step, so every stage of the integrator sees the same acceleration
+static glm::vec3 constant_acceleration(glm::vec3 /*position*/, glm::vec3 /*velocity*/, const void* context) {
+    return *(const glm::vec3*)context;
+}
 
 void Entity::update(float delta_time) {
+    PROFILE_SCOPE("Entity::update");
+    glm::vec3 force = m_force;
+    m_force = glm::vec3(0.0f);
+
     if (!m_active || !m_should_update) return;
 
-    // Updating velocity based on acceleration
-    m_velocity += m_acceleration * delta_time;
+    m_acceleration = force / m_mass;
+    integrate(m_integrator, m_position, m_velocity, constant_acceleration, &m_acceleration, delta_time);
 
-    // Updating position based on velocity
-    m_position += m_velocity * delta_time;
+    update_model_matrix();
+}
 
+void Entity::update_model_matrix() {
     // Reseting and applying the model matrix
     m_model_matrix = glm::mat4(1.0f);
     m_model_matrix = glm::translate(m_model_matrix, m_position);
@@ -29,13 +41,14 @@ void Entity::update(float delta_time) {
 }
 
 
-void Entity::render(ShaderProgram* program) {
+void Entity::render(CachedShaderProgram* program) {
+    PROFILE_SCOPE("Entity::render");
     if (!m_active) return;
 
-    program->set_model_matrix(m_model_matrix);
+    counted_set_model_matrix(program, m_model_matrix);
 
 
-    glBindTexture(GL_TEXTURE_2D, m_texture_id);
+    counted_bind_texture(GL_TEXTURE_2D, m_texture_id);
     float vertices[] = {
         -0.5f, -0.5f,
         0.5f, -0.5f,
@@ -54,33 +67,33 @@ void Entity::render(ShaderProgram* program) {
         0.0f, 0.0f
     };
 
-    glVertexAttribPointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, vertices);
-    glEnableVertexAttribArray(program->get_position_attribute());
+    traced_vertex_attrib_pointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, vertices);
+    traced_enable_vertex_attrib_array(program->get_position_attribute());
 
-    glVertexAttribPointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, tex_coords);
-    glEnableVertexAttribArray(program->get_tex_coordinate_attribute());
+    traced_vertex_attrib_pointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, tex_coords);
+    traced_enable_vertex_attrib_array(program->get_tex_coordinate_attribute());
 
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    counted_draw_arrays(GL_TRIANGLES, 0, 6);
 
-    glDisableVertexAttribArray(program->get_position_attribute());
-    glDisableVertexAttribArray(program->get_tex_coordinate_attribute());
+    traced_disable_vertex_attrib_array(program->get_position_attribute());
+    traced_disable_vertex_attrib_array(program->get_tex_coordinate_attribute());
 
     // Rendering the fire texture below the rocket
     if (m_fire_texture_id != 0) {
         glm::mat4 fire_model_matrix = glm::translate(m_model_matrix, glm::vec3(0.0f, -0.6f, 0.0f));
-        program->set_model_matrix(fire_model_matrix);
+        counted_set_model_matrix(program, fire_model_matrix);
 
-        glBindTexture(GL_TEXTURE_2D, m_fire_texture_id);
+        counted_bind_texture(GL_TEXTURE_2D, m_fire_texture_id);
 
-        glVertexAttribPointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, vertices);
-        glEnableVertexAttribArray(program->get_position_attribute());
+        traced_vertex_attrib_pointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, vertices);
+        traced_enable_vertex_attrib_array(program->get_position_attribute());
 
-        glVertexAttribPointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, tex_coords);
-        glEnableVertexAttribArray(program->get_tex_coordinate_attribute());
+        traced_vertex_attrib_pointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, tex_coords);
+        traced_enable_vertex_attrib_array(program->get_tex_coordinate_attribute());
 
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+        counted_draw_arrays(GL_TRIANGLES, 0, 6);
 
-        glDisableVertexAttribArray(program->get_position_attribute());
-        glDisableVertexAttribArray(program->get_tex_coordinate_attribute());
+        traced_disable_vertex_attrib_array(program->get_position_attribute());
+        traced_disable_vertex_attrib_array(program->get_tex_coordinate_attribute());
     }
 }
@@ -1,13 +1,17 @@
 #pragma once
 
 #include "glm/mat4x4.hpp"
-#include "ShaderProgram.h"
+#include "CachedShaderProgram.h"
+#include "Integrator.h"
 
 class Entity {
 private:
     glm::vec3 m_position;
     glm::vec3 m_velocity;
-    glm::vec3 m_acceleration;
+    glm::vec3 m_acceleration;   // Applied during the last update, from the accumulated force
+    glm::vec3 m_force;          // Summed by add_force() and cleared after every update
+    float m_mass;
+    Integrator m_integrator;
     glm::vec3 m_scale;
     glm::mat4 m_model_matrix;
     GLuint m_texture_id;
@@ -22,7 +26,12 @@ public:
         : m_texture_id(texture_id), m_position(position), m_velocity(velocity), m_scale(scale), m_active(active), m_should_update(should_update)
     {
         m_model_matrix = glm::mat4(1.0f);
-        m_acceleration = glm::vec3(0.0f, -0.001f, 0.0f);
+        m_acceleration = glm::vec3(0.0f);
+        m_force = glm::vec3(0.0f);
+        m_mass = 1.0f;
+        m_integrator = SEMI_IMPLICIT_EULER;
+        m_fire_texture_id = 0;
+        m_explosion_texture_id = 0;
     }
 
     void set_active(bool active) { m_active = active; }
@@ -34,6 +43,9 @@ public:
     void set_position(glm::vec3 position) { m_position = position; }
     void set_velocity(glm::vec3 velocity) { m_velocity = velocity; }
     void set_acceleration(glm::vec3 acceleration) { m_acceleration = acceleration; }
+    void add_force(glm::vec3 force) { m_force += force; }
+    void set_mass(float mass) { m_mass = mass; }
+    void set_integrator(Integrator integrator) { m_integrator = integrator; }
     void set_scale(glm::vec3 scale) { m_scale = scale; }
     void set_texture_id(GLuint texture_id) { m_texture_id = texture_id; }
     void set_fire_texture(GLuint fire_texture_id) { m_fire_texture_id = fire_texture_id; }
@@ -45,8 +57,11 @@ public:
     glm::vec3 get_velocity() const { return m_velocity; }
     glm::vec3 get_position() const { return m_position; }
     glm::vec3 get_acceleration() const { return m_acceleration; }
+    float get_mass() const { return m_mass; }
+    Integrator get_integrator() const { return m_integrator; }
     GLuint get_texture_id() const { return m_texture_id; }
 
+    void update_model_matrix();
     void update(float delta_time);
-    void render(ShaderProgram* program);
+    void render(CachedShaderProgram* program);
 };
@@ -0,0 +1,41 @@
+#include <algorithm>
+#include <cmath>
+#include "Heightfield.h"
+
+void Heightfield::build_from_alpha(const unsigned char* rgba, int width, int height,
+    glm::vec3 position, glm::vec3 scale, unsigned char alpha_threshold) {
+    m_heights.assign(width, NO_GROUND);
+    m_column_width = scale.x / width;
+    m_origin_x = position.x - 0.5f * scale.x;
+
+    float top = position.y + 0.5f * scale.y;
+    float row_height = scale.y / height;
+
+    for (int col = 0; col < width; col++) {
+        for (int row = 0; row < height; row++) {
+            if (rgba[(row * width + col) * 4 + 3] >= alpha_threshold) {
+                m_heights[col] = top - row * row_height;
+                break;
+            }
+        }
+    }
+}
+
+float Heightfield::get_max_height(float min_x, float max_x) const {
+    if (m_heights.empty()) return NO_GROUND;
+
+    int first = (int)std::floor((min_x - m_origin_x) / m_column_width);
+    int last = (int)std::floor((max_x - m_origin_x) / m_column_width);
+    if (last < 0 || first >= (int)m_heights.size()) return NO_GROUND;
+
+    first = std::max(first, 0);
+    last = std::min(last, (int)m_heights.size() - 1);
+
+    float highest = NO_GROUND;
+    for (int col = first; col <= last; col++) highest = std::max(highest, m_heights[col]);
+    return highest;
+}
+
+bool Heightfield::is_below_surface(glm::vec3 bottom_centre, float half_width) const {
+    return bottom_centre.y < get_max_height(bottom_centre.x - half_width, bottom_centre.x + half_width);
+}
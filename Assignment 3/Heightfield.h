@@ -0,0 +1,34 @@
+#pragma once
+
+#include <vector>
+#include "glm/glm.hpp"
+
+// Terrain surface as one height per column, built once from a sprite's alpha channel.
+// A query touches only the columns under the probe, so its cost depends on the probe's
+// width and not on how long the terrain is.
+class Heightfield {
+private:
+    std::vector<float> m_heights;   // World y of the highest solid pixel in each column
+    float m_origin_x = 0.0f;        // World x of the left edge of column 0
+    float m_column_width = 1.0f;
+
+public:
+    static constexpr float NO_GROUND = -1.0e30f;
+
+    // rgba is the sprite as stbi_load returns it (top row first), drawn centred on position
+    // at scale like Entity::render does. Pixels with alpha >= alpha_threshold are solid.
+    void build_from_alpha(const unsigned char* rgba, int width, int height,
+        glm::vec3 position, glm::vec3 scale, unsigned char alpha_threshold = 128);
+
+    // Adds columns to the right edge, e.g. for procedurally generated terrain
+    void append_column(float height) { m_heights.push_back(height); }
+
+    // Highest ground between min_x and max_x, or NO_GROUND if there is none
+    float get_max_height(float min_x, float max_x) const;
+    bool is_below_surface(glm::vec3 bottom_centre, float half_width) const;
+
+    bool is_empty() const { return m_heights.empty(); }
+    int get_column_count() const { return (int)m_heights.size(); }
+    float get_column_width() const { return m_column_width; }
+    float get_right_edge() const { return m_origin_x + m_column_width * m_heights.size(); }
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// ––––– INPUT RECORDING ––––– //
+// One entry each time the buttons seen by update_tick() change: the tick they changed on
+// and the new buttons. Queueing the entries for the same ticks reproduces a run exactly,
+// without a window or a clock.
+struct InputFrame {
+    std::uint32_t tick;
+    std::uint16_t buttons;
+};
+
+class InputLog {
+private:
+    std::vector<InputFrame> m_frames;
+    std::uint32_t m_end_tick = 0;
+    std::size_t m_cursor = 0;
+    std::string m_error;
+
+public:
+    // ————— RECORDING ————— //
+    void clear() { m_frames.clear(); m_end_tick = 0; m_cursor = 0; }
+    void record(std::uint32_t tick, std::uint16_t buttons);
+    void set_end_tick(std::uint32_t tick) { m_end_tick = tick; }
+
+    // ————— FILES ————— //
+    bool save(const char* filepath) const;
+    bool load(const char* filepath);    // On failure, get_error() says why
+    const std::string& get_error() const { return m_error; }
+
+    // ————— REPLAY ————— //
+    bool has_next() const { return m_cursor < m_frames.size(); }
+    const InputFrame& next() { return m_frames[m_cursor++]; }
+    void rewind() { m_cursor = 0; }
+
+    std::size_t get_frame_count() const { return m_frames.size(); }
+    std::uint32_t get_end_tick() const { return m_end_tick; }
+};
+
+// FNV-1a, used to fingerprint end states so two replays can be compared
+constexpr std::uint64_t STATE_HASH_SEED = 14695981039346656037ull;
+std::uint64_t hash_bytes(const void* data, std::size_t size, std::uint64_t hash = STATE_HASH_SEED);
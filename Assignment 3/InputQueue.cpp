@@ -0,0 +1,22 @@
+#include "InputQueue.h"
+
+bool InputQueue::push(const InputCommand& command) {
+    std::size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail - m_head.load(std::memory_order_acquire) == CAPACITY) return false;
+
+    m_commands[tail & (CAPACITY - 1)] = command;
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+bool InputQueue::pop_due(std::uint32_t tick, InputCommand& command) {
+    std::size_t head = m_head.load(std::memory_order_relaxed);
+    if (head == m_tail.load(std::memory_order_acquire)) return false;
+
+    const InputCommand& next = m_commands[head & (CAPACITY - 1)];
+    if (next.tick > tick) return false;
+
+    command = next;
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+}
@@ -0,0 +1,91 @@
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include "Integrator.h"
+
+void integrate(Integrator integrator, glm::vec3& position, glm::vec3& velocity,
+    AccelerationFunction acceleration, const void* context, float delta_time) {
+    integrate_vectors(integrator, position, velocity, [&](glm::vec3 at_position, glm::vec3 at_velocity) {
+        return acceleration(at_position, at_velocity, context);
+    }, delta_time);
+}
+
+bool parse_integrator(const char* name, Integrator& integrator) {
+    if (std::strcmp(name, "euler") == 0) integrator = SEMI_IMPLICIT_EULER;
+    else if (std::strcmp(name, "verlet") == 0) integrator = VELOCITY_VERLET;
+    else if (std::strcmp(name, "rk4") == 0) integrator = RK4;
+    else return false;
+    return true;
+}
+
+const char* get_integrator_name(Integrator integrator) {
+    switch (integrator) {
+    case VELOCITY_VERLET: return "verlet";
+    case RK4: return "rk4";
+    default: return "euler";
+    }
+}
+
+// ––––– BENCHMARK ––––– //
+constexpr double MOON_GRAVITY = -1.62;
+constexpr double UP_THRUST = 2.0;
+constexpr double DRAG = 0.5;                // Per second, only in the "drag" problem
+constexpr double SIMULATED_SECONDS = 4.0;
+constexpr int TIMING_REPEATS = 2000;
+
+struct BenchmarkProblem {
+    const char* name;
+    double drag;
+};
+
+static glm::vec3 lander_acceleration(glm::vec3 /*position*/, glm::vec3 velocity, const void* context) {
+    const BenchmarkProblem* problem = (const BenchmarkProblem*)context;
+    return glm::vec3(0.0f, (float)(MOON_GRAVITY + UP_THRUST), 0.0f) - velocity * (float)problem->drag;
+}
+
+// Closed-form height after time seconds, starting at rest from y = 0
+static double exact_height(const BenchmarkProblem& problem, double time) {
+    double acceleration = MOON_GRAVITY + UP_THRUST;
+    if (problem.drag == 0.0) return 0.5 * acceleration * time * time;
+
+    double terminal_velocity = acceleration / problem.drag;
+    return terminal_velocity * time - terminal_velocity * (1.0 - std::exp(-problem.drag * time)) / problem.drag;
+}
+
+void run_integrator_benchmark() {
+    const BenchmarkProblem problems[] = { { "thrust", 0.0 }, { "thrust_with_drag", DRAG } };
+    const Integrator integrators[] = { SEMI_IMPLICIT_EULER, VELOCITY_VERLET, RK4 };
+    const int steps_per_second[] = { 240, 120, 60, 30, 15, 8 };
+
+    std::printf("problem,integrator,steps_per_second,position_error,ns_per_step\n");
+
+    for (const BenchmarkProblem& problem : problems) {
+        for (Integrator integrator : integrators) {
+            for (int rate : steps_per_second) {
+                float delta_time = 1.0f / rate;
+                int steps = (int)(SIMULATED_SECONDS * rate);
+
+                glm::vec3 position(0.0f), velocity(0.0f);
+                for (int i = 0; i < steps; i++) {
+                    integrate(integrator, position, velocity, lander_acceleration, &problem, delta_time);
+                }
+                double error = std::fabs(position.y - exact_height(problem, steps * (double)delta_time));
+
+                auto start = std::chrono::steady_clock::now();
+                volatile float sink = 0.0f;
+                for (int repeat = 0; repeat < TIMING_REPEATS; repeat++) {
+                    glm::vec3 timed_position(0.0f), timed_velocity(0.0f);
+                    for (int i = 0; i < steps; i++) {
+                        integrate(integrator, timed_position, timed_velocity, lander_acceleration, &problem, delta_time);
+                    }
+                    sink = sink + timed_position.y;
+                }
+                double nanoseconds = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+                std::printf("%s,%s,%d,%.3e,%.1f\n", problem.name, get_integrator_name(integrator), rate, error,
+                    nanoseconds / ((double)steps * TIMING_REPEATS));
+            }
+        }
+    }
+}
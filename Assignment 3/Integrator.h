@@ -0,0 +1,65 @@
+#pragma once
+
+#include "glm/glm.hpp"
+
+// SEMI_IMPLICIT_EULER is what Entity::update has always done (velocity first, then
+// position with the new velocity). VELOCITY_VERLET is exact for constant forces like
+// the lander's; RK4 also stays accurate when forces depend on position or velocity.
+enum Integrator { SEMI_IMPLICIT_EULER, VELOCITY_VERLET, RK4 };
+
+// Acceleration at a given state. context is passed through untouched.
+typedef glm::vec3 (*AccelerationFunction)(glm::vec3 position, glm::vec3 velocity, const void* context);
+
+void integrate(Integrator integrator, glm::vec3& position, glm::vec3& velocity,
+    AccelerationFunction acceleration, const void* context, float delta_time);
+
+// The integrators for any Vector with +, += and * by a float, given an acceleration callable
+// taking (position, velocity). integrate() runs them on one glm::vec3; LanderBatch runs them on
+// four landers per SSE register. Both go through these same expressions, so a batch lane rounds
+// exactly as the game's rocket does.
+template <typename Vector, typename Acceleration>
+void integrate_vectors(Integrator integrator, Vector& position, Vector& velocity, Acceleration acceleration, float delta_time) {
+    switch (integrator) {
+    case SEMI_IMPLICIT_EULER:
+        velocity += acceleration(position, velocity) * delta_time;
+        position += velocity * delta_time;
+        break;
+
+    case VELOCITY_VERLET: {
+        Vector start_acceleration = acceleration(position, velocity);
+        position += velocity * delta_time + start_acceleration * (0.5f * delta_time * delta_time);
+
+        // Velocity-dependent forces are evaluated at a predicted end velocity
+        Vector end_acceleration = acceleration(position, velocity + start_acceleration * delta_time);
+        velocity += (start_acceleration + end_acceleration) * (0.5f * delta_time);
+        break;
+    }
+
+    case RK4: {
+        float half_step = 0.5f * delta_time;
+
+        Vector k1_velocity = velocity;
+        Vector k1_acceleration = acceleration(position, velocity);
+
+        Vector k2_velocity = velocity + k1_acceleration * half_step;
+        Vector k2_acceleration = acceleration(position + k1_velocity * half_step, k2_velocity);
+
+        Vector k3_velocity = velocity + k2_acceleration * half_step;
+        Vector k3_acceleration = acceleration(position + k2_velocity * half_step, k3_velocity);
+
+        Vector k4_velocity = velocity + k3_acceleration * delta_time;
+        Vector k4_acceleration = acceleration(position + k3_velocity * delta_time, k4_velocity);
+
+        position += (k1_velocity + (k2_velocity + k3_velocity) * 2.0f + k4_velocity) * (delta_time / 6.0f);
+        velocity += (k1_acceleration + (k2_acceleration + k3_acceleration) * 2.0f + k4_acceleration) * (delta_time / 6.0f);
+        break;
+    }
+    }
+}
+
+// Accepts "euler", "verlet" or "rk4"; returns false, leaving integrator as it was, for any other name
+bool parse_integrator(const char* name, Integrator& integrator);
+const char* get_integrator_name(Integrator integrator);
+
+// Prints a CSV of position error and cost per step for each integrator at several step sizes
+void run_integrator_benchmark();
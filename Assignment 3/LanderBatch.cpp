@@ -0,0 +1,249 @@
+#include <algorithm>
+#include "LanderBatch.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Below this many landers per thread, waking the workers costs more than it saves
+constexpr std::size_t MIN_LANDERS_PER_THREAD = 2048;
+constexpr std::size_t SIMD_WIDTH = 4;
+
+glm::vec3 get_lander_thrust(std::uint16_t buttons, float& fuel, float delta_time) {
+    glm::vec3 thrust(0.0f);
+
+    if ((buttons & LANDER_THRUST_LEFT) && fuel > 0) {
+        thrust.x = -LANDER_SIDE_THRUST;
+        fuel -= LANDER_FUEL_BURN * delta_time;
+    }
+    if ((buttons & LANDER_THRUST_RIGHT) && fuel > 0) {
+        thrust.x = LANDER_SIDE_THRUST;
+        fuel -= LANDER_FUEL_BURN * delta_time;
+    }
+    if ((buttons & LANDER_THRUST_UP) && fuel > 0) {
+        thrust.y = LANDER_UP_THRUST;
+        fuel -= LANDER_FUEL_BURN * delta_time;
+    }
+
+    return thrust;
+}
+
+#ifdef __SSE2__
+// The x and y of four landers, one per lane, with just the operations integrate_vectors uses
+struct LanderLanes {
+    __m128 x, y;
+};
+
+static inline LanderLanes operator+(LanderLanes a, LanderLanes b) {
+    return { _mm_add_ps(a.x, b.x), _mm_add_ps(a.y, b.y) };
+}
+
+static inline LanderLanes operator*(LanderLanes a, float scalar) {
+    __m128 lanes = _mm_set1_ps(scalar);
+    return { _mm_mul_ps(a.x, lanes), _mm_mul_ps(a.y, lanes) };
+}
+
+static inline LanderLanes& operator+=(LanderLanes& a, LanderLanes b) {
+    a = a + b;
+    return a;
+}
+#endif
+
+LanderBatch::LanderBatch(std::size_t count, const LanderBatchSettings& settings, unsigned thread_count)
+    : m_settings(settings), m_count(count),
+    m_position_x(count), m_position_y(count), m_velocity_x(count), m_velocity_y(count),
+    m_fuel(count), m_done(count)
+{
+    reset_all();
+
+    if (thread_count == 0) thread_count = std::max(1u, std::thread::hardware_concurrency());
+    thread_count = (unsigned)std::min<std::size_t>(thread_count, std::max<std::size_t>(1, count / MIN_LANDERS_PER_THREAD));
+
+    // The calling thread takes the first slice itself
+    for (unsigned i = 1; i < thread_count; i++) {
+        m_workers.emplace_back(&LanderBatch::worker_loop, this, (int)i);
+    }
+}
+
+LanderBatch::~LanderBatch() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_work_ready.notify_all();
+    for (std::thread& worker : m_workers) worker.join();
+}
+
+void LanderBatch::reset_all() {
+    for (std::size_t i = 0; i < m_count; i++) reset(i);
+}
+
+void LanderBatch::reset(std::size_t index) {
+    m_position_x[index] = m_settings.start_position.x;
+    m_position_y[index] = m_settings.start_position.y;
+    m_velocity_x[index] = 0.0f;
+    m_velocity_y[index] = 0.0f;
+    m_fuel[index] = m_settings.initial_fuel;
+    m_done[index] = 0;
+}
+
+void LanderBatch::step(const std::uint16_t* actions, float* observations, float* rewards, std::uint8_t* dones) {
+    m_actions = actions;
+    m_observations = observations;
+    m_rewards = rewards;
+    m_dones = dones;
+
+    if (m_workers.empty()) {
+        step_range(0, m_count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending_workers = (int)m_workers.size();
+        m_generation++;
+    }
+    m_work_ready.notify_all();
+
+    step_range(0, std::min(get_slice_size(), m_count));
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_work_finished.wait(lock, [this] { return m_pending_workers == 0; });
+}
+
+// Whole SIMD groups, so no two threads share a group
+std::size_t LanderBatch::get_slice_size() const {
+    return (m_count / (m_workers.size() + 1) + SIMD_WIDTH - 1) / SIMD_WIDTH * SIMD_WIDTH;
+}
+
+void LanderBatch::worker_loop(int worker_index) {
+    std::uint64_t seen_generation = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_work_ready.wait(lock, [&] { return m_stopping || m_generation != seen_generation; });
+            if (m_stopping) return;
+            seen_generation = m_generation;
+        }
+
+        std::size_t slice = get_slice_size();
+        std::size_t begin = std::min(slice * worker_index, m_count);
+        std::size_t end = worker_index == (int)m_workers.size() ? m_count : std::min(begin + slice, m_count);
+        step_range(begin, end);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_pending_workers--;
+        }
+        m_work_finished.notify_one();
+    }
+}
+
+// Runs the contact test on a lander's new state and scores it
+void LanderBatch::finish_lander(std::size_t index) {
+    glm::vec3 position(m_position_x[index], m_position_y[index], 0.0f);
+    glm::vec3 velocity(m_velocity_x[index], m_velocity_y[index], 0.0f);
+    LanderContact contact = m_settings.contact_test(position, velocity, m_settings.scale);
+
+    m_rewards[index] = contact == LANDER_LANDED ? 1.0f : (contact == LANDER_CRASHED ? -1.0f : 0.0f);
+    m_done[index] = contact != LANDER_AIRBORNE;
+}
+
+// One game tick for landers [begin, end). Finished landers keep their state and earn nothing.
+void LanderBatch::step_range(std::size_t begin, std::size_t end) {
+    const LanderBatchSettings& settings = m_settings;
+    float mass = settings.mass;
+    std::size_t i = begin;
+
+#ifdef __SSE2__
+    for (; i + SIMD_WIDTH <= end; i += SIMD_WIDTH) {
+        alignas(16) float thrust_x[SIMD_WIDTH], thrust_y[SIMD_WIDTH];
+        for (std::size_t lane = 0; lane < SIMD_WIDTH; lane++) {
+            glm::vec3 thrust(0.0f);
+            if (!m_done[i + lane]) thrust = get_lander_thrust(m_actions[i + lane], m_fuel[i + lane], settings.time_step);
+            thrust_x[lane] = thrust.x;
+            thrust_y[lane] = thrust.y;
+        }
+
+        // step_rocket's gravity and thrust, summed as Entity::add_force does and divided by mass as Entity::update does
+        LanderLanes force = { _mm_setzero_ps(), _mm_setzero_ps() };
+        force += LanderLanes{ _mm_setzero_ps(), _mm_set1_ps(LANDER_GRAVITY) } * mass;
+        force += LanderLanes{ _mm_load_ps(thrust_x), _mm_load_ps(thrust_y) } * mass;
+        __m128 mass_lanes = _mm_set1_ps(mass);
+        LanderLanes acceleration = { _mm_div_ps(force.x, mass_lanes), _mm_div_ps(force.y, mass_lanes) };
+
+        LanderLanes position = { _mm_loadu_ps(&m_position_x[i]), _mm_loadu_ps(&m_position_y[i]) };
+        LanderLanes velocity = { _mm_loadu_ps(&m_velocity_x[i]), _mm_loadu_ps(&m_velocity_y[i]) };
+        integrate_vectors(settings.integrator, position, velocity,
+            [&](LanderLanes, LanderLanes) { return acceleration; }, settings.time_step);
+
+        alignas(16) float position_x[SIMD_WIDTH], position_y[SIMD_WIDTH], velocity_x[SIMD_WIDTH], velocity_y[SIMD_WIDTH];
+        _mm_store_ps(position_x, position.x);
+        _mm_store_ps(position_y, position.y);
+        _mm_store_ps(velocity_x, velocity.x);
+        _mm_store_ps(velocity_y, velocity.y);
+
+        for (std::size_t lane = 0; lane < SIMD_WIDTH; lane++) {
+            std::size_t index = i + lane;
+            if (m_done[index]) {
+                m_rewards[index] = 0.0f;
+                continue;
+            }
+
+            m_position_x[index] = position_x[lane];
+            m_position_y[index] = position_y[lane];
+            m_velocity_x[index] = velocity_x[lane];
+            m_velocity_y[index] = velocity_y[lane];
+            finish_lander(index);
+        }
+    }
+#endif
+
+    // The same step one lander at a time, for the tail and builds without SSE2
+    for (; i < end; i++) {
+        if (m_done[i]) {
+            m_rewards[i] = 0.0f;
+            continue;
+        }
+
+        glm::vec3 thrust = get_lander_thrust(m_actions[i], m_fuel[i], settings.time_step);
+
+        glm::vec2 force(0.0f);
+        force += glm::vec2(0.0f, LANDER_GRAVITY) * mass;
+        force += glm::vec2(thrust.x, thrust.y) * mass;
+        glm::vec2 acceleration(force.x / mass, force.y / mass);
+
+        glm::vec2 position(m_position_x[i], m_position_y[i]);
+        glm::vec2 velocity(m_velocity_x[i], m_velocity_y[i]);
+        integrate_vectors(settings.integrator, position, velocity,
+            [&](glm::vec2, glm::vec2) { return acceleration; }, settings.time_step);
+
+        m_position_x[i] = position.x;
+        m_position_y[i] = position.y;
+        m_velocity_x[i] = velocity.x;
+        m_velocity_y[i] = velocity.y;
+        finish_lander(i);
+    }
+
+    for (i = begin; i < end; i++) {
+        float* observation = &m_observations[i * LANDER_OBSERVATION_SIZE];
+        observation[0] = m_position_x[i];
+        observation[1] = m_position_y[i];
+        observation[2] = m_velocity_x[i];
+        observation[3] = m_velocity_y[i];
+        observation[4] = m_fuel[i];
+        m_dones[i] = m_done[i];
+    }
+}
+
+void LanderBatch::observe(float* observations) const {
+    for (std::size_t i = 0; i < m_count; i++) {
+        float* observation = &observations[i * LANDER_OBSERVATION_SIZE];
+        observation[0] = m_position_x[i];
+        observation[1] = m_position_y[i];
+        observation[2] = m_velocity_x[i];
+        observation[3] = m_velocity_y[i];
+        observation[4] = m_fuel[i];
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "glm/glm.hpp"
+#include "Integrator.h"
+
+// ––––– LANDER RULES ––––– //
+// The game's apply_input() and step_rocket() use these too, so a batch lane flies exactly as
+// the rocket on screen does.
+constexpr std::uint16_t LANDER_THRUST_LEFT = 1 << 0,
+LANDER_THRUST_RIGHT = 1 << 1,
+LANDER_THRUST_UP = 1 << 2;
+
+constexpr float LANDER_GRAVITY = -0.001f;
+constexpr float LANDER_SIDE_THRUST = 0.1f;
+constexpr float LANDER_UP_THRUST = 0.2f;
+constexpr float LANDER_FUEL_BURN = 10.0f;  // Per thrusting key, per second
+
+// Thrust, as an acceleration, for the held buttons. Each key burns fuel while any is left;
+// right wins over left.
+glm::vec3 get_lander_thrust(std::uint16_t buttons, float& fuel, float delta_time);
+
+enum LanderContact { LANDER_AIRBORNE, LANDER_LANDED, LANDER_CRASHED };
+
+// Where a lander stands against the platform and the ground after a step. The batch calls it
+// from several threads at once, so it may only read shared state.
+typedef LanderContact (*LanderContactTest)(glm::vec3 position, glm::vec3 velocity, glm::vec3 scale);
+
+// x, y, horizontal speed, vertical speed, fuel
+constexpr int LANDER_OBSERVATION_SIZE = 5;
+
+struct LanderBatchSettings {
+    glm::vec3 start_position;
+    glm::vec3 scale;
+    float mass;
+    float initial_fuel;
+    float time_step;
+    Integrator integrator;
+    LanderContactTest contact_test;
+};
+
+// ––––– LANDER BATCH ––––– //
+// Steps many independent landers at once for evaluating controllers offline. A step is one
+// game tick: get_lander_thrust(), the gravity and thrust forces step_rocket() applies, summed
+// and divided by mass as Entity::update does, the selected integrator and the contact test.
+// State is one array per field, so each lane of an SSE register is a different lander, and
+// large batches are split across a pool of worker threads that lives as long as the batch.
+class LanderBatch {
+private:
+    LanderBatchSettings m_settings;
+    std::size_t m_count;
+
+    // ————— STATE (one entry per lander) ————— //
+    std::vector<float> m_position_x, m_position_y;
+    std::vector<float> m_velocity_x, m_velocity_y;
+    std::vector<float> m_fuel;
+    std::vector<std::uint8_t> m_done;   // Landed or crashed; frozen until reset
+
+    // ————— WORKERS ————— //
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_work_ready, m_work_finished;
+    std::uint64_t m_generation = 0;
+    int m_pending_workers = 0;
+    bool m_stopping = false;
+
+    const std::uint16_t* m_actions = nullptr;
+    float* m_observations = nullptr;
+    float* m_rewards = nullptr;
+    std::uint8_t* m_dones = nullptr;
+
+    std::size_t get_slice_size() const;
+    void step_range(std::size_t begin, std::size_t end);
+    void finish_lander(std::size_t index);
+    void worker_loop(int worker_index);
+
+public:
+    // thread_count of 0 uses every hardware thread
+    LanderBatch(std::size_t count, const LanderBatchSettings& settings, unsigned thread_count = 0);
+    ~LanderBatch();
+
+    LanderBatch(const LanderBatch&) = delete;
+    LanderBatch& operator=(const LanderBatch&) = delete;
+
+    void reset_all();
+    void reset(std::size_t index);
+
+    // actions: count button masks. observations: count * LANDER_OBSERVATION_SIZE entries.
+    // rewards (+1 landed, -1 crashed, else 0) and dones: count entries.
+    void step(const std::uint16_t* actions, float* observations, float* rewards, std::uint8_t* dones);
+    void observe(float* observations) const;
+
+    std::size_t get_count() const { return m_count; }
+    const LanderBatchSettings& get_settings() const { return m_settings; }
+};
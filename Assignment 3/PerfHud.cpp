@@ -0,0 +1,166 @@
+#include <SDL.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include "AllocTracker.h"
+#include "PerfHud.h"
+
+#ifndef GL_TIME_ELAPSED
+#define GL_TIME_ELAPSED 0x88BF
+#endif
+
+GlCallCounters g_gl_counters;
+
+// Timer queries are core only from GL 3.3, so they are looked up at runtime rather than linked
+typedef void (APIENTRY* GenQueriesFunction)(GLsizei, GLuint*);
+typedef void (APIENTRY* DeleteQueriesFunction)(GLsizei, const GLuint*);
+typedef void (APIENTRY* BeginQueryFunction)(GLenum, GLuint);
+typedef void (APIENTRY* EndQueryFunction)(GLenum);
+typedef void (APIENTRY* GetQueryObjectivFunction)(GLuint, GLenum, GLint*);
+typedef void (APIENTRY* GetQueryObjectui64vFunction)(GLuint, GLenum, GLuint64*);
+
+static GenQueriesFunction gen_queries = nullptr;
+static DeleteQueriesFunction delete_queries = nullptr;
+static BeginQueryFunction begin_query = nullptr;
+static EndQueryFunction end_query = nullptr;
+static GetQueryObjectivFunction get_query_objectiv = nullptr;
+static GetQueryObjectui64vFunction get_query_objectui64v = nullptr;
+
+static bool has_timer_queries() {
+    const char* version = (const char*)glGetString(GL_VERSION);
+    int major = 0, minor = 0;
+    if (version != nullptr && std::sscanf(version, "%d.%d", &major, &minor) == 2 &&
+        (major > 3 || (major == 3 && minor >= 3))) return true;
+
+    const char* extensions = (const char*)glGetString(GL_EXTENSIONS);
+    return extensions != nullptr &&
+        (std::strstr(extensions, "GL_ARB_timer_query") != nullptr || std::strstr(extensions, "GL_EXT_timer_query") != nullptr);
+}
+
+void PerfHud::initialise() {
+    m_frame_start = SDL_GetPerformanceCounter();
+    if (!has_timer_queries()) return;
+
+    gen_queries = (GenQueriesFunction)SDL_GL_GetProcAddress("glGenQueries");
+    delete_queries = (DeleteQueriesFunction)SDL_GL_GetProcAddress("glDeleteQueries");
+    begin_query = (BeginQueryFunction)SDL_GL_GetProcAddress("glBeginQuery");
+    end_query = (EndQueryFunction)SDL_GL_GetProcAddress("glEndQuery");
+    get_query_objectiv = (GetQueryObjectivFunction)SDL_GL_GetProcAddress("glGetQueryObjectiv");
+    get_query_objectui64v = (GetQueryObjectui64vFunction)SDL_GL_GetProcAddress("glGetQueryObjectui64v");
+    if (get_query_objectui64v == nullptr) {
+        get_query_objectui64v = (GetQueryObjectui64vFunction)SDL_GL_GetProcAddress("glGetQueryObjectui64vEXT");
+    }
+
+    m_gpu_timer_available = gen_queries && delete_queries && begin_query && end_query &&
+        get_query_objectiv && get_query_objectui64v;
+    if (m_gpu_timer_available) gen_queries(QUERY_COUNT, m_queries);
+}
+
+void PerfHud::shutdown() {
+    if (m_gpu_timer_available) delete_queries(QUERY_COUNT, m_queries);
+    m_gpu_timer_available = false;
+}
+
+void PerfHud::begin_frame() {
+    std::uint64_t now = SDL_GetPerformanceCounter();
+    m_frame_milliseconds[m_history_cursor] = (float)((now - m_frame_start) * 1000.0 / SDL_GetPerformanceFrequency());
+    m_history_cursor = (m_history_cursor + 1) % HISTORY_LENGTH;
+    m_history_count = std::min(m_history_count + 1, HISTORY_LENGTH);
+    m_frame_start = now;
+
+    g_gl_counters = GlCallCounters();
+
+    if (!m_gpu_timer_available) return;
+
+    collect_gpu_results();
+
+    // If the driver is still behind on this slot, skip timing this frame rather than wait
+    if (!m_query_pending[m_query_index]) {
+        begin_query(GL_TIME_ELAPSED, m_queries[m_query_index]);
+        m_query_active = true;
+    }
+}
+
+void PerfHud::end_frame() {
+    m_frame_counters = g_gl_counters;
+
+    if (!m_query_active) return;
+
+    end_query(GL_TIME_ELAPSED);
+    m_query_pending[m_query_index] = true;
+    m_query_index = (m_query_index + 1) % QUERY_COUNT;
+    m_query_active = false;
+}
+
+void PerfHud::collect_gpu_results() {
+    for (int i = 0; i < QUERY_COUNT; i++) {
+        if (!m_query_pending[i]) continue;
+
+        GLint available = 0;
+        get_query_objectiv(m_queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) continue;
+
+        GLuint64 nanoseconds = 0;
+        get_query_objectui64v(m_queries[i], GL_QUERY_RESULT, &nanoseconds);
+        m_gpu_milliseconds = (float)(nanoseconds / 1.0e6);
+        m_query_pending[i] = false;
+    }
+}
+
+float PerfHud::get_percentile(float fraction) const {
+    if (m_history_count == 0) return 0.0f;
+
+    std::vector<float> sorted(m_frame_milliseconds, m_frame_milliseconds + m_history_count);
+    int index = std::min(m_history_count - 1, (int)(fraction * m_history_count));
+    std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+    return sorted[index];
+}
+
+float PerfHud::get_last_frame_milliseconds() const {
+    if (m_history_count == 0) return 0.0f;
+    return m_frame_milliseconds[(m_history_cursor + HISTORY_LENGTH - 1) % HISTORY_LENGTH];
+}
+
+std::vector<std::string> PerfHud::get_text_lines() const {
+    char line[96];
+    std::vector<std::string> lines;
+
+    std::snprintf(line, sizeof(line), "FRAME %.1f MS  P50 %.1f  P99 %.1f",
+        get_last_frame_milliseconds(), get_percentile(0.5f), get_percentile(0.99f));
+    lines.push_back(line);
+
+    if (m_gpu_timer_available && m_gpu_milliseconds >= 0.0f) std::snprintf(line, sizeof(line), "GPU %.2f MS", m_gpu_milliseconds);
+    else std::snprintf(line, sizeof(line), "GPU N/A");
+    lines.push_back(line);
+
+    std::snprintf(line, sizeof(line), "DRAWS %d  TEXTURES %d", m_frame_counters.draw_calls, m_frame_counters.texture_binds);
+    lines.push_back(line);
+
+    std::snprintf(line, sizeof(line), "PROGRAMS %d  UNIFORMS %d", m_frame_counters.program_binds, m_frame_counters.uniform_uploads);
+    lines.push_back(line);
+
+#ifdef ENABLE_ALLOC_TRACKING
+    AllocationCounts allocations = alloc_tracker_get_last_frame();
+    std::snprintf(line, sizeof(line), "ALLOCS %llu  BYTES %llu", (unsigned long long)allocations.allocations, (unsigned long long)allocations.bytes);
+    lines.push_back(line);
+#endif
+
+    return lines;
+}
+
+std::vector<std::string> PerfHud::get_graph_rows(int columns, int rows) const {
+    std::vector<std::string> graph(rows, std::string(columns, ' '));
+
+    // Two 60 Hz frames tall, or taller if the slow frames would not fit
+    float scale_milliseconds = std::max(2.0f * 1000.0f / 60.0f, get_percentile(0.99f));
+    int shown = std::min(columns, m_history_count);
+
+    for (int i = 0; i < shown; i++) {
+        int column = columns - shown + i;
+        float milliseconds = m_frame_milliseconds[(m_history_cursor + HISTORY_LENGTH - shown + i) % HISTORY_LENGTH];
+        int height = std::min(rows, (int)(milliseconds / scale_milliseconds * rows + 0.5f));
+
+        for (int row = 0; row < height; row++) graph[rows - 1 - row][column] = '#';
+    }
+    return graph;
+}
@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <cmath>
+#include "glm/gtc/matrix_transform.hpp"
+#include "Framebuffer.h"
+#include "PerfHud.h"
+#include "Profiler.h"
+#include "StaticLayer.h"
+
+void StaticLayer::add(Entity* entity) {
+    glm::vec3 half_extent = 0.5f * glm::abs(entity->get_scale());
+    glm::vec3 low = entity->get_position() - half_extent;
+    glm::vec3 high = entity->get_position() + half_extent;
+
+    if (m_members.empty()) {
+        m_min = low;
+        m_max = high;
+    }
+    else {
+        m_min = glm::min(m_min, low);
+        m_max = glm::max(m_max, high);
+    }
+
+    m_members.push_back(entity);
+    m_is_dirty = true;
+}
+
+void StaticLayer::initialise(const glm::mat4& projection_matrix, int viewport_width, int viewport_height, glm::vec4 clear_color) {
+    m_projection_matrix = projection_matrix;
+    m_viewport_width = viewport_width;
+    m_viewport_height = viewport_height;
+    m_clear_color = clear_color;
+    if (m_members.empty()) return;
+
+    // An orthographic projection's scale is 2 / extent, so this is pixels per world unit
+    float pixels_per_unit_x = 0.5f * viewport_width * projection_matrix[0][0];
+    float pixels_per_unit_y = 0.5f * viewport_height * projection_matrix[1][1];
+    m_width = std::max(1, (int)std::ceil((m_max.x - m_min.x) * pixels_per_unit_x));
+    m_height = std::max(1, (int)std::ceil((m_max.y - m_min.y) * pixels_per_unit_y));
+
+    if (!load_framebuffer_functions()) return;
+
+    m_texture = create_target_texture(m_width, m_height);
+    traced_gen_framebuffer(&m_framebuffer);
+
+    traced_bind_framebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    traced_framebuffer_texture_2d(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_texture, 0);
+    m_is_cached = is_framebuffer_complete();
+    traced_bind_framebuffer(GL_FRAMEBUFFER, 0);
+
+    m_is_dirty = true;
+}
+
+void StaticLayer::redraw(CachedShaderProgram* program, const glm::mat4& view_matrix) {
+    PROFILE_SCOPE("StaticLayer::redraw");
+
+    traced_bind_framebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    traced_viewport(0, 0, m_width, m_height);
+    traced_set_projection_matrix(program, glm::ortho(m_min.x, m_max.x, m_min.y, m_max.y, -1.0f, 1.0f));
+    traced_set_view_matrix(program, glm::mat4(1.0f));
+
+    traced_clear_color(0.0f, 0.0f, 0.0f, 0.0f);
+    traced_clear(GL_COLOR_BUFFER_BIT);
+
+    // Colour goes in premultiplied and alpha accumulates as coverage, so compositing the texture
+    // with ONE, ONE_MINUS_SRC_ALPHA matches drawing the members straight onto the screen
+    traced_blend_func_separate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    for (Entity* member : m_members) member->render(program);
+
+    traced_bind_framebuffer(GL_FRAMEBUFFER, 0);
+    traced_viewport(0, 0, m_viewport_width, m_viewport_height);
+    traced_set_projection_matrix(program, m_projection_matrix);
+    traced_set_view_matrix(program, view_matrix);
+    traced_clear_color(m_clear_color.r, m_clear_color.g, m_clear_color.b, m_clear_color.a);
+    traced_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    m_is_dirty = false;
+}
+
+void StaticLayer::update(CachedShaderProgram* program, const glm::mat4& view_matrix) {
+    if (m_is_cached && m_is_dirty) redraw(program, view_matrix);
+}
+
+void StaticLayer::render(CachedShaderProgram* program) {
+    PROFILE_SCOPE("StaticLayer::render");
+    if (!m_is_cached) {
+        for (Entity* member : m_members) member->render(program);
+        return;
+    }
+
+    float vertices[] = {
+        m_min.x, m_min.y,
+        m_max.x, m_min.y,
+        m_max.x, m_max.y,
+        m_min.x, m_min.y,
+        m_max.x, m_max.y,
+        m_min.x, m_max.y
+    };
+
+    // Row 0 of a framebuffer's texture is the bottom of what was drawn
+    float tex_coords[] = {
+        0.0f, 0.0f,
+        1.0f, 0.0f,
+        1.0f, 1.0f,
+        0.0f, 0.0f,
+        1.0f, 1.0f,
+        0.0f, 1.0f
+    };
+
+    counted_set_model_matrix(program, glm::mat4(1.0f));
+    counted_bind_texture(GL_TEXTURE_2D, m_texture);
+
+    traced_vertex_attrib_pointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, vertices);
+    traced_enable_vertex_attrib_array(program->get_position_attribute());
+
+    traced_vertex_attrib_pointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, tex_coords);
+    traced_enable_vertex_attrib_array(program->get_tex_coordinate_attribute());
+
+    traced_blend_func(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    counted_draw_arrays(GL_TRIANGLES, 0, 6);
+    traced_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    traced_disable_vertex_attrib_array(program->get_position_attribute());
+    traced_disable_vertex_attrib_array(program->get_tex_coordinate_attribute());
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+#include "glm/mat4x4.hpp"
+#include "CachedShaderProgram.h"
+#include "Entity.h"
+
+// ––––– STATIC LAYERS ––––– //
+// Entities that never move (should_update = false), drawn once into a texture of their own and
+// then put on screen with one textured quad a frame instead of one draw per member. The texture
+// covers the members' bounds in world space at the window's pixel density, so the camera can
+// scroll without redrawing it. Anything that changes a member has to say so:
+//
+//     layer.add(g_game_state.mountain);
+//     layer.initialise(projection, viewport_width, viewport_height, clear_color);
+//     layer.update(&program, view);     // Every frame, before binding any other render target
+//     layer.render(&program);           // Then with the camera's view matrix set
+//     layer.mark_dirty();               // After moving or retexturing a member
+//
+// Where framebuffer objects are missing or incomplete, the members are drawn directly.
+class StaticLayer {
+private:
+    std::vector<Entity*> m_members;
+    glm::vec3 m_min = glm::vec3(0.0f), m_max = glm::vec3(0.0f);  // World bounds of the members' quads
+
+    // What the layer changes while drawing into its texture, and puts back afterwards
+    glm::mat4 m_projection_matrix = glm::mat4(1.0f);
+    int m_viewport_width = 0, m_viewport_height = 0;
+    glm::vec4 m_clear_color = glm::vec4(0.0f);
+
+    GLuint m_framebuffer = 0;
+    GLuint m_texture = 0;
+    int m_width = 0, m_height = 0;
+    bool m_is_cached = false;
+    bool m_is_dirty = true;
+
+    void redraw(CachedShaderProgram* program, const glm::mat4& view_matrix);
+
+public:
+    void add(Entity* entity);
+    void mark_dirty() { m_is_dirty = true; }
+
+    // Needs a current GL context; call after the members are added and placed
+    void initialise(const glm::mat4& projection_matrix, int viewport_width, int viewport_height, glm::vec4 clear_color);
+
+    // Redraws the texture if the layer is dirty. A redraw ends on the window's framebuffer and
+    // viewport, with view_matrix (the frame's own) put back.
+    void update(CachedShaderProgram* program, const glm::mat4& view_matrix);
+
+    // Leaves blending as the game sets it, SRC_ALPHA and ONE_MINUS_SRC_ALPHA
+    void render(CachedShaderProgram* program);
+
+    bool is_cached() const { return m_is_cached; }
+};
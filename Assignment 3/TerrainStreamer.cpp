@@ -0,0 +1,233 @@
+#include <algorithm>
+#include <cmath>
+#include "Heightfield.h"
+#include "TerrainStreamer.h"
+
+// ––––– TERRAIN HEIGHTS ––––– //
+constexpr std::int64_t RIDGE_SPACING = 24,  // Columns between the lattice points of each layer of noise
+BUMP_SPACING = 5;
+constexpr float RIDGE_HEIGHT = 2.2f,
+BUMP_HEIGHT = 0.4f,
+FOOTHILL_HEIGHT = 0.3f;
+constexpr std::int64_t EDGE_RAMP_COLUMNS = 16;  // Ground climbs out from the bottom of the screen next to chunk 0
+constexpr float TEXTURE_SCALE = 0.5f;           // Texture repeats per world unit
+
+static float hash_to_unit(std::int64_t value, std::uint64_t seed) {
+    // splitmix64 finaliser; the top 24 bits become a float in [0, 1)
+    std::uint64_t z = (std::uint64_t)value + seed * 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    z ^= z >> 31;
+    return (float)(z >> 40) / (float)(1 << 24);
+}
+
+static std::int64_t floor_divide(std::int64_t value, std::int64_t divisor) {
+    std::int64_t quotient = value / divisor;
+    return (value % divisor != 0 && value < 0) ? quotient - 1 : quotient;
+}
+
+// Smoothly interpolated values hashed at every spacing-th column
+static float value_noise(std::int64_t column, std::int64_t spacing, std::uint64_t seed) {
+    std::int64_t cell = floor_divide(column, spacing);
+    float t = (float)(column - cell * spacing) / (float)spacing;
+    t = t * t * (3.0f - 2.0f * t);
+
+    float left = hash_to_unit(cell, seed);
+    float right = hash_to_unit(cell + 1, seed);
+    return left + (right - left) * t;
+}
+
+int get_terrain_chunk(float x) {
+    return (int)std::floor(x / TERRAIN_CHUNK_WIDTH + 0.5f);
+}
+
+float get_terrain_column_height(std::int64_t column) {
+    // Chunk 0 keeps the hand-made level, so the original game plays out exactly as before
+    if (column >= 0 && column < TERRAIN_CHUNK_COLUMNS) return Heightfield::NO_GROUND;
+
+    std::int64_t distance = column < 0 ? -1 - column : column - TERRAIN_CHUNK_COLUMNS;
+    float ramp = std::min(1.0f, (float)(distance + 1) / (float)EDGE_RAMP_COLUMNS);
+
+    float height = FOOTHILL_HEIGHT + RIDGE_HEIGHT * value_noise(column, RIDGE_SPACING, 1) +
+        BUMP_HEIGHT * value_noise(column, BUMP_SPACING, 2);
+    return TERRAIN_BASE_Y + ramp * height;
+}
+
+static std::int64_t get_terrain_column(float x) {
+    return (std::int64_t)std::floor((x + 0.5f * TERRAIN_CHUNK_WIDTH) / TERRAIN_COLUMN_WIDTH);
+}
+
+float get_terrain_max_height(float min_x, float max_x) {
+    std::int64_t first = get_terrain_column(min_x);
+    std::int64_t last = get_terrain_column(max_x);
+
+    float highest = Heightfield::NO_GROUND;
+    for (std::int64_t column = first; column <= last; column++) {
+        highest = std::max(highest, get_terrain_column_height(column));
+    }
+    return highest;
+}
+
+bool is_below_terrain(glm::vec3 bottom_centre, float half_width) {
+    return bottom_centre.y < get_terrain_max_height(bottom_centre.x - half_width, bottom_centre.x + half_width);
+}
+
+void generate_terrain_chunk(TerrainChunk& chunk, int index) {
+    chunk.vertices.clear();
+    chunk.texture_coordinates.clear();
+    chunk.vertex_count = 0;
+
+    std::int64_t first_column = (std::int64_t)index * TERRAIN_CHUNK_COLUMNS;
+    float left = (index - 0.5f) * TERRAIN_CHUNK_WIDTH;
+
+    for (int i = 0; i < TERRAIN_CHUNK_COLUMNS; i++) {
+        float top = get_terrain_column_height(first_column + i);
+        if (top <= TERRAIN_BASE_Y) continue;
+
+        float x0 = left + i * TERRAIN_COLUMN_WIDTH;
+        float x1 = x0 + TERRAIN_COLUMN_WIDTH;
+        float bottom = TERRAIN_BASE_Y;
+
+        // Two triangles from the base of the screen up to the surface, wound like draw_text's
+        chunk.vertices.insert(chunk.vertices.end(), {
+            x0, top,
+            x0, bottom,
+            x1, top,
+            x1, bottom,
+            x1, top,
+            x0, bottom,
+            });
+
+        // World-space texture coordinates, so the rock lines up across columns and chunks
+        float u0 = x0 * TEXTURE_SCALE, u1 = x1 * TEXTURE_SCALE;
+        float v0 = -top * TEXTURE_SCALE, v1 = -bottom * TEXTURE_SCALE;
+        chunk.texture_coordinates.insert(chunk.texture_coordinates.end(), {
+            u0, v0,
+            u0, v1,
+            u1, v0,
+            u1, v1,
+            u1, v0,
+            u0, v1,
+            });
+
+        chunk.vertex_count += 6;
+    }
+}
+
+// ––––– TERRAIN STREAMER ––––– //
+TerrainStreamer::TerrainStreamer() {
+    for (TerrainChunk& chunk : m_chunks) {
+        chunk.vertices.reserve(TERRAIN_CHUNK_COLUMNS * 12);
+        chunk.texture_coordinates.reserve(TERRAIN_CHUNK_COLUMNS * 12);
+    }
+    m_requests.reserve(SLOT_COUNT);
+    m_finished.reserve(SLOT_COUNT);
+}
+
+void TerrainStreamer::start() {
+    if (m_worker.joinable()) return;
+
+    m_is_stopping = false;
+    m_worker = std::thread([this]() { run_worker(); });
+}
+
+void TerrainStreamer::stop() {
+    if (!m_worker.joinable()) return;
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_is_stopping = true;
+    }
+    m_has_requests.notify_one();
+    m_worker.join();
+
+    // Whatever the worker had not handed back is dropped; start() begins from an empty pool
+    m_requests.clear();
+    m_finished.clear();
+    for (SlotState& state : m_states) state = SLOT_FREE;
+}
+
+void TerrainStreamer::run_worker() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while (true) {
+        m_has_requests.wait(lock, [this]() { return m_is_stopping || !m_requests.empty(); });
+        if (m_is_stopping) return;
+
+        int slot = m_requests.front();
+        m_requests.erase(m_requests.begin());
+
+        // The slot belongs to this thread until it is handed back, so it is filled unlocked;
+        // its index was set before the request and is only read here
+        lock.unlock();
+        generate_terrain_chunk(m_chunks[slot], m_chunks[slot].index);
+        lock.lock();
+
+        m_finished.push_back(slot);
+    }
+}
+
+bool TerrainStreamer::is_wanted(int slot) const {
+    return std::abs(m_chunks[slot].index - m_centre_chunk) <= EVICT_RADIUS;
+}
+
+void TerrainStreamer::request_chunk(int index) {
+    for (int slot = 0; slot < SLOT_COUNT; slot++) {
+        if (m_states[slot] != SLOT_FREE) continue;
+
+        // Set before the worker can see the slot, and read by it only after the hand-over
+        m_chunks[slot].index = index;
+        m_states[slot] = SLOT_LOADING;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_requests.push_back(slot);
+        }
+        m_has_requests.notify_one();
+        return;
+    }
+    // The pool is full of chunks still loading; asked for again next frame
+}
+
+void TerrainStreamer::update(float camera_x) {
+    m_centre_chunk = get_terrain_chunk(camera_x);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (int slot : m_finished) {
+            m_states[slot] = is_wanted(slot) ? SLOT_READY : SLOT_FREE;
+            m_generated_chunks++;
+        }
+        m_finished.clear();
+    }
+
+    for (int slot = 0; slot < SLOT_COUNT; slot++) {
+        if (m_states[slot] == SLOT_READY && !is_wanted(slot)) {
+            m_states[slot] = SLOT_FREE;
+            m_evicted_chunks++;
+        }
+    }
+
+    for (int index = m_centre_chunk - LOAD_RADIUS; index <= m_centre_chunk + LOAD_RADIUS; index++) {
+        if (index == 0) continue;  // Drawn by the entities, with no generated ground
+
+        bool is_present = false;
+        for (int slot = 0; slot < SLOT_COUNT; slot++) {
+            if (m_states[slot] != SLOT_FREE && m_chunks[slot].index == index) is_present = true;
+        }
+        if (!is_present) request_chunk(index);
+    }
+}
+
+TerrainStreamStats TerrainStreamer::get_stats() const {
+    TerrainStreamStats stats;
+    for (int slot = 0; slot < SLOT_COUNT; slot++) {
+        if (m_states[slot] == SLOT_LOADING) stats.loading_chunks++;
+        if (m_states[slot] != SLOT_READY) continue;
+
+        stats.resident_chunks++;
+        stats.resident_bytes += (m_chunks[slot].vertices.size() + m_chunks[slot].texture_coordinates.size()) * sizeof(float);
+    }
+    stats.generated_chunks = m_generated_chunks;
+    stats.evicted_chunks = m_evicted_chunks;
+    return stats;
+}
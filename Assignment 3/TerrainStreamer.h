@@ -0,0 +1,117 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "glm/glm.hpp"
+
+// ––––– LUNAR TERRAIN ––––– //
+// The world beyond the starting screen, split into chunks one screen wide. Chunk 0 is the
+// screen the game has always had (the mountain sprite and the platform) and has no generated
+// ground; every other chunk is a ridge of columns whose heights are a pure function of their
+// position, so a chunk regenerated after eviction comes back identical.
+//
+// Collision reads those heights directly rather than from whatever chunks happen to be
+// resident, so the simulation never waits on, or depends on the timing of, the streamer.
+
+constexpr float TERRAIN_CHUNK_WIDTH = 10.0f;  // Matches the projection, so a chunk is one screen
+constexpr int TERRAIN_CHUNK_COLUMNS = 80;
+constexpr float TERRAIN_COLUMN_WIDTH = TERRAIN_CHUNK_WIDTH / TERRAIN_CHUNK_COLUMNS;
+constexpr float TERRAIN_BASE_Y = -3.75f;      // Bottom of the screen while the camera is at rest
+
+// Index of the chunk that holds x; chunk c covers [(c - 0.5) * width, (c + 0.5) * width)
+int get_terrain_chunk(float x);
+
+// Ground height of one column counted from the left edge of chunk 0, or Heightfield::NO_GROUND
+float get_terrain_column_height(std::int64_t column);
+
+// Highest generated ground between min_x and max_x; like a Heightfield query, the cost
+// depends on the probe's width, not on how far out it is
+float get_terrain_max_height(float min_x, float max_x);
+bool is_below_terrain(glm::vec3 bottom_centre, float half_width);
+
+// ––––– TERRAIN STREAMER ––––– //
+// Keeps the chunks around the camera resident, generating them on a worker thread. Chunks live
+// in a fixed pool of slots whose buffers are reserved up front and reused, so memory and the
+// per-frame cost stay the same however far the rocket flies:
+//
+//     streamer.start();
+//     streamer.update(camera_x);        // Every frame, before drawing
+//     streamer.for_each_visible(min_x, max_x, draw_chunk);
+//
+// A slot is either free, owned by the worker while it fills it, or ready. The main thread
+// never touches a slot the worker owns; a chunk that has scrolled out of range by the time it
+// is ready is freed then.
+struct TerrainChunk {
+    int index = 0;
+    std::vector<float> vertices;            // Two floats per vertex, six vertices per column
+    std::vector<float> texture_coordinates;
+    int vertex_count = 0;
+};
+
+struct TerrainStreamStats {
+    int resident_chunks = 0;
+    int loading_chunks = 0;
+    std::size_t resident_bytes = 0;
+    std::uint64_t generated_chunks = 0;
+    std::uint64_t evicted_chunks = 0;
+};
+
+class TerrainStreamer {
+private:
+    enum SlotState { SLOT_FREE, SLOT_LOADING, SLOT_READY };
+
+    static constexpr int LOAD_RADIUS = 2;   // Chunks each side of the camera's kept loaded; one is visible
+    static constexpr int EVICT_RADIUS = 3;  // Beyond this a chunk is dropped, so one at the edge does not churn
+    static constexpr int SLOT_COUNT = 2 * EVICT_RADIUS + 1;
+
+    TerrainChunk m_chunks[SLOT_COUNT];
+    SlotState m_states[SLOT_COUNT] = {};
+
+    // Slot indices passed between the threads; sized to the pool, so pushing never reallocates
+    std::vector<int> m_requests;
+    std::vector<int> m_finished;
+    std::mutex m_mutex;
+    std::condition_variable m_has_requests;
+    std::thread m_worker;
+    bool m_is_stopping = false;
+
+    int m_centre_chunk = 0;
+
+    std::uint64_t m_generated_chunks = 0;
+    std::uint64_t m_evicted_chunks = 0;
+
+    bool is_wanted(int slot) const;
+    void request_chunk(int index);
+    void run_worker();
+
+public:
+    TerrainStreamer();
+    ~TerrainStreamer() { stop(); }
+
+    void start();
+    void stop();
+
+    void update(float camera_x);
+
+    // Calls draw(chunk) for every ready chunk overlapping [min_x, max_x]
+    template <typename Draw>
+    void for_each_visible(float min_x, float max_x, Draw&& draw) const {
+        for (int slot = 0; slot < SLOT_COUNT; slot++) {
+            if (m_states[slot] != SLOT_READY) continue;
+
+            float left = (m_chunks[slot].index - 0.5f) * TERRAIN_CHUNK_WIDTH;
+            if (left > max_x || left + TERRAIN_CHUNK_WIDTH < min_x) continue;
+            draw(m_chunks[slot]);
+        }
+    }
+
+    TerrainStreamStats get_stats() const;
+};
+
+// Fills chunk's buffers with the columns of chunk index, leaving chunk.index to the caller;
+// safe to call from any thread
+void generate_terrain_chunk(TerrainChunk& chunk, int index);
@@ -22,10 +22,29 @@
 #include <SDL_opengl.h>
 #include "glm/mat4x4.hpp"
 #include "glm/gtc/matrix_transform.hpp"
-#include "ShaderProgram.h"
+#include "CachedShaderProgram.h"
 #include "stb_image.h"
 #include <vector>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include "AllocTracker.h"
+#include "DynamicResolution.h"
 #include "Entity.h"
+#include "FrameArena.h"
+#include "Heightfield.h"
+#include "InputLog.h"
+#include "LanderBatch.h"
+#include "PerfHud.h"
+#include "InputQueue.h"
+#include "Profiler.h"
+#include "Snapshot.h"
+#include "StaticLayer.h"
+#include "TerrainStreamer.h"
 
 // ––––– STRUCTS AND ENUMS ––––– //
 struct GameState {
@@ -35,6 +54,7 @@ struct GameState {
     int score;
     float altitude;
     float fuel;
+    glm::vec3 thrust;  // From the last input frame, applied as a force every tick
     float horizontal_speed;
     float vertical_speed;
 };
@@ -71,44 +91,128 @@ constexpr char EXPLOSION_FILEPATH[] = "Lunar_Landar_Explosion.png";
 constexpr int FONTBANK_SIZE_U = 16;
 constexpr int FONTBANK_SIZE_V = 7;
 
+constexpr float ROCKET_FOOTPRINT = 0.6f;  // Fraction of the rocket sprite's width that is hull, not transparent margin
+
+// Buttons sampled by process_input(), one bit each so a frame's input fits in an InputFrame.
+// They are the thrust bits get_lander_thrust() reads.
+constexpr Uint16 INPUT_LEFT = LANDER_THRUST_LEFT,
+INPUT_RIGHT = LANDER_THRUST_RIGHT,
+INPUT_UP = LANDER_THRUST_UP;
+
 
 // ––––– GLOBAL VARIABLES ––––– //
 GameState g_game_state;
 SDL_Window* g_display_window;
 AppStatus g_app_status = TERMINATED;
 
-ShaderProgram g_shader_program;
+CachedShaderProgram g_shader_program;
 glm::mat4 g_view_matrix, g_projection_matrix;
 
 float g_previous_ticks = 0.0f;
 float g_accumulator = 0.0f;
 float INITIAL_FUEL = 1000.0f;
+Uint32 g_tick = 0;  // Fixed-step ticks simulated so far
+
+// Sampled input waits here until the tick it is stamped for
+InputQueue g_input_queue;
+Uint16 g_held_buttons = 0;  // What the simulation sees held this tick
+Integrator g_integrator = SEMI_IMPLICIT_EULER;
+
+// Input recording and replay
+InputLog g_input_log;
+const char* g_record_filepath = nullptr;
+
+// F3 toggles the frame time and GL call overlay
+PerfHud g_perf_hud;
+const glm::vec3 HUD_ORIGIN(-4.8f, -1.6f, 0.0f);
+constexpr float HUD_FONT_SIZE = 0.2f,
+HUD_GRAPH_CELL_SIZE = 0.08f;
+constexpr int HUD_GRAPH_COLUMNS = 60,
+HUD_GRAPH_ROWS = 8;
+
+// Chrome trace of the profiler zones, written on F9 and at exit when built with ENABLE_PROFILER
+const char* g_profile_filepath = "profile.json";
+
+constexpr int GL_CAPTURE_FRAMES = 300;
+const char* g_gl_capture_filepath = nullptr;
+
+// F5 keeps a snapshot of the game (in g_state_filepath too, when given) and F8 goes back to it.
+// One is taken as the game starts, so F8 before any F5 restarts the game.
+constexpr float SNAPSHOT_POSITION_RANGE = 64.0f,  // Quantized snapshots cover +/- these
+SNAPSHOT_VELOCITY_RANGE = 64.0f,
+SNAPSHOT_ACCELERATION_RANGE = 1.0f;
+constexpr int SNAPSHOT_MAX_SCORE = 65535;
+SnapshotStream g_snapshot_stream;
+std::vector<std::uint8_t> g_quick_save;
+std::vector<std::uint8_t> g_state_backup;
+const char* g_state_filepath = nullptr;
 
 GLuint FONT_TEXTURE_ID;
+Heightfield g_terrain;
+
+// The camera follows the rocket across the streamed terrain; it only moves the view, so the
+// simulation and its replays know nothing of it
+TerrainStreamer g_terrain_streamer;
+glm::vec3 g_camera_position(0.0f);
+GLuint g_terrain_texture_id;
+
+// The mountain and platform never move, so they are drawn into a texture once and composited
+StaticLayer g_background_layer;
+constexpr float CAMERA_FOLLOW_HEIGHT = 3.0f,  // The view rises once the rocket climbs this far above its centre
+VIEW_HALF_WIDTH = 5.0f;
+constexpr int TERRAIN_TEXTURE_SIZE = 16;
+
+// --dynamic-resolution draws the scene at a lower resolution while frames run over budget
+DynamicResolution g_dynamic_resolution;
+ResolutionSettings g_resolution_settings;
+bool g_use_dynamic_resolution = false;
+float g_swap_milliseconds = 0.0f;  // Spent in the last SDL_GL_SwapWindow, mostly waiting for the display
+
+constexpr int TERRAIN_STREAM_TEST_FRAMES = 60000;
+constexpr float TERRAIN_STREAM_TEST_SPEED = 0.5f;  // World units per frame, far beyond what the rocket manages
 
 void initialise();
+void initialise_scene(GLuint rocket_texture_id, GLuint mountain_texture_id, GLuint platform_texture_id,
+    GLuint fire_texture_id, GLuint explosion_texture_id);
 void process_input();
+void apply_input(Uint16 buttons);
 void update();
+void update_tick();
+bool step_rocket(Entity* rocket, glm::vec3 thrust);
+LanderContact get_rocket_contact(glm::vec3 position, glm::vec3 velocity, glm::vec3 scale);
 void render();
+void render_perf_hud();
 void shutdown();
 GLuint load_texture(const char* filepath);
+GLuint create_terrain_texture();
+void update_camera();
+void draw_terrain_chunk(const TerrainChunk& chunk);
+void load_terrain(const char* filepath, const Entity* terrain_entity);
+void serialize_game_state(SnapshotStream& stream);
+void start_snapshots();
+void quick_save();
+void quick_load();
 
 
-void draw_text(ShaderProgram* shader_program, GLuint font_texture_id, std::string text,
+void draw_text(CachedShaderProgram* shader_program, GLuint font_texture_id, const char* text,
     float font_size, float spacing, glm::vec3 position)
 {
+    PROFILE_SCOPE("draw_text");
     // Scale the size of the fontbank in the UV-plane
     // We will use this for spacing and positioning
     float width = 1.0f / FONTBANK_SIZE_U;
     float height = 1.0f / FONTBANK_SIZE_V;
 
     // Instead of having a single pair of arrays, we'll have a series of pairs—one for
-    // each character. Don't forget to include <vector>!
-    std::vector<float> vertices;
-    std::vector<float> texture_coordinates;
+    // each character, taken from the frame arena rather than the heap.
+    int length = (int)std::strlen(text);
+    FrameVector<float> vertices;
+    FrameVector<float> texture_coordinates;
+    vertices.reserve(length * 12);
+    texture_coordinates.reserve(length * 12);
 
     // For every character...
-    for (int i = 0; i < text.size(); i++) {
+    for (int i = 0; i < length; i++) {
         // 1. Get their index in the spritesheet, as well as their offset (i.e. their
         //    position relative to the whole sentence)
         // int spritesheet_index = (int)text[i];  // ascii value of character
@@ -146,57 +250,77 @@ void draw_text(ShaderProgram* shader_program, GLuint font_texture_id, std::strin
     glm::mat4 model_matrix = glm::mat4(1.0f);
     model_matrix = glm::translate(model_matrix, position);
 
-    shader_program->set_model_matrix(model_matrix);
-    glUseProgram(shader_program->get_program_id());
+    counted_set_model_matrix(shader_program, model_matrix);
+    counted_use_program(shader_program->get_program_id());
 
-    glVertexAttribPointer(shader_program->get_position_attribute(), 2, GL_FLOAT, false, 0,
+    traced_vertex_attrib_pointer(shader_program->get_position_attribute(), 2, GL_FLOAT, false, 0,
         vertices.data());
-    glEnableVertexAttribArray(shader_program->get_position_attribute());
+    traced_enable_vertex_attrib_array(shader_program->get_position_attribute());
 
-    glVertexAttribPointer(shader_program->get_tex_coordinate_attribute(), 2, GL_FLOAT,
+    traced_vertex_attrib_pointer(shader_program->get_tex_coordinate_attribute(), 2, GL_FLOAT,
         false, 0, texture_coordinates.data());
-    glEnableVertexAttribArray(shader_program->get_tex_coordinate_attribute());
+    traced_enable_vertex_attrib_array(shader_program->get_tex_coordinate_attribute());
 
-    glBindTexture(GL_TEXTURE_2D, font_texture_id);
-    glDrawArrays(GL_TRIANGLES, 0, (int)(text.size() * 6));
+    counted_bind_texture(GL_TEXTURE_2D, font_texture_id);
+    counted_draw_arrays(GL_TRIANGLES, 0, length * 6);
 
-    glDisableVertexAttribArray(shader_program->get_position_attribute());
-    glDisableVertexAttribArray(shader_program->get_tex_coordinate_attribute());
+    traced_disable_vertex_attrib_array(shader_program->get_position_attribute());
+    traced_disable_vertex_attrib_array(shader_program->get_tex_coordinate_attribute());
 }
 
 
 GLuint load_texture(const char* filepath)
 {
-    int width, height, number_of_components;
-    unsigned char* image = stbi_load(filepath, &width, &height, &number_of_components,
-        STBI_rgb_alpha);
+    PROFILE_SCOPE("load_texture");
+    GLuint textureID = g_texture_residency.load(filepath);
 
-    if (image == NULL)
+    if (textureID == 0)
     {
         LOG("Unable to load image. Make sure the path is correct.");
         assert(false);
     }
 
-    GLuint textureID;
-    glGenTextures(1, &textureID);
+    return textureID;
+}
 
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0,
-        GL_RGBA, GL_UNSIGNED_BYTE, image);
+// A small grey speckle for the generated ground, made here rather than shipped as a file
+GLuint create_terrain_texture()
+{
+    unsigned char pixels[TERRAIN_TEXTURE_SIZE * TERRAIN_TEXTURE_SIZE * 4];
+    std::uint32_t seed = 0x2545F491u;
+    for (int i = 0; i < TERRAIN_TEXTURE_SIZE * TERRAIN_TEXTURE_SIZE; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        unsigned char shade = (unsigned char)(96 + (seed >> 26));
+        pixels[i * 4 + 0] = shade;
+        pixels[i * 4 + 1] = shade;
+        pixels[i * 4 + 2] = (unsigned char)(shade + 8);
+        pixels[i * 4 + 3] = 255;
+    }
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    return g_texture_residency.create(TERRAIN_TEXTURE_SIZE, TERRAIN_TEXTURE_SIZE, pixels);
+}
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+// Reads the sprite's alpha once so the rocket can collide with its outline; no GL needed
+void load_terrain(const char* filepath, const Entity* terrain_entity)
+{
+    int width, height, number_of_components;
+    unsigned char* image = stbi_load(filepath, &width, &height, &number_of_components,
+        STBI_rgb_alpha);
 
-    stbi_image_free(image);
+    if (image == NULL)
+    {
+        LOG("Unable to load terrain. Make sure the path is correct.");
+        return;
+    }
 
-    return textureID;
+    g_terrain.build_from_alpha(image, width, height, terrain_entity->get_position(), terrain_entity->get_scale());
+
+    stbi_image_free(image);
 }
 
 // Function definitions
 void initialise() {
+    PROFILE_SCOPE("initialise");
     SDL_Init(SDL_INIT_VIDEO);
     g_display_window = SDL_CreateWindow("Lunar Lander", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED, WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_OPENGL);
     SDL_GLContext context = SDL_GL_CreateContext(g_display_window);
@@ -204,61 +328,102 @@ void initialise() {
 #ifdef _WINDOWS
     glewInit();
 #endif
-    glViewport(VIEWPORT_X, VIEWPORT_Y, VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
-    g_shader_program.load(V_SHADER_PATH, F_SHADER_PATH);
+    traced_viewport(VIEWPORT_X, VIEWPORT_Y, VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
+    traced_load_program(&g_shader_program, V_SHADER_PATH, F_SHADER_PATH);
     g_view_matrix = glm::mat4(1.0f);
     g_projection_matrix = glm::ortho(-5.0f, 5.0f, -3.75f, 3.75f, -1.0f, 1.0f);
-    g_shader_program.set_projection_matrix(g_projection_matrix);
-    g_shader_program.set_view_matrix(g_view_matrix);
-    glUseProgram(g_shader_program.get_program_id());
-    glClearColor(BG_RED, BG_BLUE, BG_GREEN, BG_OPACITY);
+    traced_set_projection_matrix(&g_shader_program, g_projection_matrix);
+    traced_set_view_matrix(&g_shader_program, g_view_matrix);
+    counted_use_program(g_shader_program.get_program_id());
+    traced_clear_color(BG_RED, BG_BLUE, BG_GREEN, BG_OPACITY);
 
     GLuint rocket_texture_id = load_texture(ROCKET_FILEPATH);
     GLuint mountain_texture_id = load_texture(MOUNTAIN_FILEPATH);
     GLuint platform_texture_id = load_texture(PLATFORM_FILEPATH);
     GLuint fire_texture_id = load_texture(FIRE_FILEPATH);
+    GLuint explosion_texture_id = load_texture(EXPLOSION_FILEPATH);
     FONT_TEXTURE_ID = load_texture(FONTSHEET_FILEPATH);
+    g_terrain_texture_id = create_terrain_texture();
+
+    initialise_scene(rocket_texture_id, mountain_texture_id, platform_texture_id, fire_texture_id, explosion_texture_id);
+
+    traced_enable(GL_BLEND);
+    traced_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    g_background_layer.add(g_game_state.mountain);
+    g_background_layer.add(g_game_state.platform);
+    g_background_layer.initialise(g_projection_matrix, VIEWPORT_WIDTH, VIEWPORT_HEIGHT,
+        glm::vec4(BG_RED, BG_BLUE, BG_GREEN, BG_OPACITY));
+
+    g_perf_hud.initialise();
+    g_terrain_streamer.start();
+    if (g_use_dynamic_resolution) g_dynamic_resolution.initialise(VIEWPORT_WIDTH, VIEWPORT_HEIGHT, g_resolution_settings);
 
+    g_app_status = RUNNING;
+}
+
+// Everything the simulation needs, with no window or GL calls, so replays can run headless
+void initialise_scene(GLuint rocket_texture_id, GLuint mountain_texture_id, GLuint platform_texture_id,
+    GLuint fire_texture_id, GLuint explosion_texture_id) {
     // Initializing entities with positions within the viewport
     g_game_state.rocket = new Entity(rocket_texture_id, glm::vec3(0.0f, 3.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.5f, 0.5f, 1.0f), true, true);
     g_game_state.mountain = new Entity(mountain_texture_id, glm::vec3(0.0f, -3.0f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(2.0f, 1.5f, 1.0f), false, true); // Ensure active = true
     g_game_state.platform = new Entity(platform_texture_id, glm::vec3(0.0f, -2.5f, 0.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f, 0.2f, 1.0f), false, true);
 
     g_game_state.rocket->set_fire_texture(fire_texture_id);
-    GLuint explosion_texture_id = load_texture(EXPLOSION_FILEPATH);
     g_game_state.rocket->set_explosion_texture(explosion_texture_id);
 
+    // Static entities never update, so they are placed once here
+    g_game_state.mountain->update_model_matrix();
+    g_game_state.platform->update_model_matrix();
 
-    g_game_state.fuel = INITIAL_FUEL;
-
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    load_terrain(MOUNTAIN_FILEPATH, g_game_state.mountain);
 
-    g_app_status = RUNNING;
+    g_game_state.fuel = INITIAL_FUEL;
+    g_game_state.thrust = glm::vec3(0.0f);
+    g_game_state.rocket->set_integrator(g_integrator);
 }
 
 
 void process_input() {
-    const Uint8* keys = SDL_GetKeyboardState(NULL);
-    glm::vec3 acceleration(0.0f);
+    PROFILE_SCOPE("process_input");
 
-    if (keys[SDL_SCANCODE_LEFT] && g_game_state.fuel > 0) {
-        acceleration.x = -0.1f;
-        g_game_state.fuel -= 10.0f * FIXED_TIMESTEP;
-    }
-    if (keys[SDL_SCANCODE_RIGHT] && g_game_state.fuel > 0) {
-        acceleration.x = 0.1f;
-        g_game_state.fuel -= 10.0f * FIXED_TIMESTEP;
-    }
-    if (keys[SDL_SCANCODE_UP] && g_game_state.fuel > 0) {
-        acceleration.y = 0.2f;
-        g_game_state.fuel -= 10.0f * FIXED_TIMESTEP;
+    SDL_Event event;
+    while (SDL_PollEvent(&event)) {
+        if (event.type == SDL_QUIT || event.type == SDL_WINDOWEVENT_CLOSE) {
+            g_app_status = TERMINATED;
+        }
+        else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F3) {
+            g_perf_hud.toggle();
+        }
+        else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F9) {
+            if (PROFILE_WRITE_TRACE(g_profile_filepath)) LOG("Wrote profile to " << g_profile_filepath);
+        }
+        else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F5) {
+            quick_save();
+        }
+        else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F8) {
+            quick_load();
+        }
     }
 
-    g_game_state.rocket->set_acceleration(acceleration);
+    const Uint8* keys = SDL_GetKeyboardState(NULL);
+    Uint16 buttons = 0;
+
+    if (keys[SDL_SCANCODE_LEFT]) buttons |= INPUT_LEFT;
+    if (keys[SDL_SCANCODE_RIGHT]) buttons |= INPUT_RIGHT;
+    if (keys[SDL_SCANCODE_UP]) buttons |= INPUT_UP;
+
+    // Stamped for the next tick to run; if this frame runs no ticks, the next frame's sample supersedes it
+    g_input_queue.push({ g_tick, buttons });
+}
+
+void apply_input(Uint16 buttons) {
+    g_game_state.thrust = get_lander_thrust(buttons, g_game_state.fuel, FIXED_TIMESTEP);
 }
 
 void update() {
+    PROFILE_SCOPE("update");
     float ticks = (float)SDL_GetTicks() / MILLISECONDS_IN_SECOND;
     float delta_time = ticks - g_previous_ticks;
     g_previous_ticks = ticks;
@@ -270,53 +435,133 @@ void update() {
     }
 
     while (delta_time >= FIXED_TIMESTEP) {
-        glm::vec3 gravity(0.0f, -0.001f, 0.0f);
-        g_game_state.rocket->set_acceleration(g_game_state.rocket->get_acceleration() + gravity);
-        g_game_state.rocket->update(FIXED_TIMESTEP);
+        update_tick();
+        delta_time -= FIXED_TIMESTEP;
+    }
 
-        // Updating live stats based on the rocket's state
-        g_game_state.altitude = g_game_state.rocket->get_position().y;
-        g_game_state.horizontal_speed = g_game_state.rocket->get_velocity().x;
-        g_game_state.vertical_speed = g_game_state.rocket->get_velocity().y;
+    g_accumulator = delta_time;
+}
 
-        // Collision detection
-        float x_distance = fabs(g_game_state.rocket->get_position().x - g_game_state.platform->get_position().x);
-        float y_distance = fabs(g_game_state.rocket->get_position().y - g_game_state.platform->get_position().y);
+void update_tick() {
+    PROFILE_SCOPE("update_tick");
+    InputCommand command;
+    Uint16 previous_buttons = g_held_buttons;
+    while (g_input_queue.pop_due(g_tick, command)) g_held_buttons = command.buttons;
 
-        bool crashed = false;
+    // Only changes are logged; replay() holds each entry until the next one
+    if (g_record_filepath != nullptr && g_held_buttons != previous_buttons) g_input_log.record(g_tick, g_held_buttons);
 
-        if (x_distance < 0.5f && y_distance < 0.5f) {
-            // Checking if vertical speed is too high for a safe landing
-            if (fabs(g_game_state.vertical_speed) > 30.0f) {
-                crashed = true;
-            }
-        }
+    // Thrust and fuel burn are per tick, so they no longer scale with the frame rate
+    apply_input(g_held_buttons);
 
-        if (crashed) {
-            g_game_state.rocket->set_texture_id(g_game_state.rocket->get_explosion_texture_id());
-            LOG("CRASH! Rocket exploded.");
-            g_app_status = TERMINATED;  // End
-        }
+    bool crashed = step_rocket(g_game_state.rocket, g_game_state.thrust);
 
-        delta_time -= FIXED_TIMESTEP;
+    // Updating live stats based on the rocket's state
+    g_game_state.altitude = g_game_state.rocket->get_position().y;
+    g_game_state.horizontal_speed = g_game_state.rocket->get_velocity().x;
+    g_game_state.vertical_speed = g_game_state.rocket->get_velocity().y;
+
+    if (crashed) {
+        g_game_state.rocket->set_texture_id(g_game_state.rocket->get_explosion_texture_id());
+        LOG("CRASH! Rocket exploded.");
+        g_app_status = TERMINATED;  // End
     }
 
-    g_accumulator = delta_time;
+    g_tick++;
 }
 
-void render() {
-    glClear(GL_COLOR_BUFFER_BIT);
+// Moves a rocket one fixed step. Returns true if it hit the mountain, or the platform too fast.
+bool step_rocket(Entity* rocket, glm::vec3 thrust) {
+    // Forces are re-applied each tick rather than piling up in the acceleration
+    float mass = rocket->get_mass();
+    glm::vec3 gravity(0.0f, LANDER_GRAVITY, 0.0f);
+    rocket->add_force(gravity * mass);
+    rocket->add_force(thrust * mass);
+    rocket->update(FIXED_TIMESTEP);
+
+    return get_rocket_contact(rocket->get_position(), rocket->get_velocity(), rocket->get_scale()) == LANDER_CRASHED;
+}
+
+// Collision detection. Only reads the platform and terrain, so LanderBatch's threads can share it.
+LanderContact get_rocket_contact(glm::vec3 position, glm::vec3 velocity, glm::vec3 scale) {
+    float x_distance = fabs(position.x - g_game_state.platform->get_position().x);
+    float y_distance = fabs(position.y - g_game_state.platform->get_position().y);
+
+    if (x_distance < 0.5f && y_distance < 0.5f) {
+        // Checking if vertical speed is too high for a safe landing
+        return fabs(velocity.y) > 30.0f ? LANDER_CRASHED : LANDER_LANDED;
+    }
+
+    // Anywhere off the platform, touching the mountain or the ground beyond it is a crash
+    glm::vec3 rocket_bottom = position - glm::vec3(0.0f, 0.5f * scale.y, 0.0f);
+    float half_width = 0.5f * scale.x * ROCKET_FOOTPRINT;
+    bool crashed = g_terrain.is_below_surface(rocket_bottom, half_width) || is_below_terrain(rocket_bottom, half_width);
+    return crashed ? LANDER_CRASHED : LANDER_AIRBORNE;
+}
+
+// Centres the view on the rocket horizontally, and vertically only once it climbs high enough
+// that it would leave the top of the screen; the ground never scrolls up out of view
+void update_camera() {
+    glm::vec3 rocket_position = g_game_state.rocket->get_position();
+    g_camera_position.x = rocket_position.x;
+    g_camera_position.y = std::max(0.0f, rocket_position.y - CAMERA_FOLLOW_HEIGHT);
+
+    g_terrain_streamer.update(g_camera_position.x);
+}
+
+void draw_terrain_chunk(const TerrainChunk& chunk) {
+    counted_set_model_matrix(&g_shader_program, glm::mat4(1.0f));
+    counted_use_program(g_shader_program.get_program_id());
 
-    // Rendering game entities
-    g_game_state.mountain->render(&g_shader_program);
-    g_game_state.platform->render(&g_shader_program);
+    traced_vertex_attrib_pointer(g_shader_program.get_position_attribute(), 2, GL_FLOAT, false, 0,
+        chunk.vertices.data());
+    traced_enable_vertex_attrib_array(g_shader_program.get_position_attribute());
+
+    traced_vertex_attrib_pointer(g_shader_program.get_tex_coordinate_attribute(), 2, GL_FLOAT,
+        false, 0, chunk.texture_coordinates.data());
+    traced_enable_vertex_attrib_array(g_shader_program.get_tex_coordinate_attribute());
+
+    counted_bind_texture(GL_TEXTURE_2D, g_terrain_texture_id);
+    counted_draw_arrays(GL_TRIANGLES, 0, chunk.vertex_count);
+
+    traced_disable_vertex_attrib_array(g_shader_program.get_position_attribute());
+    traced_disable_vertex_attrib_array(g_shader_program.get_tex_coordinate_attribute());
+}
+
+void render() {
+    PROFILE_SCOPE("render");
+    g_perf_hud.begin_frame();
+
+    // Last frame's render time: the GPU's when the driver reports it, otherwise the whole frame
+    // less the time the swap spent waiting for the display
+    float work_milliseconds = g_perf_hud.get_gpu_milliseconds();
+    if (work_milliseconds < 0.0f) work_milliseconds = g_perf_hud.get_last_frame_milliseconds() - g_swap_milliseconds;
+    g_dynamic_resolution.add_frame(work_milliseconds);
+
+    update_camera();
+    g_view_matrix = glm::translate(glm::mat4(1.0f), -g_camera_position);
+    traced_set_view_matrix(&g_shader_program, g_view_matrix);
+
+    // Redrawing the background's cache has to happen outside the reduced resolution target
+    g_background_layer.update(&g_shader_program, g_view_matrix);
+    g_dynamic_resolution.begin();
+    traced_clear(GL_COLOR_BUFFER_BIT);
+
+    // Rendering the terrain in view, then game entities
+    g_terrain_streamer.for_each_visible(g_camera_position.x - VIEW_HALF_WIDTH, g_camera_position.x + VIEW_HALF_WIDTH,
+        [&](const TerrainChunk& chunk) { draw_terrain_chunk(chunk); });
+    g_background_layer.render(&g_shader_program);
     g_game_state.rocket->render(&g_shader_program);
 
-    // Converting values to strings
-    std::string altitude_text = "ALTITUDE: " + std::to_string(static_cast<int>(g_game_state.altitude));
-    std::string fuel_text = "FUEL: " + std::to_string(static_cast<int>(g_game_state.fuel));
-    std::string horizontal_speed_text = "HORIZONTAL SPEED: " + std::to_string(static_cast<int>(g_game_state.horizontal_speed));
-    std::string vertical_speed_text = "VERTICAL SPEED: " + std::to_string(static_cast<int>(g_game_state.vertical_speed));
+    // The text stays put on the screen while the world scrolls
+    traced_set_view_matrix(&g_shader_program, glm::mat4(1.0f));
+
+    // Formatting values into fixed buffers, so the HUD does not allocate every frame
+    char altitude_text[32], fuel_text[32], horizontal_speed_text[32], vertical_speed_text[32];
+    std::snprintf(altitude_text, sizeof(altitude_text), "ALTITUDE: %d", static_cast<int>(g_game_state.altitude));
+    std::snprintf(fuel_text, sizeof(fuel_text), "FUEL: %d", static_cast<int>(g_game_state.fuel));
+    std::snprintf(horizontal_speed_text, sizeof(horizontal_speed_text), "HORIZONTAL SPEED: %d", static_cast<int>(g_game_state.horizontal_speed));
+    std::snprintf(vertical_speed_text, sizeof(vertical_speed_text), "VERTICAL SPEED: %d", static_cast<int>(g_game_state.vertical_speed));
 
     // Rendering the text
     draw_text(&g_shader_program, FONT_TEXTURE_ID, altitude_text, 0.25f, 0.005f, glm::vec3(-4.5f, 3.0f, 0.0f));
@@ -324,28 +569,592 @@ void render() {
     draw_text(&g_shader_program, FONT_TEXTURE_ID, horizontal_speed_text, 0.25f, 0.005f, glm::vec3(0.0f, 3.0f, 0.0f));
     draw_text(&g_shader_program, FONT_TEXTURE_ID, vertical_speed_text, 0.25f, 0.005f, glm::vec3(0.0f, 2.5f, 0.0f));
 
-    SDL_GL_SwapWindow(g_display_window);
+    g_dynamic_resolution.end(&g_shader_program, g_projection_matrix, glm::mat4(1.0f));
+
+    // The overlay is drawn after the counters are read, so it does not count itself, and at
+    // full resolution
+    g_perf_hud.end_frame();
+    if (g_perf_hud.is_visible()) render_perf_hud();
+    g_texture_residency.end_frame();
+
+    {
+        PROFILE_SCOPE("SDL_GL_SwapWindow");
+        if (g_gl_capture.end_frame()) LOG("Wrote GL trace to " << g_gl_capture_filepath);
+        Uint64 swap_start = SDL_GetPerformanceCounter();
+        SDL_GL_SwapWindow(g_display_window);
+        g_swap_milliseconds = (float)((SDL_GetPerformanceCounter() - swap_start) * 1000.0 / SDL_GetPerformanceFrequency());
+    }
 }
 
 
+void render_perf_hud() {
+    ALLOC_EXEMPT_SCOPE();  // A debugging aid, so it is left out of the steady-state check
+    glm::vec3 position = HUD_ORIGIN;
+
+    for (const std::string& line : g_perf_hud.get_text_lines()) {
+        draw_text(&g_shader_program, FONT_TEXTURE_ID, line.c_str(), HUD_FONT_SIZE, 0.0f, position);
+        position.y -= HUD_FONT_SIZE;
+    }
+
+    TerrainStreamStats terrain = g_terrain_streamer.get_stats();
+    char terrain_text[64];
+    std::snprintf(terrain_text, sizeof(terrain_text), "TERRAIN %d CHUNKS %d LOADING %dKB",
+        terrain.resident_chunks, terrain.loading_chunks, (int)(terrain.resident_bytes / 1024));
+    draw_text(&g_shader_program, FONT_TEXTURE_ID, terrain_text, HUD_FONT_SIZE, 0.0f, position);
+    position.y -= HUD_FONT_SIZE;
+
+    TextureResidencyStats textures = g_texture_residency.get_stats();
+    char texture_text[96];
+    if (textures.budget_bytes == 0) {
+        std::snprintf(texture_text, sizeof(texture_text), "TEX %d RESIDENT %dKB",
+            textures.resident_textures, (int)(textures.resident_bytes / 1024));
+    }
+    else {
+        std::snprintf(texture_text, sizeof(texture_text), "TEX %d RESIDENT %dKB OF %dKB %d EVICTED %llu RELOADS",
+            textures.resident_textures, (int)(textures.resident_bytes / 1024), (int)(textures.budget_bytes / 1024),
+            textures.evicted_textures, (unsigned long long)textures.reloads);
+    }
+    draw_text(&g_shader_program, FONT_TEXTURE_ID, texture_text, HUD_FONT_SIZE, 0.0f, position);
+    position.y -= HUD_FONT_SIZE;
+
+    if (g_dynamic_resolution.is_enabled()) {
+        const ResolutionTelemetry& resolution = g_dynamic_resolution.get_controller().get_telemetry();
+        char resolution_text[64];
+        std::snprintf(resolution_text, sizeof(resolution_text), "RES %d%% %dX%d %.1f MS",
+            (int)std::lround(resolution.scale * 100.0f), g_dynamic_resolution.get_width(), g_dynamic_resolution.get_height(),
+            resolution.smoothed_milliseconds);
+        draw_text(&g_shader_program, FONT_TEXTURE_ID, resolution_text, HUD_FONT_SIZE, 0.0f, position);
+        position.y -= HUD_FONT_SIZE;
+    }
+
+    for (const std::string& row : g_perf_hud.get_graph_rows(HUD_GRAPH_COLUMNS, HUD_GRAPH_ROWS)) {
+        draw_text(&g_shader_program, FONT_TEXTURE_ID, row.c_str(), HUD_GRAPH_CELL_SIZE, 0.0f, position);
+        position.y -= HUD_GRAPH_CELL_SIZE;
+    }
+}
+
 void shutdown()
 {
+    g_terrain_streamer.stop();
+    g_gl_capture.finish();
+
+    if (g_dynamic_resolution.is_enabled()) {
+        const ResolutionController& controller = g_dynamic_resolution.get_controller();
+        const ResolutionTelemetry& telemetry = controller.get_telemetry();
+        if (telemetry.frames > 0) {
+            LOG("Dynamic resolution: average scale " << telemetry.scale_total / telemetry.frames
+                << ", " << telemetry.scale_downs << " down and " << telemetry.scale_ups << " up, "
+                << 100.0 * telemetry.frames_over_budget / telemetry.frames << "% of " << telemetry.frames
+                << " frames over " << controller.get_settings().target_milliseconds << " ms");
+        }
+    }
+
+    g_perf_hud.shutdown();
+    g_texture_residency.shutdown();
     SDL_Quit();
 
+    if (g_record_filepath != nullptr) {
+        g_input_log.set_end_tick(g_tick);
+        if (!g_input_log.save(g_record_filepath)) LOG("Unable to save input recording to " << g_record_filepath);
+    }
+
+    PROFILE_WRITE_TRACE(g_profile_filepath);
+    ALLOC_WRITE_REPORT(stderr);
+
     delete g_game_state.rocket;
     delete g_game_state.mountain;
     delete g_game_state.platform;
 }
 
+// Fingerprint of everything the simulation touches, compared across replays
+std::uint64_t hash_game_state() {
+    glm::vec3 position = g_game_state.rocket->get_position();
+    glm::vec3 velocity = g_game_state.rocket->get_velocity();
+    glm::vec3 acceleration = g_game_state.rocket->get_acceleration();
+
+    std::uint64_t hash = hash_bytes(&g_tick, sizeof(g_tick));
+    hash = hash_bytes(&position, sizeof(position), hash);
+    hash = hash_bytes(&velocity, sizeof(velocity), hash);
+    hash = hash_bytes(&acceleration, sizeof(acceleration), hash);
+    hash = hash_bytes(&g_game_state.fuel, sizeof(g_game_state.fuel), hash);
+    hash = hash_bytes(&g_app_status, sizeof(g_app_status), hash);
+    return hash;
+}
+
+// ––––– SNAPSHOTS ––––– //
+// Everything one tick hands on to the next. The altitude and speeds shown on screen are worked
+// out from the rocket again on reading, and its model matrix is rebuilt, so the restored state
+// renders as is.
+void serialize_game_state(SnapshotStream& stream) {
+    PROFILE_SCOPE("serialize_game_state");
+    Entity* rocket = g_game_state.rocket;
+    std::uint32_t tick = g_tick, held_buttons = g_held_buttons;
+    glm::vec3 position = rocket->get_position();
+    glm::vec3 velocity = rocket->get_velocity();
+    glm::vec3 acceleration = rocket->get_acceleration();
+
+    stream.serialize_bits(tick, 32);
+    stream.serialize_bits(held_buttons, 16);
+    stream.serialize_int(g_game_state.score, 0, SNAPSHOT_MAX_SCORE);
+    stream.serialize_float(g_game_state.fuel, 0.0f, INITIAL_FUEL, 16);
+    stream.serialize_float(g_game_state.thrust.x, -SNAPSHOT_ACCELERATION_RANGE, SNAPSHOT_ACCELERATION_RANGE, 12);
+    stream.serialize_float(g_game_state.thrust.y, -SNAPSHOT_ACCELERATION_RANGE, SNAPSHOT_ACCELERATION_RANGE, 12);
+
+    stream.serialize_float(position.x, -SNAPSHOT_POSITION_RANGE, SNAPSHOT_POSITION_RANGE, 20);
+    stream.serialize_float(position.y, -SNAPSHOT_POSITION_RANGE, SNAPSHOT_POSITION_RANGE, 20);
+    stream.serialize_float(velocity.x, -SNAPSHOT_VELOCITY_RANGE, SNAPSHOT_VELOCITY_RANGE, 16);
+    stream.serialize_float(velocity.y, -SNAPSHOT_VELOCITY_RANGE, SNAPSHOT_VELOCITY_RANGE, 16);
+    stream.serialize_float(acceleration.x, -SNAPSHOT_ACCELERATION_RANGE, SNAPSHOT_ACCELERATION_RANGE, 12);
+    stream.serialize_float(acceleration.y, -SNAPSHOT_ACCELERATION_RANGE, SNAPSHOT_ACCELERATION_RANGE, 12);
+
+    if (!stream.is_reading()) return;
+
+    g_tick = tick;
+    g_held_buttons = (Uint16)held_buttons;
+    rocket->set_position(position);
+    rocket->set_velocity(velocity);
+    rocket->set_acceleration(acceleration);
+    rocket->update_model_matrix();
+
+    g_game_state.altitude = position.y;
+    g_game_state.horizontal_speed = velocity.x;
+    g_game_state.vertical_speed = velocity.y;
+}
+
+void capture_state(std::vector<std::uint8_t>& bytes) {
+    g_snapshot_stream.begin_write(SNAPSHOT_LOSSLESS);
+    serialize_game_state(g_snapshot_stream);
+    bytes.assign(g_snapshot_stream.get_data(), g_snapshot_stream.get_data() + g_snapshot_stream.get_size());
+}
+
+// A snapshot that cannot be read, say from an older build's file, leaves the game as it was
+bool restore_state(const std::vector<std::uint8_t>& bytes) {
+    capture_state(g_state_backup);
+
+    g_snapshot_stream.begin_read(bytes.data(), bytes.size(), SNAPSHOT_LOSSLESS);
+    serialize_game_state(g_snapshot_stream);
+    if (g_snapshot_stream.has_error()) {
+        g_snapshot_stream.begin_read(g_state_backup.data(), g_state_backup.size(), SNAPSHOT_LOSSLESS);
+        serialize_game_state(g_snapshot_stream);
+        return false;
+    }
+
+    // Commands stamped for the old timeline would otherwise hold up the queue
+    g_input_queue.clear();
+    return true;
+}
+
+// Resumes from g_state_filepath if it holds a snapshot, then keeps the state for F8
+void start_snapshots() {
+    std::vector<std::uint8_t> saved;
+    if (g_state_filepath != nullptr && load_snapshot_file(g_state_filepath, saved)) {
+        if (g_record_filepath != nullptr) LOG("Not resuming from " << g_state_filepath << ", recordings start from a new game");
+        else if (restore_state(saved)) LOG("Resumed from " << g_state_filepath << " at tick " << g_tick);
+        else LOG("Unable to read the state in " << g_state_filepath);
+    }
+    capture_state(g_quick_save);
+}
+
+void quick_save() {
+    capture_state(g_quick_save);
+    if (g_state_filepath != nullptr && !save_snapshot_file(g_state_filepath, g_snapshot_stream)) {
+        LOG("Unable to save state to " << g_state_filepath);
+    }
+}
+
+void quick_load() {
+    // A recording has to run forwards from the start to replay
+    if (g_record_filepath != nullptr) {
+        LOG("Quick load is off while recording");
+        return;
+    }
+    if (!restore_state(g_quick_save)) return;
+
+    g_previous_ticks = (float)SDL_GetTicks() / MILLISECONDS_IN_SECOND;
+    g_accumulator = 0.0f;
+}
+
+// Size and cost of snapshots over a replay, gathered by --snapshot-check
+struct SnapshotCheck {
+    SnapshotStream stream;
+    SnapshotFields baseline, quantized_baseline;
+    std::vector<std::uint8_t> delta;
+
+    std::uint64_t ticks = 0;
+    std::uint64_t full_bytes = 0, delta_bytes = 0;
+    std::uint64_t quantized_bytes = 0, quantized_delta_bytes = 0;
+    double encode_seconds = 0.0, restore_seconds = 0.0;
+};
+
+// Encodes the state in full and as a delta against the last tick, both lossless and quantized,
+// then restores the lossless delta over the live state. Anything the snapshot misses or gets
+// wrong then shows up as a different end state for the replay.
+void check_snapshot_round_trip(SnapshotCheck& check) {
+    SnapshotStream& stream = check.stream;
+
+    stream.begin_write(SNAPSHOT_QUANTIZED);
+    serialize_game_state(stream);
+    check.quantized_bytes += stream.get_size();
+
+    stream.begin_write(SNAPSHOT_QUANTIZED, &check.quantized_baseline);
+    serialize_game_state(stream);
+    check.quantized_delta_bytes += stream.get_size();
+    check.quantized_baseline = stream.get_fields();
+
+    stream.begin_write(SNAPSHOT_LOSSLESS);
+    serialize_game_state(stream);
+    check.full_bytes += stream.get_size();
+
+    auto encode_start = std::chrono::steady_clock::now();
+    stream.begin_write(SNAPSHOT_LOSSLESS, &check.baseline);
+    serialize_game_state(stream);
+    check.encode_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - encode_start).count();
+
+    check.delta.assign(stream.get_data(), stream.get_data() + stream.get_size());
+    check.delta_bytes += check.delta.size();
+
+    auto restore_start = std::chrono::steady_clock::now();
+    stream.begin_read(check.delta.data(), check.delta.size(), SNAPSHOT_LOSSLESS, &check.baseline);
+    serialize_game_state(stream);
+    check.restore_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - restore_start).count();
+
+    if (stream.has_error()) LOG("Snapshot failed to read back at tick " << g_tick);
+    check.baseline = stream.get_fields();
+    check.ticks++;
+}
+
+void log_snapshot_check(const SnapshotCheck& check) {
+    if (check.ticks == 0) return;
+
+    double ticks = (double)check.ticks;
+    std::printf("Snapshots per tick: %.1f bytes full, %.1f delta, quantized %.1f full, %.1f delta; "
+        "encode %.2f us, restore %.2f us\n",
+        check.full_bytes / ticks, check.delta_bytes / ticks,
+        check.quantized_bytes / ticks, check.quantized_delta_bytes / ticks,
+        check.encode_seconds / ticks * 1e6, check.restore_seconds / ticks * 1e6);
+}
+
+// Runs a recorded session headless and as fast as possible. Returns non-zero if the
+// end state does not match expected_hash (when one is given). With check_snapshots, every
+// tick's state also goes through a snapshot and back.
+int replay(const char* filepath, const char* expected_hash, bool check_snapshots) {
+    if (!g_input_log.load(filepath)) {
+        LOG("Unable to load input recording " << filepath << ": " << g_input_log.get_error());
+        return 1;
+    }
+
+    initialise_scene(0, 0, 0, 0, 0);
+    g_app_status = RUNNING;
+
+    SnapshotCheck check;
+    auto run_tick = [&]() {
+        update_tick();
+        if (check_snapshots) check_snapshot_round_trip(check);
+    };
+
+    while (g_input_log.has_next()) {
+        ALLOC_FRAME_BEGIN();
+        g_frame_arena.reset();
+
+        const InputFrame& frame = g_input_log.next();
+        while (g_tick < frame.tick) run_tick();
+        g_input_queue.push({ frame.tick, frame.buttons });
+
+        ALLOC_FRAME_END();
+    }
+    while (g_tick < g_input_log.get_end_tick()) run_tick();
+
+    std::uint64_t hash = hash_game_state();
+    LOG("Replayed " << g_input_log.get_frame_count() << " frames, " << g_tick << " ticks, end state " << std::hex << hash << std::dec);
+    log_snapshot_check(check);
+    PROFILE_WRITE_TRACE(g_profile_filepath);
+    ALLOC_WRITE_REPORT(stderr);
+
+    delete g_game_state.rocket;
+    delete g_game_state.mountain;
+    delete g_game_state.platform;
+
+    if (expected_hash != nullptr && std::strtoull(expected_hash, nullptr, 16) != hash) {
+        LOG("End state does not match " << expected_hash);
+        return 1;
+    }
+    return 0;
+}
+
+// ––––– STRESS TEST ––––– //
+const int STRESS_COUNTS[] = { 10, 100, 1000, 10000, 100000 };
+constexpr int STRESS_TICKS = 120;
+
+// Flies count rockets through the game's own step for the given number of ticks at each
+// size in STRESS_COUNTS, and prints update and render time per tick as CSV. Rockets pulse
+// their main engine out of phase and restart from the top when they crash, so the work per
+// tick stays flat. Headless runs leave the render column empty.
+int run_stress_test(bool windowed, int ticks) {
+    if (windowed) {
+        initialise();
+        SDL_GL_SetSwapInterval(0);  // Time the work, not the display's refresh
+    }
+    else {
+        initialise_scene(0, 0, 0, 0, 0);
+    }
+
+    std::printf("scene,entities,ticks,update_us_per_tick,render_us_per_tick\n");
+
+    for (int count : STRESS_COUNTS) {
+        std::vector<Entity> rockets;
+        std::vector<glm::vec3> starts;
+        for (int i = 0; i < count; i++) {
+            glm::vec3 start(-4.5f + 9.0f * std::fmod(i * 0.618034f, 1.0f), 1.0f + 2.5f * std::fmod(i * 0.754878f, 1.0f), 0.0f);
+            starts.push_back(start);
+
+            rockets.emplace_back(g_game_state.rocket->get_texture_id(), start, glm::vec3(0.0f), g_game_state.rocket->get_scale());
+            rockets.back().set_fire_texture(g_game_state.rocket->get_fire_texture_id());
+            rockets.back().set_integrator(g_integrator);
+        }
+
+        double update_seconds = 0.0, render_seconds = 0.0;
+        for (int tick = 0; tick < ticks; tick++) {
+            auto update_start = std::chrono::steady_clock::now();
+            for (int i = 0; i < count; i++) {
+                glm::vec3 thrust(0.0f, (tick + i * 7) % 60 < 25 ? 0.2f : 0.0f, 0.0f);
+                if (step_rocket(&rockets[i], thrust)) {
+                    rockets[i].set_position(starts[i]);
+                    rockets[i].set_velocity(glm::vec3(0.0f));
+                }
+            }
+            update_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - update_start).count();
+
+            if (!windowed) continue;
+
+            auto render_start = std::chrono::steady_clock::now();
+            traced_clear(GL_COLOR_BUFFER_BIT);
+            g_game_state.mountain->render(&g_shader_program);
+            g_game_state.platform->render(&g_shader_program);
+            for (Entity& rocket : rockets) rocket.render(&g_shader_program);
+            SDL_GL_SwapWindow(g_display_window);
+            render_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - render_start).count();
+        }
+
+        if (windowed) std::printf("landers,%d,%d,%.2f,%.2f\n", count, ticks, update_seconds * 1.0e6 / ticks, render_seconds * 1.0e6 / ticks);
+        else std::printf("landers,%d,%d,%.2f,\n", count, ticks, update_seconds * 1.0e6 / ticks);
+        std::fflush(stdout);
+    }
+
+    if (windowed) shutdown();
+    return 0;
+}
+
+// ––––– LANDER BATCH CHECK ––––– //
+constexpr int LANDER_BATCH_CHECK_COUNT = 10003;  // Not a multiple of four, so the scalar tail runs too
+constexpr int LANDER_BATCH_CHECK_TICKS = 600;
+const int LANDER_BATCH_CHECK_LANES[] = { 0, 1, 6, 5001, 10002 };  // SIMD lanes in different threads' slices, and the tail
+
+// Engine bursts that differ from lander to lander, so the batch covers many trajectories
+Uint16 get_lander_check_buttons(int lander, int tick) {
+    Uint16 buttons = 0;
+    if ((tick + lander * 7) % 60 < 25) buttons |= INPUT_UP;
+    if ((tick / 30 + lander) % 3 == 1) buttons |= INPUT_LEFT;
+    if ((tick / 45 + lander) % 4 == 2) buttons |= INPUT_RIGHT;
+    return buttons;
+}
+
+// Flies a LanderBatch with each integrator next to copies of the game's rocket stepped through
+// get_lander_thrust() and step_rocket(), as update_tick() does. Fails unless the sampled lanes
+// match those rockets bit for bit on every tick. Prints the batch's cost per lander step as CSV.
+int run_lander_batch_check() {
+    initialise_scene(0, 0, 0, 0, 0);
+    const Integrator integrators[] = { SEMI_IMPLICIT_EULER, VELOCITY_VERLET, RK4 };
+    const int lane_count = sizeof(LANDER_BATCH_CHECK_LANES) / sizeof(LANDER_BATCH_CHECK_LANES[0]);
+    int total_mismatches = 0;
+
+    std::printf("integrator,landers,ticks,mismatched_lane_ticks,ns_per_lander_step\n");
+
+    for (Integrator integrator : integrators) {
+        const Entity& game_rocket = *g_game_state.rocket;
+        LanderBatchSettings settings = { game_rocket.get_position(), game_rocket.get_scale(), game_rocket.get_mass(),
+            INITIAL_FUEL, FIXED_TIMESTEP, integrator, get_rocket_contact };
+        LanderBatch batch(LANDER_BATCH_CHECK_COUNT, settings);
+
+        std::vector<std::uint16_t> actions(LANDER_BATCH_CHECK_COUNT);
+        std::vector<float> observations(LANDER_BATCH_CHECK_COUNT * LANDER_OBSERVATION_SIZE);
+        std::vector<float> rewards(LANDER_BATCH_CHECK_COUNT);
+        std::vector<std::uint8_t> dones(LANDER_BATCH_CHECK_COUNT);
+
+        std::vector<Entity> rockets(lane_count, game_rocket);
+        std::vector<float> fuel(lane_count, INITIAL_FUEL);
+        std::vector<bool> landed_or_crashed(lane_count, false);
+        for (Entity& rocket : rockets) rocket.set_integrator(integrator);
+
+        int mismatches = 0;
+        double step_seconds = 0.0;
+        for (int tick = 0; tick < LANDER_BATCH_CHECK_TICKS; tick++) {
+            for (int i = 0; i < LANDER_BATCH_CHECK_COUNT; i++) actions[i] = get_lander_check_buttons(i, tick);
+
+            auto step_start = std::chrono::steady_clock::now();
+            batch.step(actions.data(), observations.data(), rewards.data(), dones.data());
+            step_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - step_start).count();
+
+            for (int j = 0; j < lane_count; j++) {
+                int lane = LANDER_BATCH_CHECK_LANES[j];
+                Entity& rocket = rockets[j];
+                if (!landed_or_crashed[j]) {
+                    step_rocket(&rocket, get_lander_thrust(actions[lane], fuel[j], FIXED_TIMESTEP));
+                    landed_or_crashed[j] = get_rocket_contact(rocket.get_position(), rocket.get_velocity(), rocket.get_scale()) != LANDER_AIRBORNE;
+                }
+
+                float expected[LANDER_OBSERVATION_SIZE] = { rocket.get_position().x, rocket.get_position().y,
+                    rocket.get_velocity().x, rocket.get_velocity().y, fuel[j] };
+                if (std::memcmp(expected, &observations[lane * LANDER_OBSERVATION_SIZE], sizeof(expected)) != 0 ||
+                    dones[lane] != (std::uint8_t)landed_or_crashed[j]) {
+                    mismatches++;
+                }
+            }
+        }
+
+        std::printf("%s,%d,%d,%d,%.2f\n", get_integrator_name(integrator), LANDER_BATCH_CHECK_COUNT, LANDER_BATCH_CHECK_TICKS,
+            mismatches, step_seconds * 1.0e9 / ((double)LANDER_BATCH_CHECK_COUNT * LANDER_BATCH_CHECK_TICKS));
+        std::fflush(stdout);
+        total_mismatches += mismatches;
+    }
+
+    if (total_mismatches > 0) {
+        LOG("LanderBatch diverged from the game's rocket on " << total_mismatches << " lane ticks");
+        return 1;
+    }
+    return 0;
+}
+
+// ––––– TERRAIN STREAMING TEST ––––– //
+// Flies a camera out along the terrain much faster than the rocket can, then back past the
+// start and as far the other way, without a window. Every tenth of the way it prints the
+// resident chunks, their vertex bytes and the streamer's update time as CSV; all of them should
+// stay flat however far out the camera is.
+int run_terrain_stream_test(int frames) {
+    TerrainStreamer streamer;
+    streamer.start();
+
+    std::printf("frame,camera_x,resident_chunks,loading_chunks,resident_bytes,generated_chunks,evicted_chunks,update_us_per_frame,max_update_us\n");
+
+    int report_every = std::max(1, frames / 10);
+    double update_seconds = 0.0, max_update_seconds = 0.0;
+    float camera_x = 0.0f;
+
+    for (int frame = 1; frame <= frames; frame++) {
+        camera_x += frame <= frames / 4 || frame > 3 * frames / 4 ? TERRAIN_STREAM_TEST_SPEED : -TERRAIN_STREAM_TEST_SPEED;
+
+        auto update_start = std::chrono::steady_clock::now();
+        streamer.update(camera_x);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - update_start).count();
+        update_seconds += seconds;
+        max_update_seconds = std::max(max_update_seconds, seconds);
+
+        // Gives the worker its turn, as waiting for the display would
+        std::this_thread::yield();
+
+        if (frame % report_every != 0) continue;
+
+        TerrainStreamStats stats = streamer.get_stats();
+        std::printf("%d,%.1f,%d,%d,%zu,%llu,%llu,%.3f,%.3f\n", frame, camera_x,
+            stats.resident_chunks, stats.loading_chunks, stats.resident_bytes,
+            (unsigned long long)stats.generated_chunks, (unsigned long long)stats.evicted_chunks,
+            update_seconds * 1.0e6 / report_every, max_update_seconds * 1.0e6);
+        std::fflush(stdout);
+        update_seconds = max_update_seconds = 0.0;
+    }
+
+    streamer.stop();
+    return 0;
+}
+
+// Usage: --record <file> to capture a session, --replay <file> [--expect <hash>] to re-run one,
+// --integrator <euler|verlet|rk4> to pick the rocket's integrator, --integrator-benchmark to compare them,
+// --profile <file> to choose where a profiler build writes its trace,
+// --stress or --stress-windowed [--stress-ticks <n>] to print a CSV scaling curve,
+// --zero-alloc-after <frames> to abort on any frame that allocates once warmed up
+// (needs a build with -DENABLE_ALLOC_TRACKING),
+// --gl-capture <file> [--gl-capture-frames <n>] to record the GL calls of the first frames for the GL Replay tool,
+// --state-file <file> to resume from and quick save (F5) to a file,
+// --snapshot-check with --replay to put every tick's state through a snapshot and back and print their sizes and times,
+// --terrain-stream-test to fly a camera far across the streamed terrain headless and print a CSV of its memory and cost,
+// --lander-batch-check to check LanderBatch against the game's rocket bit for bit and print its cost per lander step,
+// --dynamic-resolution <ms> to lower the scene's resolution whenever rendering takes longer than that,
+// --texture-budget <KB> to cap the memory textures take on the GPU, reloading evicted ones when next drawn
 int main(int argc, char* argv[])
 {
+    const char* replay_filepath = nullptr;
+    const char* expected_hash = nullptr;
+    bool stress = false, stress_windowed = false;
+    int stress_ticks = STRESS_TICKS;
+    int gl_capture_frames = GL_CAPTURE_FRAMES;
+    bool check_snapshots = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--integrator-benchmark") == 0) {
+            run_integrator_benchmark();
+            return 0;
+        }
+        if (std::strcmp(argv[i], "--snapshot-check") == 0) {
+            check_snapshots = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--terrain-stream-test") == 0) return run_terrain_stream_test(TERRAIN_STREAM_TEST_FRAMES);
+        if (std::strcmp(argv[i], "--lander-batch-check") == 0) return run_lander_batch_check();
+        if (std::strcmp(argv[i], "--stress") == 0) {
+            stress = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--stress-windowed") == 0) {
+            stress = stress_windowed = true;
+            continue;
+        }
+        if (i + 1 >= argc) break;
+
+        if (std::strcmp(argv[i], "--record") == 0) g_record_filepath = argv[++i];
+        else if (std::strcmp(argv[i], "--replay") == 0) replay_filepath = argv[++i];
+        else if (std::strcmp(argv[i], "--expect") == 0) expected_hash = argv[++i];
+        else if (std::strcmp(argv[i], "--profile") == 0) g_profile_filepath = argv[++i];
+        else if (std::strcmp(argv[i], "--gl-capture") == 0) g_gl_capture_filepath = argv[++i];
+        else if (std::strcmp(argv[i], "--gl-capture-frames") == 0) gl_capture_frames = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--integrator") == 0) {
+            if (!parse_integrator(argv[++i], g_integrator)) {
+                LOG("Unknown integrator " << argv[i] << "; expected euler, verlet or rk4");
+                return 1;
+            }
+        }
+        else if (std::strcmp(argv[i], "--stress-ticks") == 0) stress_ticks = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--state-file") == 0) g_state_filepath = argv[++i];
+        else if (std::strcmp(argv[i], "--texture-budget") == 0) g_texture_residency.set_budget((std::size_t)std::max(0, std::atoi(argv[++i])) * 1024);
+        else if (std::strcmp(argv[i], "--dynamic-resolution") == 0) {
+            g_use_dynamic_resolution = true;
+            g_resolution_settings.target_milliseconds = std::max(1.0f, (float)std::atof(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--zero-alloc-after") == 0) {
+            if (!ALLOC_REQUIRE_STEADY_STATE(std::atoi(argv[++i]))) LOG("--zero-alloc-after needs a build with -DENABLE_ALLOC_TRACKING");
+        }
+    }
+
+    if (stress) return run_stress_test(stress_windowed, stress_ticks);
+    if (replay_filepath != nullptr) return replay(replay_filepath, expected_hash, check_snapshots);
+
+    if (g_gl_capture_filepath != nullptr && !g_gl_capture.start(g_gl_capture_filepath, gl_capture_frames)) {
+        LOG("Unable to write GL trace to " << g_gl_capture_filepath);
+    }
+
     initialise();
+    g_gl_capture.end_setup();
+    start_snapshots();
 
     while (g_app_status == RUNNING)
     {
+        PROFILE_SCOPE("frame");
+        ALLOC_FRAME_BEGIN();
+        g_frame_arena.reset();
+
         process_input();
         update();
         render();
+
+        ALLOC_FRAME_END();
     }
 
     shutdown();
@@ -0,0 +1,112 @@
+#include "Behaviour.h"
+#include "InputLog.h"
+
+// Same order as the LEFT, RIGHT, UP, DOWN constants in main.cpp
+const glm::vec3 PATROL_HEADINGS[4] = {
+    glm::vec3(-1.0f, 0.0f, 0.0f),
+    glm::vec3(1.0f, 0.0f, 0.0f),
+    glm::vec3(0.0f, 1.0f, 0.0f),
+    glm::vec3(0.0f, -1.0f, 0.0f)
+};
+
+void BehaviourSystem::add_patrol(int entity, float turn_interval, int start_heading) {
+    m_patrol_agents.push_back({ entity, turn_interval, 0.0f, start_heading });
+}
+
+void BehaviourSystem::add_bounce_chase(int entity, float chase_radius, glm::vec3 start_heading) {
+    m_bounce_chase_agents.push_back({ entity, chase_radius, start_heading });
+}
+
+void BehaviourSystem::add_chase(int entity) {
+    m_chase_agents.push_back({ entity });
+}
+
+void BehaviourSystem::reserve(std::size_t patrol_count, std::size_t bounce_chase_count, std::size_t chase_count) {
+    m_patrol_agents.reserve(patrol_count);
+    m_bounce_chase_agents.reserve(bounce_chase_count);
+    m_chase_agents.reserve(chase_count);
+}
+
+void BehaviourSystem::clear() {
+    m_patrol_agents.clear();
+    m_bounce_chase_agents.clear();
+    m_chase_agents.clear();
+}
+
+void BehaviourSystem::update(std::vector<Entity>& entities, const FlowField& pursuit_field, glm::vec3 target, float delta_time) {
+    update_patrol(entities, delta_time);
+    update_bounce_chase(entities, pursuit_field, target, delta_time);
+    update_chase(entities, pursuit_field, delta_time);
+}
+
+void BehaviourSystem::update_patrol(std::vector<Entity>& entities, float delta_time) {
+    for (PatrolAgent& agent : m_patrol_agents) {
+        Entity& entity = entities[agent.entity];
+        if (!entity.is_active()) continue;
+
+        // Unaffected by the target's proximity
+        agent.timer += delta_time;
+        if (agent.timer >= agent.turn_interval) {
+            agent.timer = 0.0f;
+            agent.heading = (agent.heading + 1) % 4;
+        }
+
+        entity.move(PATROL_HEADINGS[agent.heading], delta_time);
+    }
+}
+
+void BehaviourSystem::update_bounce_chase(std::vector<Entity>& entities, const FlowField& pursuit_field, glm::vec3 target, float delta_time) {
+    for (BounceChaseAgent& agent : m_bounce_chase_agents) {
+        Entity& entity = entities[agent.entity];
+        if (!entity.is_active()) continue;
+
+        glm::vec3 position = entity.get_position();
+
+        if (glm::length(position - target) < agent.chase_radius) {
+            agent.heading = pursuit_field.sample(position);
+        }
+        else if (position.y <= m_bounds.min_y || position.y >= m_bounds.max_y) {
+            agent.heading.y *= -1.0f;  // Reverse vertical direction
+        }
+
+        glm::vec3 new_position = position + agent.heading * entity.get_speed() * delta_time;
+        new_position.x = glm::clamp(new_position.x, m_bounds.min_x, m_bounds.max_x);
+        new_position.y = glm::clamp(new_position.y, m_bounds.min_y, m_bounds.max_y);
+
+        entity.set_position(new_position);
+    }
+}
+
+void BehaviourSystem::update_chase(std::vector<Entity>& entities, const FlowField& pursuit_field, float delta_time) {
+    for (const ChaseAgent& agent : m_chase_agents) {
+        Entity& entity = entities[agent.entity];
+        if (!entity.is_active()) continue;
+
+        entity.move(pursuit_field.sample(entity.get_position()), delta_time);
+    }
+}
+
+void BehaviourSystem::serialize(SnapshotStream& stream) {
+    for (PatrolAgent& agent : m_patrol_agents) {
+        stream.serialize_float(agent.timer, 0.0f, agent.turn_interval, 12);
+        stream.serialize_int(agent.heading, 0, 3);
+    }
+
+    for (BounceChaseAgent& agent : m_bounce_chase_agents) {
+        stream.serialize_float(agent.heading.x, -1.0f, 1.0f, 12);
+        stream.serialize_float(agent.heading.y, -1.0f, 1.0f, 12);
+    }
+}
+
+std::uint64_t BehaviourSystem::hash_state(std::uint64_t hash) const {
+    for (const PatrolAgent& agent : m_patrol_agents) {
+        hash = hash_bytes(&agent.timer, sizeof(agent.timer), hash);
+        hash = hash_bytes(&agent.heading, sizeof(agent.heading), hash);
+    }
+
+    for (const BounceChaseAgent& agent : m_bounce_chase_agents) {
+        hash = hash_bytes(&agent.heading, sizeof(agent.heading), hash);
+    }
+
+    return hash;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "glm/glm.hpp"
+#include "Entity.h"
+#include "FlowField.h"
+#include "Snapshot.h"
+
+enum BehaviourType { PATROL, BOUNCE_AND_CHASE, CHASE };
+
+// ––––– PER-BEHAVIOUR AGENT DATA ––––– //
+// Agents refer to their Entity by index so the entities can live in one contiguous array.
+
+// Walks a square: changes heading every turn_interval seconds (the first skull)
+struct PatrolAgent {
+    int entity;
+    float turn_interval;
+    float timer;
+    int heading;        // Index into the LEFT/RIGHT/UP/DOWN order used by main.cpp
+};
+
+// Bounces between the top and bottom edges, chasing the target once it is close (the second skull)
+struct BounceChaseAgent {
+    int entity;
+    float chase_radius;
+    glm::vec3 heading;
+};
+
+// Follows the pursuit field from the start (the third skull)
+struct ChaseAgent {
+    int entity;
+};
+
+// Screen area the bouncing agents are kept inside
+struct BehaviourBounds {
+    float min_x, max_x, min_y, max_y;
+};
+
+// Holds one array per behaviour and updates each array in a single pass, so adding
+// enemies is a matter of adding agents rather than writing new per-enemy code.
+class BehaviourSystem {
+private:
+    std::vector<PatrolAgent> m_patrol_agents;
+    std::vector<BounceChaseAgent> m_bounce_chase_agents;
+    std::vector<ChaseAgent> m_chase_agents;
+
+    BehaviourBounds m_bounds;
+
+    void update_patrol(std::vector<Entity>& entities, float delta_time);
+    void update_bounce_chase(std::vector<Entity>& entities, const FlowField& pursuit_field, glm::vec3 target, float delta_time);
+    void update_chase(std::vector<Entity>& entities, const FlowField& pursuit_field, float delta_time);
+
+public:
+    BehaviourSystem(BehaviourBounds bounds) : m_bounds(bounds) {}
+
+    void add_patrol(int entity, float turn_interval, int start_heading);
+    void add_bounce_chase(int entity, float chase_radius, glm::vec3 start_heading);
+    void add_chase(int entity);
+    void reserve(std::size_t patrol_count, std::size_t bounce_chase_count, std::size_t chase_count);
+    void clear();
+
+    // pursuit_field must already be pointing at target for this tick
+    void update(std::vector<Entity>& entities, const FlowField& pursuit_field, glm::vec3 target, float delta_time);
+
+    // Only what changes as agents run; the agents themselves must already have been added
+    void serialize(SnapshotStream& stream);
+    // Folds the same fields into a replay state hash
+    std::uint64_t hash_state(std::uint64_t hash) const;
+
+    std::size_t get_agent_count() const { return m_patrol_agents.size() + m_bounce_chase_agents.size() + m_chase_agents.size(); }
+};
@@ -0,0 +1,67 @@
+#include <algorithm>
+#include <cmath>
+#include "CollisionMask.h"
+
+void CollisionMask::build(const unsigned char* rgba, int image_width, int image_height,
+    int frame_x, int frame_y, int frame_width, int frame_height,
+    float world_width, float world_height, unsigned char alpha_threshold) {
+    m_width = std::max(1, (int)std::lround(world_width * PIXELS_PER_UNIT));
+    m_height = std::max(1, (int)std::lround(world_height * PIXELS_PER_UNIT));
+    m_words_per_row = (m_width + 63) / 64;
+    m_rows.assign(m_height * m_words_per_row, 0);
+
+    for (int row = 0; row < m_height; row++) {
+        // Mask rows run bottom-up, image rows top-down
+        int image_row = frame_y + std::min(frame_height - 1, (int)((m_height - 1 - row + 0.5f) * frame_height / m_height));
+        image_row = std::min(image_row, image_height - 1);
+
+        for (int col = 0; col < m_width; col++) {
+            int image_col = frame_x + std::min(frame_width - 1, (int)((col + 0.5f) * frame_width / m_width));
+            image_col = std::min(image_col, image_width - 1);
+
+            if (rgba[(image_row * image_width + image_col) * 4 + 3] >= alpha_threshold) {
+                m_rows[row * m_words_per_row + col / 64] |= (std::uint64_t)1 << (col % 64);
+            }
+        }
+    }
+}
+
+std::uint64_t CollisionMask::get_bits(int row, int first_col) const {
+    if (first_col <= -64 || first_col >= m_width) return 0;
+
+    // Word holding first_col, rounding down for negative columns
+    int word = first_col >= 0 ? first_col / 64 : -1;
+    int shift = first_col - word * 64;
+    const std::uint64_t* words = &m_rows[row * m_words_per_row];
+
+    std::uint64_t low = word >= 0 ? words[word] : 0;
+    if (shift == 0) return low;
+
+    std::uint64_t high = word + 1 < m_words_per_row ? words[word + 1] : 0;
+    return (low >> shift) | (high << (64 - shift));
+}
+
+bool masks_overlap(const CollisionMask& a, glm::vec3 a_centre, const CollisionMask& b, glm::vec3 b_centre) {
+    if (a.is_empty() || b.is_empty()) return true;
+
+    // Offset of b's bottom-left corner from a's, in mask pixels
+    float a_left = a_centre.x * CollisionMask::PIXELS_PER_UNIT - 0.5f * a.get_width();
+    float a_bottom = a_centre.y * CollisionMask::PIXELS_PER_UNIT - 0.5f * a.get_height();
+    float b_left = b_centre.x * CollisionMask::PIXELS_PER_UNIT - 0.5f * b.get_width();
+    float b_bottom = b_centre.y * CollisionMask::PIXELS_PER_UNIT - 0.5f * b.get_height();
+    int offset_x = (int)std::lround(b_left - a_left);
+    int offset_y = (int)std::lround(b_bottom - a_bottom);
+
+    if (offset_x >= a.get_width() || -offset_x >= b.get_width()) return false;
+
+    int first_row = std::max(0, offset_y);
+    int last_row = std::min(a.get_height(), offset_y + b.get_height());
+
+    for (int row = first_row; row < last_row; row++) {
+        // b's columns lined up under each word of a's row
+        for (int word = 0; word < a.get_words_per_row(); word++) {
+            if (a.get_bits(row, 64 * word) & b.get_bits(row - offset_y, 64 * word - offset_x)) return true;
+        }
+    }
+    return false;
+}
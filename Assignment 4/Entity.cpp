@@ -1,5 +1,7 @@
 #include "Entity.h"
-#include "ShaderProgram.h"
+#include "CachedShaderProgram.h"
+#include "PerfHud.h"
+#include "Profiler.h"
 #include "glm/gtc/matrix_transform.hpp"
 
 void Entity::update_model_matrix() {
@@ -10,12 +12,14 @@ void Entity::update_model_matrix() {
 }
 
 void Entity::move(glm::vec3 direction, float delta_time) {
+    PROFILE_SCOPE("Entity::move");
     if (!m_is_active) return;  // Skip movement if the entity is not active
     m_position += direction * m_speed * delta_time;
     update_model_matrix();
 }
 
 void Entity::animate(float delta_time, int cols) {
+    PROFILE_SCOPE("Entity::animate");
     if (!m_is_active) return;  // Skip animation if the entity is not active
     m_animation_time += delta_time;
     float frames_per_second = 1.0f / SECONDS_PER_FRAME;
@@ -30,17 +34,18 @@ void Entity::animate(float delta_time, int cols) {
     update_model_matrix();
 }
 
-void Entity::render(ShaderProgram* program) {
+void Entity::render(CachedShaderProgram* program) {
+    PROFILE_SCOPE("Entity::render");
     if (!m_is_active) return;  // Skip rendering if the entity is not active
 
-    program->set_model_matrix(m_model_matrix);
+    counted_set_model_matrix(program, m_model_matrix);
 
     if (m_animation_indices) {
         draw_sprite_from_texture_atlas(program, m_texture_id, m_animation_indices[m_animation_index], SPRITESHEET_DIMENSIONS, SPRITESHEET_DIMENSIONS);
     }
     else {
         // Render static sprite if no animation is set
-        glBindTexture(GL_TEXTURE_2D, m_texture_id);
+        counted_bind_texture(GL_TEXTURE_2D, m_texture_id);
 
         float vertices[] = {
             -0.5f, -0.5f,
@@ -60,46 +65,52 @@ void Entity::render(ShaderProgram* program) {
             0.0f, 0.0f
         };
 
-        glVertexAttribPointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, vertices);
-        glEnableVertexAttribArray(program->get_position_attribute());
+        traced_vertex_attrib_pointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, vertices);
+        traced_enable_vertex_attrib_array(program->get_position_attribute());
 
-        glVertexAttribPointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, tex_coords);
-        glEnableVertexAttribArray(program->get_tex_coordinate_attribute());
+        traced_vertex_attrib_pointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, tex_coords);
+        traced_enable_vertex_attrib_array(program->get_tex_coordinate_attribute());
 
-        glDrawArrays(GL_TRIANGLES, 0, 6);
+        counted_draw_arrays(GL_TRIANGLES, 0, 6);
 
-        glDisableVertexAttribArray(program->get_position_attribute());
-        glDisableVertexAttribArray(program->get_tex_coordinate_attribute());
+        traced_disable_vertex_attrib_array(program->get_position_attribute());
+        traced_disable_vertex_attrib_array(program->get_tex_coordinate_attribute());
     }
 }
 
-void draw_sprite_from_texture_atlas(ShaderProgram* program, GLuint texture_id, int index, int rows, int cols) {
+void get_atlas_tex_coords(int index, int rows, int cols, float tex_coords[12]) {
     float u_coord = (float)(index % cols) / (float)cols;
     float v_coord = (float)(index / cols) / (float)rows;
 
     float width = 1.0f / (float)cols;
     float height = 1.0f / (float)rows;
 
-    float tex_coords[] = {
+    const float coords[] = {
         u_coord, v_coord + height, u_coord + width, v_coord + height, u_coord + width, v_coord,
         u_coord, v_coord + height, u_coord + width, v_coord, u_coord, v_coord
     };
+    for (int i = 0; i < 12; i++) tex_coords[i] = coords[i];
+}
+
+void draw_sprite_from_texture_atlas(CachedShaderProgram* program, GLuint texture_id, int index, int rows, int cols) {
+    float tex_coords[12];
+    get_atlas_tex_coords(index, rows, cols, tex_coords);
 
     float vertices[] = {
         -0.5, -0.5, 0.5, -0.5,  0.5, 0.5,
         -0.5, -0.5, 0.5,  0.5, -0.5, 0.5
     };
 
-    glBindTexture(GL_TEXTURE_2D, texture_id);
+    counted_bind_texture(GL_TEXTURE_2D, texture_id);
 
-    glVertexAttribPointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, vertices);
-    glEnableVertexAttribArray(program->get_position_attribute());
+    traced_vertex_attrib_pointer(program->get_position_attribute(), 2, GL_FLOAT, false, 0, vertices);
+    traced_enable_vertex_attrib_array(program->get_position_attribute());
 
-    glVertexAttribPointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, tex_coords);
-    glEnableVertexAttribArray(program->get_tex_coordinate_attribute());
+    traced_vertex_attrib_pointer(program->get_tex_coordinate_attribute(), 2, GL_FLOAT, false, 0, tex_coords);
+    traced_enable_vertex_attrib_array(program->get_tex_coordinate_attribute());
 
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    counted_draw_arrays(GL_TRIANGLES, 0, 6);
 
-    glDisableVertexAttribArray(program->get_position_attribute());
-    glDisableVertexAttribArray(program->get_tex_coordinate_attribute());
+    traced_disable_vertex_attrib_array(program->get_position_attribute());
+    traced_disable_vertex_attrib_array(program->get_tex_coordinate_attribute());
 }
@@ -1,7 +1,7 @@
 #pragma once
 
 #include "glm/mat4x4.hpp"
-#include "ShaderProgram.h"
+#include "CachedShaderProgram.h"
 
 // Constants
 constexpr int SECONDS_PER_FRAME = 4;
@@ -40,6 +40,10 @@ public:
         m_animation_frames = animation_frames;
     }
     void set_active(bool is_active) { m_is_active = is_active; }
+    void set_animation_state(int animation_index, float animation_time) {
+        m_animation_index = animation_index;
+        m_animation_time = animation_time;
+    }
 
     // Getters
     glm::vec3 get_position() const { return m_position; }
@@ -48,13 +52,18 @@ public:
     float get_speed() const { return m_speed; }
     glm::mat4 get_model_matrix() const { return m_model_matrix; }
     GLuint get_texture_id() const { return m_texture_id; }
+    int get_animation_index() const { return m_animation_index; }
+    float get_animation_time() const { return m_animation_time; }
+    int get_animation_frame() const { return m_animation_indices ? m_animation_indices[m_animation_index] : 0; }
     bool is_active() const { return m_is_active; }
 
     // Other Methods
     void update_model_matrix();
-    void render(ShaderProgram* program);
+    void render(CachedShaderProgram* program);
     void animate(float delta_time, int cols);
     void move(glm::vec3 direction, float delta_time);
 };
 
-void draw_sprite_from_texture_atlas(ShaderProgram* program, GLuint texture_id, int index, int rows, int cols);
+// Two triangles' worth of UVs for one frame of a rows x cols sprite sheet
+void get_atlas_tex_coords(int index, int rows, int cols, float tex_coords[12]);
+void draw_sprite_from_texture_atlas(CachedShaderProgram* program, GLuint texture_id, int index, int rows, int cols);
@@ -0,0 +1,47 @@
+#include <algorithm>
+#include "EntityCommands.h"
+
+void EntityCommandBuffer::reserve(std::size_t command_count, std::size_t spawn_count) {
+    m_commands.reserve(command_count);
+    m_spawns.reserve(spawn_count);
+}
+
+void EntityCommandBuffer::apply(std::vector<Entity>& entities) {
+    std::sort(m_commands.begin(), m_commands.end(), [](const Command& a, const Command& b) {
+        return a.entity != b.entity ? a.entity < b.entity : a.type < b.type;
+    });
+
+    // Entities before next have been dealt with; kept of them survive, packed at the front
+    std::size_t kept = 0, next = 0;
+    for (const Command& command : m_commands) {
+        if (command.entity < 0 || (std::size_t)command.entity >= entities.size()) continue;
+        std::size_t entity = (std::size_t)command.entity;
+
+        if (command.type != DESTROY) {
+            entities[entity].set_active(command.type == ACTIVATE);
+            continue;
+        }
+        if (entity < next) continue;  // Already destroyed
+
+        if (kept != next) std::move(entities.begin() + next, entities.begin() + entity, entities.begin() + kept);
+        kept += entity - next;
+        next = entity + 1;
+    }
+
+    if (next > 0) {
+        if (kept != next) std::move(entities.begin() + next, entities.end(), entities.begin() + kept);
+        kept += entities.size() - next;
+        entities.erase(entities.begin() + kept, entities.end());
+    }
+
+    // Spawns are drawn this tick before their first move, so they need a model matrix of their own
+    std::size_t first_spawn = entities.size();
+    entities.insert(entities.end(), m_spawns.begin(), m_spawns.end());
+    for (std::size_t i = first_spawn; i < entities.size(); i++) entities[i].update_model_matrix();
+    clear();
+}
+
+void EntityCommandBuffer::clear() {
+    m_commands.clear();
+    m_spawns.clear();
+}
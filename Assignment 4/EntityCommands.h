@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "Entity.h"
+
+// ––––– ENTITY COMMAND BUFFER ––––– //
+// Spawns, destroys and activation changes for one entity array, recorded while systems iterate
+// it and applied in one batch at the tick's sync point, so no loop sees its array change under
+// it. Until apply(), the array reads as it did when the batch began and recorded indices stay
+// valid, which is also what lets systems that only read the array and record run side by side.
+//
+// apply() sorts the batch by entity index first, so the outcome does not depend on the order
+// commands were recorded in: activation changes land (an activate beats a deactivate of the same
+// entity), destroyed entities are compacted out in one order-preserving pass, and spawns are
+// appended last, in the order they were recorded, with their model matrix already set.
+class EntityCommandBuffer {
+private:
+    enum CommandType : std::uint8_t { DEACTIVATE, ACTIVATE, DESTROY };
+
+    struct Command {
+        int entity;
+        CommandType type;
+    };
+
+    std::vector<Command> m_commands;
+    std::vector<Entity> m_spawns;
+
+public:
+    // Room for a tick's worth of commands, so recording doesn't allocate
+    void reserve(std::size_t command_count, std::size_t spawn_count);
+
+    void spawn(const Entity& entity) { m_spawns.push_back(entity); }
+    void destroy(int entity) { m_commands.push_back({ entity, DESTROY }); }
+    void set_active(int entity, bool is_active) { m_commands.push_back({ entity, is_active ? ACTIVATE : DEACTIVATE }); }
+
+    // Indices outside the array, or destroyed twice, are ignored. Leaves the buffer empty.
+    void apply(std::vector<Entity>& entities);
+    void clear();
+
+    bool is_empty() const { return m_commands.empty() && m_spawns.empty(); }
+};
@@ -0,0 +1,219 @@
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include "FlowField.h"
+
+constexpr float UNREACHABLE = std::numeric_limits<float>::max();
+constexpr float DIAGONAL_COST = 1.41421356f;
+
+// 8-connected neighbours: column offset, row offset
+constexpr int NEIGHBOUR_OFFSETS[8][2] = {
+    { 1, 0 }, { -1, 0 }, { 0, 1 }, { 0, -1 },
+    { 1, 1 }, { 1, -1 }, { -1, 1 }, { -1, -1 }
+};
+
+FlowField::FlowField(glm::vec3 origin, float width, float height, float cell_size)
+    : m_origin(origin), m_cell_size(cell_size),
+    m_cols((int)std::ceil(width / cell_size)), m_rows((int)std::ceil(height / cell_size)),
+    m_target(0.0f)
+{
+    m_distance.assign(m_cols * m_rows, UNREACHABLE);
+    m_direction.assign(m_cols * m_rows, glm::vec3(0.0f));
+    m_blocked.assign(m_cols * m_rows, 0);
+}
+
+int FlowField::cell_index(glm::vec3 position) const {
+    int col = (int)std::floor((position.x - m_origin.x) / m_cell_size);
+    int row = (int)std::floor((position.y - m_origin.y) / m_cell_size);
+
+    // Anything off the grid follows the nearest edge cell
+    col = glm::clamp(col, 0, m_cols - 1);
+    row = glm::clamp(row, 0, m_rows - 1);
+    return row * m_cols + col;
+}
+
+void FlowField::set_target(glm::vec3 target) {
+    m_target = target;
+
+    int target_cell = cell_index(target);
+    if (target_cell != m_target_cell) {
+        m_target_cell = target_cell;
+        m_dirty = true;
+    }
+
+    if (m_dirty) rebuild();
+    else if (!m_changed_cells.empty()) repair();
+}
+
+void FlowField::set_blocked(glm::vec3 position, bool blocked) {
+    int cell = cell_index(position);
+    if (m_blocked[cell] != (std::uint8_t)blocked) {
+        m_blocked[cell] = blocked;
+        m_changed_cells.push_back(cell);
+    }
+}
+
+// Dijkstra outward from the target cell, then point every cell at its cheapest neighbour
+void FlowField::rebuild() {
+    m_dirty = false;
+    m_changed_cells.clear();
+    std::fill(m_distance.begin(), m_distance.end(), UNREACHABLE);
+
+    m_distance[m_target_cell] = 0.0f;
+    m_frontier.clear();
+    m_frontier.push_back({ 0.0f, m_target_cell });
+    propagate(nullptr);
+
+    for (int cell = 0; cell < m_cols * m_rows; cell++) update_direction(cell);
+}
+
+// Only cells whose shortest path ran through a newly blocked cell can get longer, and only cells
+// near a newly cleared one can get shorter. Those are cleared and searched again from the
+// untouched cells around them; every other distance is already right.
+void FlowField::repair() {
+    m_stale.clear();
+    for (int cell : m_changed_cells) {
+        if (cell == m_target_cell) {
+            rebuild();
+            return;
+        }
+        m_stale.push_back({ m_distance[cell], cell });
+        if (m_blocked[cell]) m_distance[cell] = UNREACHABLE;
+    }
+    m_changed_cells.clear();
+
+    // A neighbour whose distance is exactly this cell's plus the step may have been reached
+    // through it, so it is cleared too. Distances are sums in the same order as the search
+    // made them, so the comparison is exact.
+    for (std::size_t i = 0; i < m_stale.size(); i++) {
+        float old_distance = m_stale[i].first;
+        int cell = m_stale[i].second;
+        if (old_distance == UNREACHABLE || m_distance[cell] != UNREACHABLE) continue;  // Nothing went through it
+
+        int col = cell % m_cols, row = cell / m_cols;
+        for (int j = 0; j < 8; j++) {
+            int neighbour_col = col + NEIGHBOUR_OFFSETS[j][0];
+            int neighbour_row = row + NEIGHBOUR_OFFSETS[j][1];
+            if (neighbour_col < 0 || neighbour_col >= m_cols || neighbour_row < 0 || neighbour_row >= m_rows) continue;
+
+            int neighbour = neighbour_row * m_cols + neighbour_col;
+            if (neighbour == m_target_cell || m_distance[neighbour] == UNREACHABLE) continue;
+
+            if (m_distance[neighbour] == old_distance + (j < 4 ? 1.0f : DIAGONAL_COST)) {
+                m_stale.push_back({ m_distance[neighbour], neighbour });
+                m_distance[neighbour] = UNREACHABLE;
+            }
+        }
+    }
+
+    // Seed the search with the best path into each cleared cell from the cells left alone
+    m_frontier.clear();
+    for (const std::pair<float, int>& stale : m_stale) {
+        int cell = stale.second;
+        if (m_blocked[cell]) continue;
+
+        int col = cell % m_cols, row = cell / m_cols;
+        for (int j = 0; j < 8; j++) {
+            int neighbour_col = col + NEIGHBOUR_OFFSETS[j][0];
+            int neighbour_row = row + NEIGHBOUR_OFFSETS[j][1];
+            if (neighbour_col < 0 || neighbour_col >= m_cols || neighbour_row < 0 || neighbour_row >= m_rows) continue;
+
+            int neighbour = neighbour_row * m_cols + neighbour_col;
+            if (m_distance[neighbour] == UNREACHABLE) continue;
+
+            float distance = m_distance[neighbour] + (j < 4 ? 1.0f : DIAGONAL_COST);
+            if (distance < m_distance[cell]) m_distance[cell] = distance;
+        }
+        if (m_distance[cell] != UNREACHABLE) m_frontier.push_back({ m_distance[cell], cell });
+    }
+    std::make_heap(m_frontier.begin(), m_frontier.end(), std::greater<std::pair<float, int>>());
+
+    m_lowered.clear();
+    propagate(&m_lowered);
+
+    // A heading only depends on the distances around it
+    for (const std::pair<float, int>& stale : m_stale) update_directions_around(stale.second);
+    for (int cell : m_lowered) update_directions_around(cell);
+}
+
+// Runs Dijkstra from whatever is on the frontier, lowering distances wherever a shorter path
+// turns up. lowered_cells, if given, collects every cell it lowered.
+void FlowField::propagate(std::vector<int>* lowered_cells) {
+    typedef std::pair<float, int> QueueEntry;
+    std::greater<QueueEntry> closer;  // Min-heap on distance, ordered as std::priority_queue would
+
+    while (!m_frontier.empty()) {
+        std::pop_heap(m_frontier.begin(), m_frontier.end(), closer);
+        QueueEntry entry = m_frontier.back();
+        m_frontier.pop_back();
+
+        int cell = entry.second;
+        if (entry.first > m_distance[cell]) continue;  // Stale entry
+
+        int col = cell % m_cols, row = cell / m_cols;
+        for (int i = 0; i < 8; i++) {
+            int neighbour_col = col + NEIGHBOUR_OFFSETS[i][0];
+            int neighbour_row = row + NEIGHBOUR_OFFSETS[i][1];
+            if (neighbour_col < 0 || neighbour_col >= m_cols || neighbour_row < 0 || neighbour_row >= m_rows) continue;
+
+            int neighbour = neighbour_row * m_cols + neighbour_col;
+            if (m_blocked[neighbour]) continue;
+
+            float distance = entry.first + (i < 4 ? 1.0f : DIAGONAL_COST);
+            if (distance < m_distance[neighbour]) {
+                m_distance[neighbour] = distance;
+                m_frontier.push_back({ distance, neighbour });
+                std::push_heap(m_frontier.begin(), m_frontier.end(), closer);
+                if (lowered_cells) lowered_cells->push_back(neighbour);
+            }
+        }
+    }
+}
+
+// Point the cell at its cheapest neighbour, or nowhere if none is closer to the target
+void FlowField::update_direction(int cell) {
+    int col = cell % m_cols, row = cell / m_cols;
+    float best_distance = m_distance[cell];
+    glm::vec3 best_direction(0.0f);
+
+    for (int i = 0; i < 8; i++) {
+        int neighbour_col = col + NEIGHBOUR_OFFSETS[i][0];
+        int neighbour_row = row + NEIGHBOUR_OFFSETS[i][1];
+        if (neighbour_col < 0 || neighbour_col >= m_cols || neighbour_row < 0 || neighbour_row >= m_rows) continue;
+
+        int neighbour = neighbour_row * m_cols + neighbour_col;
+        if (m_distance[neighbour] < best_distance) {
+            best_distance = m_distance[neighbour];
+            best_direction = glm::normalize(glm::vec3((float)NEIGHBOUR_OFFSETS[i][0], (float)NEIGHBOUR_OFFSETS[i][1], 0.0f));
+        }
+    }
+
+    m_direction[cell] = best_direction;
+}
+
+void FlowField::update_directions_around(int cell) {
+    int col = cell % m_cols, row = cell / m_cols;
+    for (int row_offset = -1; row_offset <= 1; row_offset++) {
+        for (int col_offset = -1; col_offset <= 1; col_offset++) {
+            int neighbour_col = col + col_offset, neighbour_row = row + row_offset;
+            if (neighbour_col < 0 || neighbour_col >= m_cols || neighbour_row < 0 || neighbour_row >= m_rows) continue;
+            update_direction(neighbour_row * m_cols + neighbour_col);
+        }
+    }
+}
+
+glm::vec3 FlowField::sample(glm::vec3 position) const {
+    int cell = cell_index(position);
+    if (cell != m_target_cell) return m_direction[cell];
+
+    glm::vec3 to_target = m_target - position;
+    to_target.z = 0.0f;
+    float distance = glm::length(to_target);
+    return distance > 0.0f ? to_target / distance : glm::vec3(0.0f);
+}
+
+float FlowField::get_distance(glm::vec3 position) const {
+    float cells = m_distance[cell_index(position)];
+    return cells == UNREACHABLE ? UNREACHABLE : cells * m_cell_size;
+}
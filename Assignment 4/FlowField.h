@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+#include "glm/glm.hpp"
+
+// Grid of headings toward a single target. The field is rebuilt at most once per tick,
+// and only when the target moves into a different cell, so any number of chasers can
+// follow it for the cost of one cell lookup each. Obstacle changes don't rebuild it: only
+// the cells whose paths ran through a changed cell are searched again.
+class FlowField {
+private:
+    glm::vec3 m_origin;     // World position of the bottom-left corner of cell (0, 0)
+    float m_cell_size;
+    int m_cols, m_rows;
+
+    std::vector<float> m_distance;          // Path length from each cell to the target cell
+    std::vector<glm::vec3> m_direction;     // Unit heading toward the next cell on that path
+    std::vector<std::uint8_t> m_blocked;
+    std::vector<std::pair<float, int>> m_frontier;  // Dijkstra's heap, kept so rebuilds reuse its storage
+
+    std::vector<int> m_changed_cells;               // Obstacles set or cleared since the last update
+    std::vector<std::pair<float, int>> m_stale;     // Cells a repair searches again, with their old distance
+    std::vector<int> m_lowered;                     // Cells a repair found a shorter path for
+
+    glm::vec3 m_target;
+    int m_target_cell = -1;
+    bool m_dirty = true;
+
+    void rebuild();
+    void repair();
+    void propagate(std::vector<int>* lowered_cells);
+    void update_direction(int cell);
+    void update_directions_around(int cell);     // The cell and its eight neighbours
+
+public:
+    FlowField(glm::vec3 origin, float width, float height, float cell_size);
+
+    // Call once per tick; does nothing unless the target changed cell or an obstacle changed.
+    // A new target cell rebuilds the whole field, an obstacle change only the paths it touches.
+    void set_target(glm::vec3 target);
+    void set_blocked(glm::vec3 position, bool blocked);
+
+    // Heading for a chaser at position. Inside the target's cell it points straight at the target.
+    glm::vec3 sample(glm::vec3 position) const;
+    float get_distance(glm::vec3 position) const;
+
+    int cell_index(glm::vec3 position) const;
+    int get_cols() const { return m_cols; }
+    int get_rows() const { return m_rows; }
+};
@@ -0,0 +1,44 @@
+#include <algorithm>
+#include <new>
+#include "FrameArena.h"
+
+FrameArena g_frame_arena(FRAME_ARENA_CAPACITY);
+
+FrameArena::FrameArena(std::size_t capacity)
+    : m_buffer(static_cast<unsigned char*>(::operator new(capacity))), m_capacity(capacity) {}
+
+FrameArena::~FrameArena() {
+    reset();
+    ::operator delete(m_buffer);
+}
+
+void* FrameArena::allocate(std::size_t bytes, std::size_t alignment) {
+    std::size_t start = (m_offset + alignment - 1) / alignment * alignment;
+
+    if (start + bytes > m_capacity) {
+        // Counted towards the high water mark so the next reset makes room for it
+        void* block = ::operator new(bytes);
+        m_overflow_blocks.push_back(block);
+        m_overflow_bytes += bytes;
+        m_high_water = std::max(m_high_water, get_used());
+        return block;
+    }
+
+    m_offset = start + bytes;
+    m_high_water = std::max(m_high_water, get_used());
+    return m_buffer + start;
+}
+
+void FrameArena::reset() {
+    for (void* block : m_overflow_blocks) ::operator delete(block);
+    m_overflow_blocks.clear();
+
+    if (m_high_water > m_capacity) {
+        ::operator delete(m_buffer);
+        m_capacity = std::max(m_high_water, m_capacity * 2);
+        m_buffer = static_cast<unsigned char*>(::operator new(m_capacity));
+    }
+
+    m_offset = 0;
+    m_overflow_bytes = 0;
+}
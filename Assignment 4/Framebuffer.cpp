@@ -0,0 +1,71 @@
+#include <SDL.h>
+#include "Framebuffer.h"
+#include "GlCapture.h"
+#include "PerfHud.h"
+
+typedef void (APIENTRY* GenFramebuffersFunction)(GLsizei, GLuint*);
+typedef void (APIENTRY* BindFramebufferFunction)(GLenum, GLuint);
+typedef void (APIENTRY* FramebufferTexture2DFunction)(GLenum, GLenum, GLenum, GLuint, GLint);
+typedef GLenum (APIENTRY* CheckFramebufferStatusFunction)(GLenum);
+typedef void (APIENTRY* BlendFuncSeparateFunction)(GLenum, GLenum, GLenum, GLenum);
+
+static GenFramebuffersFunction gen_framebuffers = nullptr;
+static BindFramebufferFunction bind_framebuffer = nullptr;
+static FramebufferTexture2DFunction framebuffer_texture_2d = nullptr;
+static CheckFramebufferStatusFunction check_framebuffer_status = nullptr;
+static BlendFuncSeparateFunction blend_func_separate = nullptr;
+
+static void* get_proc_address(const char* name, const char* ext_name) {
+    void* address = SDL_GL_GetProcAddress(name);
+    return address != nullptr ? address : SDL_GL_GetProcAddress(ext_name);
+}
+
+bool load_framebuffer_functions() {
+    if (check_framebuffer_status != nullptr) return true;
+
+    gen_framebuffers = (GenFramebuffersFunction)get_proc_address("glGenFramebuffers", "glGenFramebuffersEXT");
+    bind_framebuffer = (BindFramebufferFunction)get_proc_address("glBindFramebuffer", "glBindFramebufferEXT");
+    framebuffer_texture_2d = (FramebufferTexture2DFunction)get_proc_address("glFramebufferTexture2D", "glFramebufferTexture2DEXT");
+    check_framebuffer_status = (CheckFramebufferStatusFunction)get_proc_address("glCheckFramebufferStatus", "glCheckFramebufferStatusEXT");
+    blend_func_separate = (BlendFuncSeparateFunction)get_proc_address("glBlendFuncSeparate", "glBlendFuncSeparateEXT");
+
+    if (gen_framebuffers && bind_framebuffer && framebuffer_texture_2d && check_framebuffer_status && blend_func_separate) return true;
+    check_framebuffer_status = nullptr;
+    return false;
+}
+
+void traced_gen_framebuffer(GLuint* framebuffer) {
+    gen_framebuffers(1, framebuffer);
+    if (g_gl_capture.is_recording()) g_gl_capture.record_gen_framebuffer(*framebuffer);
+}
+
+void traced_bind_framebuffer(GLenum target, GLuint framebuffer) {
+    if (g_gl_capture.is_recording()) g_gl_capture.record_bind_framebuffer(target, framebuffer);
+    bind_framebuffer(target, framebuffer);
+}
+
+void traced_framebuffer_texture_2d(GLenum target, GLenum attachment, GLenum texture_target, GLuint texture, GLint level) {
+    if (g_gl_capture.is_recording()) g_gl_capture.record_framebuffer_texture(target, attachment, texture_target, texture, level);
+    framebuffer_texture_2d(target, attachment, texture_target, texture, level);
+}
+
+void traced_blend_func_separate(GLenum source_rgb, GLenum destination_rgb, GLenum source_alpha, GLenum destination_alpha) {
+    if (g_gl_capture.is_recording()) g_gl_capture.record_blend_func_separate(source_rgb, destination_rgb, source_alpha, destination_alpha);
+    blend_func_separate(source_rgb, destination_rgb, source_alpha, destination_alpha);
+}
+
+bool is_framebuffer_complete() {
+    return check_framebuffer_status(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+}
+
+GLuint create_target_texture(int width, int height) {
+    GLuint texture;
+    traced_gen_texture(&texture);
+    counted_bind_texture(GL_TEXTURE_2D, texture);
+    traced_tex_image_2d(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    traced_tex_parameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    traced_tex_parameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    traced_tex_parameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    traced_tex_parameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    return texture;
+}
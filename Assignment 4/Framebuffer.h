@@ -0,0 +1,35 @@
+#pragma once
+
+#include "ShaderProgram.h"
+
+// ––––– FRAMEBUFFER OBJECTS ––––– //
+// Framebuffer objects are core only from GL 3.0, so like the HUD's timer queries they are looked
+// up at runtime, falling back on the EXT names older drivers have. Separate blend factors are
+// older (1.4) but past what Windows links against, so they come the same way. Each call is
+// recorded while a GL capture is running, like the traced_* wrappers in GlCapture.h.
+//
+// Framebuffer 0 is the window's.
+
+#ifndef GL_FRAMEBUFFER
+#define GL_FRAMEBUFFER 0x8D40
+#define GL_FRAMEBUFFER_COMPLETE 0x8CD5
+#define GL_COLOR_ATTACHMENT0 0x8CE0
+#endif
+#ifndef GL_CLAMP_TO_EDGE
+#define GL_CLAMP_TO_EDGE 0x812F
+#endif
+
+// Needs a current GL context. Returns false if any of the calls below is missing, in which
+// case none of them may be used.
+bool load_framebuffer_functions();
+
+void traced_gen_framebuffer(GLuint* framebuffer);
+void traced_bind_framebuffer(GLenum target, GLuint framebuffer);
+void traced_framebuffer_texture_2d(GLenum target, GLenum attachment, GLenum texture_target, GLuint texture, GLint level);
+void traced_blend_func_separate(GLenum source_rgb, GLenum destination_rgb, GLenum source_alpha, GLenum destination_alpha);
+
+// Whether the framebuffer bound to GL_FRAMEBUFFER can be drawn to
+bool is_framebuffer_complete();
+
+// A texture to draw into, one texel per pixel: nearest filtering, clamped at the edges, no pixels
+GLuint create_target_texture(int width, int height);
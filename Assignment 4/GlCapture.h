@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstdio>
+#include "glm/mat4x4.hpp"
+#include "CachedShaderProgram.h"
+#include "GlTrace.h"
+#include "Profiler.h"
+
+// ––––– GL COMMAND CAPTURE ––––– //
+// Records the GL calls the game makes, payloads included, into a GlTrace.h trace for the
+// standalone replayer. Recording starts before initialise() so the texture uploads are in the
+// trace, and stops by itself after the requested number of frames. Every GL call that render(),
+// Entity::render, draw_text and load_texture make goes through a counted_* (PerfHud.h) or
+// traced_* wrapper below; when nothing is being recorded each costs one branch.
+class GlCapture {
+private:
+    static constexpr int MAX_ATTRIBUTES = 8;
+
+    // Client-side arrays are copied at draw time, once the vertex count is known
+    struct AttributeArray {
+        const float* data = nullptr;  // Null unless tightly packed floats, the only layout recorded
+        int components = 0;
+        bool enabled = false;
+    };
+
+    std::FILE* m_file = nullptr;
+    int m_frames_left = 0;
+    AttributeArray m_attributes[MAX_ATTRIBUTES];
+
+    void write_command(GlTraceOp op, const void* payload, std::size_t payload_bytes,
+        const void* data = nullptr, std::size_t data_bytes = 0);
+
+public:
+    bool start(const char* filepath, int frames);
+    void finish();
+    bool is_recording() const { return m_file != nullptr; }
+
+    void end_setup();
+
+    // Returns true on the frame that completes the capture
+    bool end_frame();
+
+    void record_viewport(GLint x, GLint y, GLsizei width, GLsizei height);
+    void record_clear_color(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha);
+    void record_clear(GLbitfield mask);
+    void record_enable(GLenum capability);
+    void record_blend_func(GLenum source, GLenum destination);
+    void record_program(CachedShaderProgram* program);
+    void record_use_program(GLuint program);
+    void record_matrix(GlTraceMatrix matrix, const glm::mat4& values);
+    void record_gen_texture(GLuint texture);
+    void record_bind_texture(GLenum target, GLuint texture);
+    void record_tex_image_2d(GLenum target, GLint level, GLint internal_format, GLsizei width, GLsizei height,
+        GLenum format, GLenum type, const void* pixels);
+    void record_tex_parameter(GLenum target, GLenum name, GLint value);
+    void record_attribute_pointer(GLuint index, GLint components, GLenum type, GLsizei stride, const void* pointer);
+    void record_enable_attribute(GLuint index);
+    void record_disable_attribute(GLuint index);
+    void record_draw_arrays(GLenum mode, GLint first, GLsizei count);
+
+    // These calls go through functions looked up at runtime (Framebuffer.h), so they have no
+    // traced_* wrappers here
+    void record_blend_func_separate(GLenum source_rgb, GLenum destination_rgb, GLenum source_alpha, GLenum destination_alpha);
+    void record_gen_framebuffer(GLuint framebuffer);
+    void record_bind_framebuffer(GLenum target, GLuint framebuffer);
+    void record_framebuffer_texture(GLenum target, GLenum attachment, GLenum texture_target, GLuint texture, GLint level);
+};
+
+extern GlCapture g_gl_capture;
+
+inline void traced_viewport(GLint x, GLint y, GLsizei width, GLsizei height) {
+    if (g_gl_capture.is_recording()) g_gl_capture.record_viewport(x, y, width, height);
+    glViewport(x, y, width, height);
+}
+
+inline void traced_clear_color(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha) {
+    if (g_gl_capture.is_recording()) g_gl_capture.record_clear_color(red, green, blue, alpha);
+    glClearColor(red, green, blue, alpha);
+}
+
+inline void traced_clear(GLbitfield mask) {
+    if (g_gl_capture.is_recording()) g_gl_capture.record_clear(mask);
+    glClear(mask);
+}
+
+inline void traced_enable(GLenum capability) {
+    if (g_gl_capture.is_recording()) g_gl_capture.record_enable(capability);
+    glEnable(capability);
+}
+
+inline void traced_blend_func(GLenum source, GLenum destination) {
+    if (g_gl_capture.is_recording()) g_gl_capture.record_blend_func(source, destination);
+    glBlendFunc(source, destination);
+}
+
+// Call once the program has loaded, so the replayer can match its attribute locations
+inline void traced_load_program(CachedShaderProgram* program, const char* vertex_shader_path, const char* fragment_shader_path) {
+    PROFILE_SCOPE("CachedShaderProgram::load");  // Compiling and linking, or loading the cached binary
+    program->load(vertex_shader_path, fragment_shader_path);
+    if (g_gl_capture.is_recording()) g_gl_capture.record_program(program);
+}
+
+inline void traced_set_projection_matrix(CachedShaderProgram* program, const glm::mat4& matrix) {
+    if (g_gl_capture.is_recording()) g_gl_capture.record_matrix(TRACE_PROJECTION_MATRIX, matrix);
+    program->set_projection_matrix(matrix);
+}
+
+inline void traced_set_view_matrix(CachedShaderProgram* program, const glm::mat4& matrix) {
+    if (g_gl_capture.is_recording()) g_gl_capture.record_matrix(TRACE_VIEW_MATRIX, matrix);
+    program->set_view_matrix(matrix);
+}
+
+inline void traced_gen_texture(GLuint* texture) {
+    glGenTextures(1, texture);
+    if (g_gl_capture.is_recording()) g_gl_capture.record_gen_texture(*texture);
+}
+
+inline void traced_tex_image_2d(GLenum target, GLint level, GLint internal_format, GLsizei width, GLsizei height,
+    GLint border, GLenum format, GLenum type, const void* pixels) {
+    if (g_gl_capture.is_recording()) g_gl_capture.record_tex_image_2d(target, level, internal_format, width, height, format, type, pixels);
+    glTexImage2D(target, level, internal_format, width, height, border, format, type, pixels);
+}
+
+inline void traced_tex_parameteri(GLenum target, GLenum name, GLint value) {
+    if (g_gl_capture.is_recording()) g_gl_capture.record_tex_parameter(target, name, value);
+    glTexParameteri(target, name, value);
+}
+
+inline void traced_vertex_attrib_pointer(GLuint index, GLint components, GLenum type, GLboolean normalised,
+    GLsizei stride, const void* pointer) {
+    if (g_gl_capture.is_recording()) g_gl_capture.record_attribute_pointer(index, components, type, stride, pointer);
+    glVertexAttribPointer(index, components, type, normalised, stride, pointer);
+}
+
+inline void traced_enable_vertex_attrib_array(GLuint index) {
+    if (g_gl_capture.is_recording()) g_gl_capture.record_enable_attribute(index);
+    glEnableVertexAttribArray(index);
+}
+
+inline void traced_disable_vertex_attrib_array(GLuint index) {
+    if (g_gl_capture.is_recording()) g_gl_capture.record_disable_attribute(index);
+    glDisableVertexAttribArray(index);
+}
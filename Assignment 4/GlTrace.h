@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+
+// ––––– GL TRACE FORMAT ––––– //
+// Written by GlCapture and read by the replayer in "GL Replay", which keeps its own copy of this
+// file; bump GL_TRACE_VERSION whenever either copy changes. A trace is a GlTraceHeader followed
+// by commands, each a GlTraceCommand and then payload_bytes of arguments: the op's struct below,
+// followed by whatever variable-length data that struct describes. Native byte order.
+
+constexpr std::uint32_t GL_TRACE_MAGIC = 0x52544C47;  // "GLTR" read as little-endian
+constexpr std::uint32_t GL_TRACE_VERSION = 2;
+
+struct GlTraceHeader {
+    std::uint32_t magic;
+    std::uint32_t version;
+};
+
+enum GlTraceOp : std::uint16_t {
+    TRACE_SETUP_END = 1,        // No payload; everything before it runs once
+    TRACE_FRAME_END,            // No payload; one per SDL_GL_SwapWindow
+    TRACE_VIEWPORT,
+    TRACE_CLEAR_COLOR,
+    TRACE_CLEAR,
+    TRACE_ENABLE,
+    TRACE_BLEND_FUNC,
+    TRACE_PROGRAM,
+    TRACE_USE_PROGRAM,
+    TRACE_UNIFORM_MATRIX,
+    TRACE_GEN_TEXTURE,
+    TRACE_BIND_TEXTURE,
+    TRACE_TEX_IMAGE_2D,
+    TRACE_TEX_PARAMETER,
+    TRACE_ENABLE_ATTRIBUTE,
+    TRACE_DISABLE_ATTRIBUTE,
+    TRACE_ATTRIBUTE_DATA,
+    TRACE_DRAW_ARRAYS,
+    TRACE_BLEND_FUNC_SEPARATE,  // Version 2 onwards
+    TRACE_GEN_FRAMEBUFFER,
+    TRACE_BIND_FRAMEBUFFER,
+    TRACE_FRAMEBUFFER_TEXTURE
+};
+
+struct GlTraceCommand {
+    std::uint16_t op;
+    std::uint16_t reserved;
+    std::uint32_t payload_bytes;
+};
+
+enum GlTraceMatrix : std::uint32_t {
+    TRACE_MODEL_MATRIX,
+    TRACE_VIEW_MATRIX,
+    TRACE_PROJECTION_MATRIX
+};
+
+struct TraceViewport { std::int32_t x, y, width, height; };
+struct TraceClearColor { float red, green, blue, alpha; };
+struct TraceClear { std::uint32_t mask; };
+struct TraceEnable { std::uint32_t capability; };
+struct TraceBlendFunc { std::uint32_t source, destination; };
+struct TraceBlendFuncSeparate { std::uint32_t source_rgb, destination_rgb, source_alpha, destination_alpha; };
+
+// The shader itself is not captured; the replayer binds its own textured shader's attributes
+// to these locations so the recorded attribute indices still line up
+struct TraceProgram { std::uint32_t program, position_attribute, tex_coordinate_attribute; };
+struct TraceUseProgram { std::uint32_t program; };
+struct TraceUniformMatrix { std::uint32_t matrix; float values[16]; };
+
+struct TraceTexture { std::uint32_t texture; };
+struct TraceBindTexture { std::uint32_t target, texture; };
+
+// Followed by width * height * 4 bytes of pixels when format is GL_RGBA and type is
+// GL_UNSIGNED_BYTE, which is all load_texture uploads; other layouts are recorded without pixels
+struct TraceTexImage2D {
+    std::uint32_t target;
+    std::int32_t level, internal_format, width, height;
+    std::uint32_t format, type;
+};
+struct TraceTexParameter { std::uint32_t target, name; std::int32_t value; };
+
+struct TraceAttributeArray { std::uint32_t index; };
+
+// Client-side array contents as of the next draw, followed by components * vertex_count floats
+struct TraceAttributeData { std::uint32_t index; std::int32_t components, vertex_count; };
+struct TraceDrawArrays { std::uint32_t mode; std::int32_t first, count; };
+
+// Framebuffer 0 is the window's. Textures are attached by their recorded names.
+struct TraceFramebuffer { std::uint32_t framebuffer; };
+struct TraceBindFramebuffer { std::uint32_t target, framebuffer; };
+struct TraceFramebufferTexture { std::uint32_t target, attachment, texture_target, texture; std::int32_t level; };
@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include "InputLog.h"
+
+// File layout: "INPL", a version byte, then varints for the frame count and end tick,
+// then each frame as (tick delta, buttons) varints, about two bytes per button change.
+constexpr char INPUT_LOG_MAGIC[4] = { 'I', 'N', 'P', 'L' };
+
+// 3: bullets spawn, and hits land, at the end of the tick, and a bullet stops at the first skull
+// it hits; the file is laid out as in 2. 2: an entry only when the buttons change. 1: an entry
+// every frame. Older files would replay into a different game, so they are refused.
+constexpr std::uint8_t INPUT_LOG_VERSION = 3;
+
+static void write_varint(std::vector<std::uint8_t>& out, std::uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back((std::uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((std::uint8_t)value);
+}
+
+static bool read_varint(const std::vector<std::uint8_t>& in, std::size_t& cursor, std::uint32_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (cursor >= in.size()) return false;
+
+        std::uint8_t byte = in[cursor++];
+        value |= (std::uint32_t)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+void InputLog::record(std::uint32_t tick, std::uint16_t buttons) {
+    m_frames.push_back({ tick, buttons });
+    m_end_tick = tick;
+}
+
+bool InputLog::save(const char* filepath) const {
+    std::vector<std::uint8_t> bytes(INPUT_LOG_MAGIC, INPUT_LOG_MAGIC + 4);
+    bytes.push_back(INPUT_LOG_VERSION);
+    write_varint(bytes, (std::uint32_t)m_frames.size());
+    write_varint(bytes, m_end_tick);
+
+    std::uint32_t previous_tick = 0;
+    for (const InputFrame& frame : m_frames) {
+        write_varint(bytes, frame.tick - previous_tick);
+        write_varint(bytes, frame.buttons);
+        previous_tick = frame.tick;
+    }
+
+    std::ofstream file(filepath, std::ios::binary);
+    if (!file) return false;
+
+    file.write((const char*)bytes.data(), (std::streamsize)bytes.size());
+    return (bool)file;
+}
+
+bool InputLog::load(const char* filepath) {
+    std::ifstream file(filepath, std::ios::binary);
+    if (!file) {
+        m_error = "cannot open file";
+        return false;
+    }
+
+    std::vector<std::uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (bytes.size() < 5 || !std::equal(INPUT_LOG_MAGIC, INPUT_LOG_MAGIC + 4, bytes.begin())) {
+        m_error = "not an input recording";
+        return false;
+    }
+    if (bytes[4] != INPUT_LOG_VERSION) {
+        m_error = "recorded in format version " + std::to_string(bytes[4]) + ", this build replays version " +
+            std::to_string(INPUT_LOG_VERSION);
+        return false;
+    }
+
+    std::size_t cursor = 5;
+    std::uint32_t frame_count, end_tick;
+    if (!read_varint(bytes, cursor, frame_count) || !read_varint(bytes, cursor, end_tick)) {
+        m_error = "truncated";
+        return false;
+    }
+
+    // Every frame takes at least two bytes, so a larger count is corrupt; checked before reserving for it
+    if (frame_count > (bytes.size() - cursor) / 2) {
+        m_error = "truncated";
+        return false;
+    }
+
+    clear();
+    m_frames.reserve(frame_count);
+
+    std::uint32_t tick = 0;
+    for (std::uint32_t i = 0; i < frame_count; i++) {
+        std::uint32_t tick_delta, buttons;
+        if (!read_varint(bytes, cursor, tick_delta) || !read_varint(bytes, cursor, buttons)) {
+            m_error = "truncated";
+            return false;
+        }
+
+        tick += tick_delta;
+        m_frames.push_back({ tick, (std::uint16_t)buttons });
+    }
+
+    m_end_tick = end_tick;
+    m_error.clear();
+    return true;
+}
+
+std::uint64_t hash_bytes(const void* data, std::size_t size, std::uint64_t hash) {
+    const std::uint8_t* bytes = (const std::uint8_t*)data;
+    for (std::size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// ––––– INPUT COMMANDS ––––– //
+// Buttons sampled by process_input(), stamped with the first simulation tick allowed to see
+// them. update_tick() drains every command due by its tick, so render frames can run faster
+// or slower than the fixed step without changing how far anything moves or burns per second.
+struct InputCommand {
+    std::uint32_t tick;
+    std::uint16_t buttons;
+};
+
+// Single-producer, single-consumer ring. Neither side blocks or allocates, so sampling can
+// move to its own thread without the simulation taking a lock.
+class InputQueue {
+private:
+    static constexpr std::size_t CAPACITY = 256;  // Must be a power of two
+
+    InputCommand m_commands[CAPACITY];
+    std::atomic<std::size_t> m_head{ 0 };  // Next slot to read, written only by the consumer
+    std::atomic<std::size_t> m_tail{ 0 };  // Next slot to write, written only by the producer
+
+public:
+    // Producer side. Returns false and drops the command if the consumer is CAPACITY behind.
+    bool push(const InputCommand& command);
+
+    // Consumer side. Pops the oldest command stamped at or before tick, if there is one.
+    bool pop_due(std::uint32_t tick, InputCommand& command);
+
+    // Consumer side. Drops every pending command, for when the simulation jumps to another tick.
+    void clear() { m_head.store(m_tail.load(std::memory_order_acquire), std::memory_order_release); }
+
+    bool is_empty() const { return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire); }
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "glm/mat4x4.hpp"
+#include "CachedShaderProgram.h"
+#include "GlCapture.h"
+#include "TextureResidency.h"
+
+// ––––– GL CALL COUNTERS ––––– //
+struct GlCallCounters {
+    int draw_calls = 0;
+    int texture_binds = 0;
+    int program_binds = 0;
+    int uniform_uploads = 0;
+};
+
+extern GlCallCounters g_gl_counters;
+
+// Stand-ins for the GL calls made by Entity::render and draw_text, counted for the HUD and
+// recorded while a GL capture is running. Binds also tell the texture residency (TextureResidency.h)
+// which textures are in use.
+inline void counted_draw_arrays(GLenum mode, GLint first, GLsizei count) {
+    g_gl_counters.draw_calls++;
+    if (g_gl_capture.is_recording()) g_gl_capture.record_draw_arrays(mode, first, count);
+    glDrawArrays(mode, first, count);
+}
+
+inline void counted_bind_texture(GLenum target, GLuint texture) {
+    g_gl_counters.texture_binds++;
+    g_texture_residency.touch(texture);
+    if (g_gl_capture.is_recording()) g_gl_capture.record_bind_texture(target, texture);
+    glBindTexture(target, texture);
+}
+
+inline void counted_use_program(GLuint program) {
+    g_gl_counters.program_binds++;
+    if (g_gl_capture.is_recording()) g_gl_capture.record_use_program(program);
+    glUseProgram(program);
+}
+
+inline void counted_set_model_matrix(CachedShaderProgram* program, const glm::mat4& matrix) {
+    g_gl_counters.uniform_uploads++;
+    if (g_gl_capture.is_recording()) g_gl_capture.record_matrix(TRACE_MODEL_MATRIX, matrix);
+    program->set_model_matrix(matrix);
+}
+
+// ––––– PERFORMANCE HUD ––––– //
+// Frame time history, the GL calls counted between begin_frame() and end_frame(), and GPU
+// time from GL_TIME_ELAPSED queries where the driver has them. The caller draws the lines
+// it returns with its own bitmap font, after end_frame() so the HUD does not count itself.
+class PerfHud {
+private:
+    static constexpr int HISTORY_LENGTH = 240;
+    static constexpr int QUERY_COUNT = 4;  // Results are read a few frames late so the CPU never waits
+
+    float m_frame_milliseconds[HISTORY_LENGTH] = {};
+    int m_history_count = 0;
+    int m_history_cursor = 0;
+    std::uint64_t m_frame_start = 0;
+
+    GlCallCounters m_frame_counters;
+
+    bool m_gpu_timer_available = false;
+    GLuint m_queries[QUERY_COUNT] = {};
+    bool m_query_pending[QUERY_COUNT] = {};
+    int m_query_index = 0;
+    bool m_query_active = false;
+    float m_gpu_milliseconds = -1.0f;
+
+    bool m_visible = false;
+
+    void collect_gpu_results();
+
+public:
+    // Needs a current GL context; checks for timer query support
+    void initialise();
+    void shutdown();
+
+    void begin_frame();
+    void end_frame();
+
+    void toggle() { m_visible = !m_visible; }
+    bool is_visible() const { return m_visible; }
+
+    // Frame time in milliseconds at the given fraction (0.5 for the median) of the history
+    float get_percentile(float fraction) const;
+    float get_last_frame_milliseconds() const;
+
+    // GPU time of the most recent frame whose timer query has come back, or -1 without timer queries
+    float get_gpu_milliseconds() const { return m_gpu_timer_available ? m_gpu_milliseconds : -1.0f; }
+
+    std::vector<std::string> get_text_lines() const;
+
+    // Bar graph of the most recent frames, one character per frame, top row first
+    std::vector<std::string> get_graph_rows(int columns, int rows) const;
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "AllocTracker.h"
+
+// ––––– PROFILER ––––– //
+// Scoped timing zones, written to a per-thread ring buffer and exported as Chrome trace_event
+// JSON (open it in chrome://tracing or ui.perfetto.dev). Build with -DENABLE_PROFILER to turn
+// it on; otherwise every macro below expands to nothing and no profiler code is compiled.
+// Zones also name allocations for the allocation tracker when that is built in.
+//
+//     void update() {
+//         PROFILE_SCOPE("update");
+//         ...
+//     }
+
+#ifdef ENABLE_PROFILER
+
+#include <cstdint>
+
+constexpr int PROFILE_RING_CAPACITY = 1 << 16;  // Zones kept per thread; older ones are overwritten
+
+std::uint64_t profiler_now_ns();
+void profiler_record(const char* name, std::uint64_t start_ns, std::uint64_t end_ns);
+
+// Writes every zone still in the rings. Call it while other profiled threads are idle.
+bool profiler_write_chrome_trace(const char* filepath);
+
+class ProfileZone {
+private:
+    const char* m_name;  // Must outlive the trace, e.g. a string literal
+    std::uint64_t m_start_ns;
+
+public:
+    explicit ProfileZone(const char* name) : m_name(name), m_start_ns(profiler_now_ns()) {}
+    ~ProfileZone() { profiler_record(m_name, m_start_ns, profiler_now_ns()); }
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileZone PROFILE_CONCAT(profile_zone_, __LINE__)(name); ALLOC_ZONE(name)
+#define PROFILE_WRITE_TRACE(filepath) profiler_write_chrome_trace(filepath)
+
+#else
+
+#define PROFILE_SCOPE(name) ALLOC_ZONE(name)
+#define PROFILE_WRITE_TRACE(filepath) ((void)(filepath), false)
+
+#endif
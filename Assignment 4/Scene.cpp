@@ -0,0 +1,239 @@
+#include <cstdio>
+#include <cstring>
+#include "Behaviour.h"
+#include "Scene.h"
+
+#ifdef _WINDOWS
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// ––––– COMPILING ––––– //
+void build_scene_image(const ScenePlayer& player, const std::int32_t animations[SCENE_DIRECTIONS][SCENE_ANIMATION_FRAMES],
+    const SceneSkull* skulls, std::size_t skull_count, std::vector<std::uint8_t>& image) {
+    SceneHeader header = {};
+    header.magic = SCENE_MAGIC;
+    header.version = SCENE_VERSION;
+    header.player = player;
+    std::memcpy(header.animations, animations, sizeof(header.animations));
+    header.skull_count = (std::uint32_t)skull_count;
+    header.skull_offset = sizeof(SceneHeader);
+
+    image.resize(sizeof(SceneHeader) + skull_count * sizeof(SceneSkull));
+    std::memcpy(image.data(), &header, sizeof(header));
+    if (skull_count > 0) std::memcpy(image.data() + header.skull_offset, skulls, skull_count * sizeof(SceneSkull));
+}
+
+static int parse_direction(const char* name) {
+    const char* names[SCENE_DIRECTIONS] = { "left", "right", "up", "down" };
+    for (int i = 0; i < SCENE_DIRECTIONS; i++) {
+        if (std::strcmp(name, names[i]) == 0) return i;
+    }
+    return -1;
+}
+
+static int parse_behaviour(const char* name) {
+    if (std::strcmp(name, "patrol") == 0) return PATROL;
+    if (std::strcmp(name, "bounce_and_chase") == 0) return BOUNCE_AND_CHASE;
+    if (std::strcmp(name, "chase") == 0) return CHASE;
+    return -1;
+}
+
+bool compile_scene(const char* text, std::vector<std::uint8_t>& image, std::string& error) {
+    ScenePlayer player = { 0.0f, 0.0f, 1.0f };
+    std::int32_t animations[SCENE_DIRECTIONS][SCENE_ANIMATION_FRAMES] = {};
+    std::vector<SceneSkull> skulls;
+
+    int line_number = 0;
+    for (const char* line = text; *line != '\0';) {
+        const char* line_end = std::strchr(line, '\n');
+        std::size_t length = line_end != nullptr ? (std::size_t)(line_end - line) : std::strlen(line);
+        line_number++;
+
+        char buffer[256];
+        if (length >= sizeof(buffer)) {
+            error = "line " + std::to_string(line_number) + ": too long";
+            return false;
+        }
+        std::memcpy(buffer, line, length);
+        buffer[length] = '\0';
+        line = line_end != nullptr ? line_end + 1 : line + length;
+
+        char* comment = std::strchr(buffer, '#');
+        if (comment != nullptr) *comment = '\0';
+
+        char keyword[32], name[32];
+        if (std::sscanf(buffer, "%31s", keyword) != 1) continue;  // Blank
+
+        bool is_valid = false;
+        if (std::strcmp(keyword, "player") == 0) {
+            is_valid = std::sscanf(buffer, "%*s %f %f %f", &player.x, &player.y, &player.speed) == 3;
+        }
+        else if (std::strcmp(keyword, "animation") == 0) {
+            std::int32_t frames[SCENE_ANIMATION_FRAMES];
+            int direction = -1;
+            if (std::sscanf(buffer, "%*s %31s %d %d %d %d", name, &frames[0], &frames[1], &frames[2], &frames[3]) == 5) {
+                direction = parse_direction(name);
+            }
+            if (direction >= 0) {
+                std::memcpy(animations[direction], frames, sizeof(frames));
+                is_valid = true;
+            }
+        }
+        else if (std::strcmp(keyword, "skull") == 0) {
+            SceneSkull skull;
+            int behaviour = -1;
+            if (std::sscanf(buffer, "%*s %f %f %f %31s", &skull.x, &skull.y, &skull.speed, name) == 4) {
+                behaviour = parse_behaviour(name);
+            }
+            if (behaviour >= 0) {
+                skull.behaviour = (std::uint32_t)behaviour;
+                skulls.push_back(skull);
+                is_valid = true;
+            }
+        }
+
+        if (!is_valid) {
+            error = "line " + std::to_string(line_number) + ": cannot read '" + keyword + "' record";
+            return false;
+        }
+    }
+
+    build_scene_image(player, animations, skulls.data(), skulls.size(), image);
+    return true;
+}
+
+// ––––– LOADING ––––– //
+SceneFile::~SceneFile() {
+    close();
+}
+
+bool SceneFile::validate() {
+    if (m_size < sizeof(SceneHeader)) {
+        m_error = "too small to be a scene";
+        return false;
+    }
+
+    const SceneHeader& header = get_header();
+    if (header.magic != SCENE_MAGIC || header.version != SCENE_VERSION) {
+        m_error = "not a version " + std::to_string(SCENE_VERSION) + " scene";
+        return false;
+    }
+
+    if (header.skull_offset < sizeof(SceneHeader) || header.skull_offset % alignof(SceneSkull) != 0 || header.skull_offset > m_size
+        || header.skull_count > (m_size - header.skull_offset) / sizeof(SceneSkull)) {
+        m_error = "skulls lie outside the file";
+        return false;
+    }
+
+    for (const std::int32_t* frame = &header.animations[0][0]; frame != &header.animations[0][0] + SCENE_DIRECTIONS * SCENE_ANIMATION_FRAMES; frame++) {
+        if (*frame < 0 || *frame >= SCENE_DIRECTIONS * SCENE_ANIMATION_FRAMES) {
+            m_error = "animation frame out of range";
+            return false;
+        }
+    }
+
+    const SceneSkull* skulls = get_skulls();
+    for (std::size_t i = 0; i < header.skull_count; i++) {
+        if (skulls[i].behaviour > CHASE) {
+            m_error = "skull " + std::to_string(i) + " has an unknown behaviour";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool SceneFile::open(const char* filepath) {
+    close();
+    m_error.clear();
+
+#ifdef _WINDOWS
+    HANDLE file = CreateFileA(filepath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    LARGE_INTEGER file_size;
+    if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        m_error = "cannot open file";
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* address = mapping != nullptr ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (mapping != nullptr) CloseHandle(mapping);  // The view keeps the mapping alive
+    CloseHandle(file);
+    if (address == nullptr) {
+        m_error = "cannot map file";
+        return false;
+    }
+    std::size_t size = (std::size_t)file_size.QuadPart;
+#else
+    int file = ::open(filepath, O_RDONLY);
+    struct stat status;
+    if (file < 0 || fstat(file, &status) != 0 || status.st_size == 0) {
+        if (file >= 0) ::close(file);
+        m_error = "cannot open file";
+        return false;
+    }
+
+    std::size_t size = (std::size_t)status.st_size;
+    void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+    ::close(file);  // The mapping stays valid without the descriptor
+    if (address == MAP_FAILED) {
+        m_error = "cannot map file";
+        return false;
+    }
+#endif
+
+    m_mapping = address;
+    m_data = static_cast<const std::uint8_t*>(address);
+    m_size = size;
+
+    // Anything without the magic number is taken as text and compiled; the mapping is not needed after
+    std::uint32_t magic = 0;
+    if (size >= sizeof(magic)) std::memcpy(&magic, m_data, sizeof(magic));
+    if (magic != SCENE_MAGIC) {
+        std::string text(reinterpret_cast<const char*>(m_data), size);
+        close();
+
+        std::vector<std::uint8_t> image;
+        if (!compile_scene(text.c_str(), image, m_error)) return false;
+        return open_image(std::move(image));
+    }
+
+    if (validate()) return true;
+    close();
+    return false;
+}
+
+bool SceneFile::open_image(std::vector<std::uint8_t> image) {
+    close();
+    m_error.clear();
+
+    m_compiled = std::move(image);
+    m_data = m_compiled.data();
+    m_size = m_compiled.size();
+
+    if (validate()) return true;
+    close();
+    return false;
+}
+
+void SceneFile::close() {
+    if (m_mapping != nullptr) {
+#ifdef _WINDOWS
+        UnmapViewOfFile(m_mapping);
+#else
+        munmap(m_mapping, m_size);
+#endif
+        m_mapping = nullptr;
+    }
+
+    m_compiled.clear();
+    m_compiled.shrink_to_fit();
+    m_data = nullptr;
+    m_size = 0;
+}
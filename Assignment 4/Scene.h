@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ––––– SCENE FILES ––––– //
+// A level is written as text and compiled to a flat binary image that is mapped into memory and
+// read in place: sections are found by byte offsets from the start of the image, never by
+// pointers, so opening one costs a map and one pass of checks over the records, with no parsing.
+//
+// Text form, one record per line; # starts a comment:
+//
+//     player <x> <y> <speed>
+//     animation <left|right|up|down> <frame> <frame> <frame> <frame>
+//     skull <x> <y> <speed> <patrol|bounce_and_chase|chase>
+//
+// Binary form: a SceneHeader, then the skulls as SceneSkull records at skull_offset. Every field
+// is 4 bytes in the machine's byte order, so an image only moves between machines that agree.
+// --compile-scene turns the first into the second; open() takes either.
+
+constexpr std::uint32_t SCENE_MAGIC = 0x4E435352;  // "RSCN"
+constexpr std::uint32_t SCENE_VERSION = 1;
+constexpr int SCENE_DIRECTIONS = 4;        // LEFT, RIGHT, UP, DOWN, as in main.cpp
+constexpr int SCENE_ANIMATION_FRAMES = 4;
+
+struct ScenePlayer {
+    float x, y;
+    float speed;
+};
+
+struct SceneSkull {
+    float x, y;
+    float speed;
+    std::uint32_t behaviour;  // A BehaviourType
+};
+
+struct SceneHeader {
+    std::uint32_t magic;
+    std::uint32_t version;
+    ScenePlayer player;
+    std::int32_t animations[SCENE_DIRECTIONS][SCENE_ANIMATION_FRAMES];  // Sprite sheet frames for each direction
+    std::uint32_t skull_count;
+    std::uint32_t skull_offset;  // Bytes from the start of the image
+};
+
+// Lays out an image from parts already in memory
+void build_scene_image(const ScenePlayer& player, const std::int32_t animations[SCENE_DIRECTIONS][SCENE_ANIMATION_FRAMES],
+    const SceneSkull* skulls, std::size_t skull_count, std::vector<std::uint8_t>& image);
+
+// Compiles the text form. On failure returns false with the line and the problem in error.
+bool compile_scene(const char* text, std::vector<std::uint8_t>& image, std::string& error);
+
+class SceneFile {
+private:
+    const std::uint8_t* m_data = nullptr;
+    std::size_t m_size = 0;
+    std::vector<std::uint8_t> m_compiled;  // Holds the image when it was compiled from text
+    void* m_mapping = nullptr;             // Non-null while m_data points into a mapped file
+    std::string m_error;
+
+    bool validate();
+
+public:
+    SceneFile() = default;
+    ~SceneFile();
+
+    SceneFile(const SceneFile&) = delete;
+    SceneFile& operator=(const SceneFile&) = delete;
+
+    // Maps a binary image, or compiles a text file into memory
+    bool open(const char* filepath);
+
+    // Takes an image already in memory, e.g. from build_scene_image
+    bool open_image(std::vector<std::uint8_t> image);
+
+    void close();
+
+    bool is_open() const { return m_data != nullptr; }
+    const std::string& get_error() const { return m_error; }
+    std::size_t get_size() const { return m_size; }
+
+    // Only while open
+    const SceneHeader& get_header() const { return *reinterpret_cast<const SceneHeader*>(m_data); }
+    const SceneSkull* get_skulls() const { return reinterpret_cast<const SceneSkull*>(m_data + get_header().skull_offset); }
+    std::size_t get_skull_count() const { return get_header().skull_count; }
+};
@@ -22,11 +22,32 @@
 #include <SDL_opengl.h>
 #include "glm/mat4x4.hpp"
 #include "glm/gtc/matrix_transform.hpp"
-#include "ShaderProgram.h"
+#include "CachedShaderProgram.h"
 #include "stb_image.h"
 #include <vector>
+#include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include "AllocTracker.h"
+#include "DynamicResolution.h"
 #include "Entity.h"
+#include "EntityCommands.h"
+#include "Behaviour.h"
+#include "Benchmark.h"
+#include "CollisionMask.h"
+#include "FlowField.h"
+#include "FrameArena.h"
+#include "InputLog.h"
+#include "InputQueue.h"
+#include "PerfHud.h"
+#include "Profiler.h"
+#include "Scene.h"
+#include "Snapshot.h"
 
 enum AppStatus { RUNNING, TERMINATED };
 
@@ -46,11 +67,8 @@ F_SHADER_PATH[] = "shaders/fragment_textured.glsl";
 constexpr float MILLISECONDS_IN_SECOND = 1000.0f;
 constexpr char SPRITESHEET_FILEPATH[] = "Butterfly_Anim_Sprite_Sheet.png",
 FONTSHEET_FILEPATH[] = "LLPixel_Fonts_Sprite_Sheet.png",
-SKULL_FILEPATH[] = "Skull_a1.png";
-
-constexpr GLint NUMBER_OF_TEXTURES = 1,
-LEVEL_OF_DETAIL = 0,
-TEXTURE_BORDER = 0;
+SKULL_FILEPATH[] = "Skull_a1.png",
+BULLET_FILEPATH[] = "platform.png";
 
 constexpr int LEFT = 0,
 RIGHT = 1,
@@ -60,6 +78,13 @@ DOWN = 3;
 constexpr int FONTBANK_SIZE_U = 16;
 constexpr int FONTBANK_SIZE_V = 7;
 
+// Buttons sampled by process_input(), one bit each so a frame's input fits in an InputFrame
+constexpr Uint16 INPUT_LEFT = 1 << 0,
+INPUT_RIGHT = 1 << 1,
+INPUT_UP = 1 << 2,
+INPUT_DOWN = 1 << 3,
+INPUT_FIRE = 1 << 4;
+
 int g_george_walking[SPRITESHEET_DIMENSIONS][SPRITESHEET_DIMENSIONS] =
 {
     { 1, 5, 9,  13 }, // for Butterfly to move to the left,
@@ -71,82 +96,155 @@ int g_george_walking[SPRITESHEET_DIMENSIONS][SPRITESHEET_DIMENSIONS] =
 GLuint g_george_texture_id;
 GLuint g_font_texture_id;
 GLuint g_skull_texture_id;
+GLuint g_bullet_texture_id;
 
 float g_player_speed = 1.0f;  // move 1 unit per second
 
+// ––––– SKULLS ––––– //
+// The built-in level, used without --scene; Rise.scene is the same level as a scene file.
+// Behaviour parameters come from the constants below.
+const ScenePlayer PLAYER_SPAWN = { 0.0f, 0.0f, 1.25f };
+const SceneSkull SKULL_SPAWNS[] = {
+    { -4.0f, -3.0f, 1.0f, PATROL },            // Square pattern movement
+    { -4.5f, 3.0f, 1.0f, BOUNCE_AND_CHASE },   // Turns at screen edges, chases when close
+    { 4.0f, 3.0f, 1.5f, CHASE }                // Chases butterfly from the start
+};
+static_assert(sizeof(g_george_walking) == sizeof(SceneHeader::animations), "Scene animations must fill g_george_walking");
+
+// Set by --scene, and read in place by initialise_scene
+SceneFile g_scene;
+const char* g_scene_filepath = nullptr;
+
+const glm::vec3 BULLET_SCALE(0.2f, 0.2f, 1.0f);
+constexpr float BULLET_SPEED = 2.0f;
+constexpr int BULLET_CAPACITY = 256;  // Initial reservation, not a cap: held fire adds a bullet every tick and can outgrow it
+
+constexpr float PATROL_TURN_INTERVAL = 1.0f;  // Change direction every 1 second
+constexpr float CHASE_RADIUS = 1.5f;
+
 Entity* g_butterfly;
-Entity* g_skull1;
-Entity* g_skull2;
-Entity* g_skull3;
-std::vector<Entity*> g_bullets;
+std::vector<Entity> g_skulls;
+std::vector<Entity> g_bullets;  // Held by value and compacted in place, so none are allocated per shot
+
+// Spawns, destroys and hits recorded during the tick, applied together at its sync point
+EntityCommandBuffer g_skull_commands;
+EntityCommandBuffer g_bullet_commands;
+
+BehaviourSystem g_skull_behaviours({ -5.0f, 5.0f, -3.75f, 3.75f });
+
+// Pixel-perfect collision shapes, one per sprite frame
+std::vector<CollisionMask> g_butterfly_masks;
+std::vector<CollisionMask> g_skull_masks;
+std::vector<CollisionMask> g_bullet_masks;
+
+// Shared pursuit field toward the butterfly for every chasing skull; searched again only when
+// the butterfly enters a new cell, and repaired locally where an obstacle changes
+constexpr float PURSUIT_CELL_SIZE = 0.25f;
+FlowField g_pursuit_field(glm::vec3(-5.0f, -3.75f, 0.0f), 10.0f, 7.5f, PURSUIT_CELL_SIZE);
 
 SDL_Window* g_display_window = nullptr;
 AppStatus g_app_status = RUNNING;
 
-ShaderProgram g_shader_program = ShaderProgram();
+CachedShaderProgram g_shader_program = CachedShaderProgram();
 
 glm::mat4 g_view_matrix, g_projection_matrix;
 
 float g_previous_ticks = 0.0f;
 float g_accumulator = 0.0f;
-float g_skull1_move_timer = 0.0f;
-int g_skull1_direction = RIGHT;
+Uint32 g_tick = 0;  // Fixed-step ticks simulated so far
+
+// Sampled input waits here until the tick it is stamped for
+InputQueue g_input_queue;
+Uint16 g_held_buttons = 0;  // What the simulation sees held this tick
+
+// Input recording and replay
+InputLog g_input_log;
+const char* g_record_filepath = nullptr;
+
+// F3 toggles the frame time and GL call overlay
+PerfHud g_perf_hud;
+const glm::vec3 HUD_ORIGIN(-4.8f, 3.55f, 0.0f);
+constexpr float HUD_FONT_SIZE = 0.2f,
+HUD_GRAPH_CELL_SIZE = 0.08f;
+constexpr int HUD_GRAPH_COLUMNS = 60,
+HUD_GRAPH_ROWS = 8;
+
+// Chrome trace of the profiler zones, written on F9 and at exit when built with ENABLE_PROFILER
+const char* g_profile_filepath = "profile.json";
+
+constexpr int GL_CAPTURE_FRAMES = 300;
+const char* g_gl_capture_filepath = nullptr;
+
+// --dynamic-resolution draws the scene at a lower resolution while frames run over budget
+DynamicResolution g_dynamic_resolution;
+ResolutionSettings g_resolution_settings;
+bool g_use_dynamic_resolution = false;
+float g_swap_milliseconds = 0.0f;  // Spent in the last SDL_GL_SwapWindow, mostly waiting for the display
 
 bool g_game_over = false;
 bool g_player_won = false;
 
+// F5 keeps a snapshot of the game (in g_state_filepath too, when given) and F8 goes back to it.
+// One is taken as the game starts, so F8 before any F5 restarts the game.
+constexpr float SNAPSHOT_POSITION_RANGE = 8.0f;  // Quantized positions cover +/- this
+constexpr int SNAPSHOT_POSITION_BITS = 16;
+constexpr int SNAPSHOT_MAX_COUNT = 65535;
+SnapshotStream g_snapshot_stream;
+std::vector<std::uint8_t> g_quick_save;
+std::vector<std::uint8_t> g_state_backup;
+const char* g_state_filepath = nullptr;
+
 GLuint load_texture(const char* filepath);
 void initialise();
+void initialise_scene();
+void spawn_skulls(const SceneSkull* spawns, int count);
 void process_input();
+void apply_input(Uint16 buttons);
 void update();
+void update_tick();
 void render();
+void render_perf_hud();
 void shutdown();
-bool is_nearby(glm::vec3 pos1, glm::vec3 pos2, float distance);
+void load_collision_masks(const char* filepath, int cols, int rows, glm::vec3 scale, std::vector<CollisionMask>& masks);
+bool sprites_collide(const Entity* a, const CollisionMask& a_mask, const Entity* b, const CollisionMask& b_mask);
 void remove_offscreen_bullets();
-void move_skull2(Entity* skull, float delta_time, const Entity* butterfly);
 void check_bullet_collisions();
 void check_game_over();
+void serialize_game_state(SnapshotStream& stream);
+void start_snapshots();
+void quick_save();
+void quick_load();
+void build_stress_scene(int count);
 
 
 GLuint load_texture(const char* filepath) {
-    int width, height, number_of_components;
-    unsigned char* image = stbi_load(filepath, &width, &height, &number_of_components, STBI_rgb_alpha);
+    PROFILE_SCOPE("load_texture");
+    GLuint textureID = g_texture_residency.load(filepath);
 
-    if (image == NULL) {
+    if (textureID == 0) {
         LOG("Unable to load image. Make sure the path is correct.");
         assert(false);
     }
 
-    GLuint textureID;
-    glGenTextures(NUMBER_OF_TEXTURES, &textureID);
-
-    glBindTexture(GL_TEXTURE_2D, textureID);
-    glTexImage2D(GL_TEXTURE_2D, LEVEL_OF_DETAIL, GL_RGBA, width, height, TEXTURE_BORDER,
-        GL_RGBA, GL_UNSIGNED_BYTE, image);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-
-    stbi_image_free(image);
-
     return textureID;
 }
 
-void draw_text(ShaderProgram* shader_program, GLuint font_texture_id, std::string text,
-    float font_size, float spacing, glm::vec3 position)
+// Quads and UVs for a line of text in the font sheet, one character after another
+void build_text_mesh(const char* text, float font_size, float spacing,
+    FrameVector<float>& vertices, FrameVector<float>& texture_coordinates)
 {
     // Scale the size of the fontbank in the UV-plane
     // We will use this for spacing and positioning
     float width = 1.0f / FONTBANK_SIZE_U;
     float height = 1.0f / FONTBANK_SIZE_V;
 
-    std::vector<float> vertices;
-    std::vector<float> texture_coordinates;
+    int length = (int)std::strlen(text);
+    vertices.clear();
+    texture_coordinates.clear();
+    vertices.reserve(length * 12);
+    texture_coordinates.reserve(length * 12);
 
-    for (int i = 0; i < text.size(); i++) {
+    for (int i = 0; i < length; i++) {
         int spritesheet_index = (int)text[i] - 18;
 
         float offset = (font_size + spacing) * i;
@@ -172,29 +270,39 @@ void draw_text(ShaderProgram* shader_program, GLuint font_texture_id, std::strin
             u_coordinate, v_coordinate + height,
             });
     }
+}
+
+void draw_text(CachedShaderProgram* shader_program, GLuint font_texture_id, const char* text,
+    float font_size, float spacing, glm::vec3 position)
+{
+    PROFILE_SCOPE("draw_text");
+    FrameVector<float> vertices;
+    FrameVector<float> texture_coordinates;
+    build_text_mesh(text, font_size, spacing, vertices, texture_coordinates);
 
     glm::mat4 model_matrix = glm::mat4(1.0f);
     model_matrix = glm::translate(model_matrix, position);
 
-    shader_program->set_model_matrix(model_matrix);
-    glUseProgram(shader_program->get_program_id());
+    counted_set_model_matrix(shader_program, model_matrix);
+    counted_use_program(shader_program->get_program_id());
 
-    glVertexAttribPointer(shader_program->get_position_attribute(), 2, GL_FLOAT, false, 0,
+    traced_vertex_attrib_pointer(shader_program->get_position_attribute(), 2, GL_FLOAT, false, 0,
         vertices.data());
-    glEnableVertexAttribArray(shader_program->get_position_attribute());
+    traced_enable_vertex_attrib_array(shader_program->get_position_attribute());
 
-    glVertexAttribPointer(shader_program->get_tex_coordinate_attribute(), 2, GL_FLOAT,
+    traced_vertex_attrib_pointer(shader_program->get_tex_coordinate_attribute(), 2, GL_FLOAT,
         false, 0, texture_coordinates.data());
-    glEnableVertexAttribArray(shader_program->get_tex_coordinate_attribute());
+    traced_enable_vertex_attrib_array(shader_program->get_tex_coordinate_attribute());
 
-    glBindTexture(GL_TEXTURE_2D, font_texture_id);
-    glDrawArrays(GL_TRIANGLES, 0, (int)(text.size() * 6));
+    counted_bind_texture(GL_TEXTURE_2D, font_texture_id);
+    counted_draw_arrays(GL_TRIANGLES, 0, (int)(vertices.size() / 2));
 
-    glDisableVertexAttribArray(shader_program->get_position_attribute());
-    glDisableVertexAttribArray(shader_program->get_tex_coordinate_attribute());
+    traced_disable_vertex_attrib_array(shader_program->get_position_attribute());
+    traced_disable_vertex_attrib_array(shader_program->get_tex_coordinate_attribute());
 }
 
 void initialise() {
+    PROFILE_SCOPE("initialise");
     SDL_Init(SDL_INIT_VIDEO);
     g_display_window = SDL_CreateWindow("Butterfly & Skulls Interaction",
         SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
@@ -213,84 +321,181 @@ void initialise() {
     glewInit();
 #endif
 
-    glViewport(VIEWPORT_X, VIEWPORT_Y, VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
+    traced_viewport(VIEWPORT_X, VIEWPORT_Y, VIEWPORT_WIDTH, VIEWPORT_HEIGHT);
 
-    g_shader_program.load(V_SHADER_PATH, F_SHADER_PATH);
+    traced_load_program(&g_shader_program, V_SHADER_PATH, F_SHADER_PATH);
 
     g_view_matrix = glm::mat4(1.0f);
     g_projection_matrix = glm::ortho(-5.0f, 5.0f, -3.75f, 3.75f, -1.0f, 1.0f);
 
-    g_shader_program.set_projection_matrix(g_projection_matrix);
-    g_shader_program.set_view_matrix(g_view_matrix);
+    traced_set_projection_matrix(&g_shader_program, g_projection_matrix);
+    traced_set_view_matrix(&g_shader_program, g_view_matrix);
 
-    glUseProgram(g_shader_program.get_program_id());
+    counted_use_program(g_shader_program.get_program_id());
 
-    glClearColor(BG_RED, BG_BLUE, BG_GREEN, BG_OPACITY);
+    traced_clear_color(BG_RED, BG_BLUE, BG_GREEN, BG_OPACITY);
 
     g_george_texture_id = load_texture(SPRITESHEET_FILEPATH);
     g_font_texture_id = load_texture(FONTSHEET_FILEPATH);
     g_skull_texture_id = load_texture(SKULL_FILEPATH);
+    g_bullet_texture_id = load_texture(BULLET_FILEPATH);
 
-    // Initializing the butterfly entity
-    g_butterfly = new Entity(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(0.0f), g_george_texture_id, 1.25f);
-    g_butterfly->set_animation(g_george_walking[DOWN], SPRITESHEET_DIMENSIONS);
+    initialise_scene();
+
+    traced_enable(GL_BLEND);
+    traced_blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    g_perf_hud.initialise();
+    if (g_use_dynamic_resolution) g_dynamic_resolution.initialise(VIEWPORT_WIDTH, VIEWPORT_HEIGHT, g_resolution_settings);
+}
+
+// Builds a mask for every frame of a sprite sheet from its alpha channel; no GL needed
+void load_collision_masks(const char* filepath, int cols, int rows, glm::vec3 scale, std::vector<CollisionMask>& masks) {
+    masks.assign(cols * rows, CollisionMask());
 
-    // Initializing the first skull entity (square pattern movement)
-    g_skull1 = new Entity(glm::vec3(-4.0f, -3.0f, 0.0f), glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(0.0f), g_skull_texture_id, 1.0f);
+    int width, height, number_of_components;
+    unsigned char* image = stbi_load(filepath, &width, &height, &number_of_components, STBI_rgb_alpha);
 
-    // Initializing the second skull entity (turns at screen edges)
-    g_skull2 = new Entity(glm::vec3(-4.5f, 3.0f, 0.0f), glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(0.0f), g_skull_texture_id, 1.0f);
+    if (image == NULL) {
+        LOG("Unable to load collision mask. Make sure the path is correct.");
+        return;
+    }
 
-    // Initializing the third skull entity (chases butterfly from the start)
-    g_skull3 = new Entity(glm::vec3(4.0f, 3.0f, 0.0f), glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(0.0f), g_skull_texture_id, 1.5f);
+    int frame_width = width / cols, frame_height = height / rows;
+    for (int i = 0; i < cols * rows; i++) {
+        masks[i].build(image, width, height, (i % cols) * frame_width, (i / cols) * frame_height,
+            frame_width, frame_height, scale.x, scale.y);
+    }
 
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    stbi_image_free(image);
 }
 
-void process_input() {
-    if (g_game_over) return;  // Stop processing input if the game is over
+// Everything the simulation needs, with no window or GL calls, so replays can run headless
+void initialise_scene() {
+    load_collision_masks(SPRITESHEET_FILEPATH, SPRITESHEET_DIMENSIONS, SPRITESHEET_DIMENSIONS, glm::vec3(1.0f, 1.0f, 1.0f), g_butterfly_masks);
+    load_collision_masks(SKULL_FILEPATH, 1, 1, glm::vec3(1.0f, 1.0f, 1.0f), g_skull_masks);
+    load_collision_masks(BULLET_FILEPATH, 1, 1, BULLET_SCALE, g_bullet_masks);
+    g_bullets.reserve(BULLET_CAPACITY);
+
+    // A tick can at most destroy every bullet twice over (off screen and a hit) and hit a skull with each
+    g_bullet_commands.reserve(2 * BULLET_CAPACITY, 1);
+    g_skull_commands.reserve(BULLET_CAPACITY, 0);
+
+    // Initializing the butterfly entity
+    ScenePlayer player = PLAYER_SPAWN;
+    const SceneSkull* skulls = SKULL_SPAWNS;
+    int skull_count = (int)(sizeof(SKULL_SPAWNS) / sizeof(SKULL_SPAWNS[0]));
+    if (g_scene.is_open()) {
+        const SceneHeader& header = g_scene.get_header();
+        player = header.player;
+        std::memcpy(g_george_walking, header.animations, sizeof(g_george_walking));
+        skulls = g_scene.get_skulls();
+        skull_count = (int)g_scene.get_skull_count();
+    }
 
+    g_butterfly = new Entity(glm::vec3(player.x, player.y, 0.0f), glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(0.0f), g_george_texture_id, player.speed);
     g_butterfly->set_animation(g_george_walking[DOWN], SPRITESHEET_DIMENSIONS);
 
+    spawn_skulls(skulls, skull_count);
+}
+
+// Replaces the skulls with the given spawns, handing each one to its behaviour
+void spawn_skulls(const SceneSkull* spawns, int count) {
+    g_skulls.clear();
+    g_skull_behaviours.clear();
+
+    // Every array is sized once up front, so a large level never regrows one while spawning
+    std::size_t behaviour_counts[CHASE + 1] = {};
+    for (int i = 0; i < count; i++) behaviour_counts[spawns[i].behaviour]++;
+    g_skulls.reserve(count);
+    g_skull_behaviours.reserve(behaviour_counts[PATROL], behaviour_counts[BOUNCE_AND_CHASE], behaviour_counts[CHASE]);
+
+    for (int i = 0; i < count; i++) {
+        const SceneSkull& spawn = spawns[i];
+        g_skulls.emplace_back(glm::vec3(spawn.x, spawn.y, 0.0f), glm::vec3(1.0f, 1.0f, 1.0f), glm::vec3(0.0f), g_skull_texture_id, spawn.speed);
+
+        switch (spawn.behaviour) {
+        case PATROL:
+            g_skull_behaviours.add_patrol(i, PATROL_TURN_INTERVAL, RIGHT);
+            break;
+        case BOUNCE_AND_CHASE:
+            g_skull_behaviours.add_bounce_chase(i, CHASE_RADIUS, glm::vec3(0.0f, -1.0f, 0.0f));  // Start by moving downwards
+            break;
+        case CHASE:
+            g_skull_behaviours.add_chase(i);
+            break;
+        }
+    }
+}
+
+void process_input() {
+    PROFILE_SCOPE("process_input");
+
     SDL_Event event;
     while (SDL_PollEvent(&event)) {
         if (event.type == SDL_QUIT || event.type == SDL_WINDOWEVENT_CLOSE) {
             g_app_status = TERMINATED;
         }
+        else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F3) {
+            g_perf_hud.toggle();
+        }
+        else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F9) {
+            if (PROFILE_WRITE_TRACE(g_profile_filepath)) LOG("Wrote profile to " << g_profile_filepath);
+        }
+        else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F5) {
+            quick_save();
+        }
+        else if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_F8) {
+            quick_load();
+        }
     }
+    if (g_game_over) return;  // Stop sampling input if the game is over
 
     const Uint8* keys = SDL_GetKeyboardState(NULL);
+    Uint16 buttons = 0;
+
+    if (keys[SDL_SCANCODE_LEFT]) buttons |= INPUT_LEFT;
+    if (keys[SDL_SCANCODE_RIGHT]) buttons |= INPUT_RIGHT;
+    if (keys[SDL_SCANCODE_UP]) buttons |= INPUT_UP;
+    if (keys[SDL_SCANCODE_DOWN]) buttons |= INPUT_DOWN;
+    if (keys[SDL_SCANCODE_SPACE]) buttons |= INPUT_FIRE;
+
+    // Stamped for the next tick to run; if this frame runs no ticks, the next frame's sample supersedes it
+    g_input_queue.push({ g_tick, buttons });
+}
+
+void apply_input(Uint16 buttons) {
+    g_butterfly->set_animation(g_george_walking[DOWN], SPRITESHEET_DIMENSIONS);
+
     glm::vec3 direction(0.0f);
 
-    if (keys[SDL_SCANCODE_LEFT]) {
+    if (buttons & INPUT_LEFT) {
         direction.x = -1.0f;
         g_butterfly->set_animation(g_george_walking[LEFT], SPRITESHEET_DIMENSIONS);
     }
-    if (keys[SDL_SCANCODE_RIGHT]) {
+    if (buttons & INPUT_RIGHT) {
         direction.x = 1.0f;
         g_butterfly->set_animation(g_george_walking[RIGHT], SPRITESHEET_DIMENSIONS);
     }
-    if (keys[SDL_SCANCODE_UP]) {
+    if (buttons & INPUT_UP) {
         direction.y = 1.0f;
         g_butterfly->set_animation(g_george_walking[UP], SPRITESHEET_DIMENSIONS);
     }
-    if (keys[SDL_SCANCODE_DOWN]) {
+    if (buttons & INPUT_DOWN) {
         direction.y = -1.0f;
         g_butterfly->set_animation(g_george_walking[DOWN], SPRITESHEET_DIMENSIONS);
     }
 
     g_butterfly->move(direction, FIXED_TIMESTEP);
 
-    if (keys[SDL_SCANCODE_SPACE]) {
-        // Fire a bullet
-        GLuint bullet_texture_id = load_texture("platform.png");
-        Entity* bullet = new Entity(g_butterfly->get_position() - glm::vec3(1.0f, 0.0f, 0.0f), glm::vec3(0.2f, 0.2f, 1.0f), glm::vec3(0.0f), bullet_texture_id, 2.0f);
-        g_bullets.push_back(bullet);
+    if (buttons & INPUT_FIRE) {
+        // Fire a bullet; it joins the others at the sync point and first moves next tick
+        g_bullet_commands.spawn(Entity(g_butterfly->get_position() - glm::vec3(1.0f, 0.0f, 0.0f), BULLET_SCALE, glm::vec3(0.0f), g_bullet_texture_id, BULLET_SPEED));
     }
 }
 
 void update() {
+    PROFILE_SCOPE("update");
     if (g_game_over) return;  // Stop updating if the game is over
 
     float ticks = (float)SDL_GetTicks() / MILLISECONDS_IN_SECOND;
@@ -304,189 +509,815 @@ void update() {
     }
 
     while (delta_time >= FIXED_TIMESTEP) {
-        // Updating bullets
-        for (auto bullet : g_bullets) {
-            bullet->move(glm::vec3(-1.0f, 0.0f, 0.0f), FIXED_TIMESTEP);
-        }
+        update_tick();
+        delta_time -= FIXED_TIMESTEP;
+    }
 
-        remove_offscreen_bullets();
-        check_bullet_collisions();
-        check_game_over();
+    g_accumulator = delta_time;
+}
 
-        // Animate butterfly
-        g_butterfly->animate(FIXED_TIMESTEP, SPRITESHEET_DIMENSIONS);
+void update_tick() {
+    PROFILE_SCOPE("update_tick");
+    InputCommand command;
+    Uint16 previous_buttons = g_held_buttons;
+    while (g_input_queue.pop_due(g_tick, command)) g_held_buttons = command.buttons;
 
-        if (g_skull1->is_active()) {
-            // Moving first skull in a square pattern, it is unaffected by butterfly's prozximity
-            g_skull1_move_timer += FIXED_TIMESTEP;
-            if (g_skull1_move_timer >= 1.0f) { // Change direction every 1 second
-                g_skull1_move_timer = 0.0f;
-                g_skull1_direction = (g_skull1_direction + 1) % 4; // Move to the next direction
-            }
+    // Only changes are logged; replay() holds each entry until the next one
+    if (g_record_filepath != nullptr && g_held_buttons != previous_buttons) g_input_log.record(g_tick, g_held_buttons);
 
-            glm::vec3 skull1_direction(0.0f);
-            switch (g_skull1_direction) {
-            case RIGHT:
-                skull1_direction.x = 1.0f;
-                break;
-            case UP:
-                skull1_direction.y = 1.0f;
-                break;
-            case LEFT:
-                skull1_direction.x = -1.0f;
-                break;
-            case DOWN:
-                skull1_direction.y = -1.0f;
-                break;
-            }
-            g_skull1->move(skull1_direction, FIXED_TIMESTEP);
-        }
+    // Movement and firing happen once per tick, however many frames were drawn since the last one
+    apply_input(g_held_buttons);
 
-        // Move second skull (turns at screen edges and chases butterfly when close)
-        if (g_skull2->is_active()) {
-            move_skull2(g_skull2, FIXED_TIMESTEP, g_butterfly);
-        }
+    // Updating bullets
+    for (Entity& bullet : g_bullets) {
+        bullet.move(glm::vec3(-1.0f, 0.0f, 0.0f), FIXED_TIMESTEP);
+    }
 
-        // Move third skull (chases butterfly automatically)
-        if (g_skull3->is_active()) {
-            glm::vec3 direction_to_butterfly = g_butterfly->get_position() - g_skull3->get_position();
-            direction_to_butterfly = glm::normalize(direction_to_butterfly);
-            g_skull3->move(direction_to_butterfly, FIXED_TIMESTEP);
-        }
+    remove_offscreen_bullets();
+    check_bullet_collisions();
 
-        delta_time -= FIXED_TIMESTEP;
-    }
+    // Sync point: the arrays change only here, before anything reads which skulls are left
+    g_skull_commands.apply(g_skulls);
+    g_bullet_commands.apply(g_bullets);
+    check_game_over();
 
-    g_accumulator = delta_time;
+    // Animate butterfly
+    g_butterfly->animate(FIXED_TIMESTEP, SPRITESHEET_DIMENSIONS);
+
+    g_pursuit_field.set_target(g_butterfly->get_position());
+    g_skull_behaviours.update(g_skulls, g_pursuit_field, g_butterfly->get_position(), FIXED_TIMESTEP);
+
+    g_tick++;
 }
 
 void render() {
-    glClear(GL_COLOR_BUFFER_BIT);
+    PROFILE_SCOPE("render");
+    g_perf_hud.begin_frame();
+
+    // Last frame's render time: the GPU's when the driver reports it, otherwise the whole frame
+    // less the time the swap spent waiting for the display
+    float work_milliseconds = g_perf_hud.get_gpu_milliseconds();
+    if (work_milliseconds < 0.0f) work_milliseconds = g_perf_hud.get_last_frame_milliseconds() - g_swap_milliseconds;
+    g_dynamic_resolution.add_frame(work_milliseconds);
+
+    g_dynamic_resolution.begin();
+    traced_clear(GL_COLOR_BUFFER_BIT);
 
     // Render butterfly
     g_butterfly->render(&g_shader_program);
 
     // Render skulls
-    g_skull1->render(&g_shader_program);
-    g_skull2->render(&g_shader_program);
-    g_skull3->render(&g_shader_program);
+    for (Entity& skull : g_skulls) {
+        skull.render(&g_shader_program);
+    }
 
     // Render bullets
-    for (auto bullet : g_bullets) {
-        bullet->render(&g_shader_program);
+    for (Entity& bullet : g_bullets) {
+        bullet.render(&g_shader_program);
     }
 
     // Display win/lose message if game is over
     if (g_game_over) {
-        std::string message = g_player_won ? "You Win" : "You Lose";
+        const char* message = g_player_won ? "You Win" : "You Lose";
         draw_text(&g_shader_program, g_font_texture_id, message, 1.0f, 0.05f, glm::vec3(-4.0f, 0.0f, 0.0f));
     }
 
-    SDL_GL_SwapWindow(g_display_window);
+    g_dynamic_resolution.end(&g_shader_program, g_projection_matrix, g_view_matrix);
+
+    // The overlay is drawn after the counters are read, so it does not count itself, and at
+    // full resolution
+    g_perf_hud.end_frame();
+    if (g_perf_hud.is_visible()) render_perf_hud();
+    g_texture_residency.end_frame();
+
+    {
+        PROFILE_SCOPE("SDL_GL_SwapWindow");
+        if (g_gl_capture.end_frame()) LOG("Wrote GL trace to " << g_gl_capture_filepath);
+        Uint64 swap_start = SDL_GetPerformanceCounter();
+        SDL_GL_SwapWindow(g_display_window);
+        g_swap_milliseconds = (float)((SDL_GetPerformanceCounter() - swap_start) * 1000.0 / SDL_GetPerformanceFrequency());
+    }
+}
+
+void render_perf_hud() {
+    ALLOC_EXEMPT_SCOPE();  // A debugging aid, so it is left out of the steady-state check
+    glm::vec3 position = HUD_ORIGIN;
+
+    for (const std::string& line : g_perf_hud.get_text_lines()) {
+        draw_text(&g_shader_program, g_font_texture_id, line.c_str(), HUD_FONT_SIZE, 0.0f, position);
+        position.y -= HUD_FONT_SIZE;
+    }
+
+    TextureResidencyStats textures = g_texture_residency.get_stats();
+    char texture_text[96];
+    if (textures.budget_bytes == 0) {
+        std::snprintf(texture_text, sizeof(texture_text), "TEX %d RESIDENT %dKB",
+            textures.resident_textures, (int)(textures.resident_bytes / 1024));
+    }
+    else {
+        std::snprintf(texture_text, sizeof(texture_text), "TEX %d RESIDENT %dKB OF %dKB %d EVICTED %llu RELOADS",
+            textures.resident_textures, (int)(textures.resident_bytes / 1024), (int)(textures.budget_bytes / 1024),
+            textures.evicted_textures, (unsigned long long)textures.reloads);
+    }
+    draw_text(&g_shader_program, g_font_texture_id, texture_text, HUD_FONT_SIZE, 0.0f, position);
+    position.y -= HUD_FONT_SIZE;
+
+    if (g_dynamic_resolution.is_enabled()) {
+        const ResolutionTelemetry& resolution = g_dynamic_resolution.get_controller().get_telemetry();
+        char resolution_text[64];
+        std::snprintf(resolution_text, sizeof(resolution_text), "RES %d%% %dX%d %.1f MS",
+            (int)std::lround(resolution.scale * 100.0f), g_dynamic_resolution.get_width(), g_dynamic_resolution.get_height(),
+            resolution.smoothed_milliseconds);
+        draw_text(&g_shader_program, g_font_texture_id, resolution_text, HUD_FONT_SIZE, 0.0f, position);
+        position.y -= HUD_FONT_SIZE;
+    }
+
+    for (const std::string& row : g_perf_hud.get_graph_rows(HUD_GRAPH_COLUMNS, HUD_GRAPH_ROWS)) {
+        draw_text(&g_shader_program, g_font_texture_id, row.c_str(), HUD_GRAPH_CELL_SIZE, 0.0f, position);
+        position.y -= HUD_GRAPH_CELL_SIZE;
+    }
 }
 
 void shutdown() {
+    g_gl_capture.finish();
+
+    if (g_dynamic_resolution.is_enabled()) {
+        const ResolutionController& controller = g_dynamic_resolution.get_controller();
+        const ResolutionTelemetry& telemetry = controller.get_telemetry();
+        if (telemetry.frames > 0) {
+            LOG("Dynamic resolution: average scale " << telemetry.scale_total / telemetry.frames
+                << ", " << telemetry.scale_downs << " down and " << telemetry.scale_ups << " up, "
+                << 100.0 * telemetry.frames_over_budget / telemetry.frames << "% of " << telemetry.frames
+                << " frames over " << controller.get_settings().target_milliseconds << " ms");
+        }
+    }
+
+    g_perf_hud.shutdown();
+    g_texture_residency.shutdown();
     SDL_Quit();
 
+    if (g_record_filepath != nullptr) {
+        g_input_log.set_end_tick(g_tick);
+        if (!g_input_log.save(g_record_filepath)) LOG("Unable to save input recording to " << g_record_filepath);
+    }
+
+    PROFILE_WRITE_TRACE(g_profile_filepath);
+
+    ALLOC_WRITE_REPORT(stderr);
+
     // claening up memory
     delete g_butterfly;
-    delete g_skull1;
-    delete g_skull2;
-    delete g_skull3;
-    for (auto bullet : g_bullets) {
-        delete bullet;
-    }
 }
 
-bool is_nearby(glm::vec3 pos1, glm::vec3 pos2, float distance) {
-    return glm::length(pos1 - pos2) < distance;
+// Box test on the sprites' quads first; only overlapping pairs pay for the mask test
+bool sprites_collide(const Entity* a, const CollisionMask& a_mask, const Entity* b, const CollisionMask& b_mask) {
+    glm::vec3 distance = glm::abs(a->get_position() - b->get_position());
+    glm::vec3 extent = (a->get_scale() + b->get_scale()) * 0.5f;
+    if (distance.x >= extent.x || distance.y >= extent.y) return false;
+
+    return masks_overlap(a_mask, a->get_position(), b_mask, b->get_position());
 }
 
+// Records the destroys; g_bullet_commands.apply() compacts the survivors in place
 void remove_offscreen_bullets() {
-    g_bullets.erase(
-        std::remove_if(
-            g_bullets.begin(),
-            g_bullets.end(),
-            [](Entity* bullet) {
-                glm::vec3 position = bullet->get_position();
-                if (position.x < -5.0f || position.x > 5.0f || position.y < -3.75f || position.y > 3.75f) {
-                    delete bullet; // Cleaning up memory
-                    return true;
-                }
-                return false;
-            }),
-        g_bullets.end());
-}
-
-void move_skull2(Entity* skull, float delta_time, const Entity* butterfly) {
-    glm::vec3 position = skull->get_position();
-    static glm::vec3 movement_direction(0.0f, -1.0f, 0.0f);  // Start by moving downwards
-
-    // Boundary values for the screen
-    const float minX = -5.0f;
-    const float maxX = 5.0f;
-    const float minY = -3.75f;
-    const float maxY = 3.75f;
-
-    if (is_nearby(position, butterfly->get_position(), 1.5f)) {
-        // Chase the butterfly when close
-        glm::vec3 direction_to_butterfly = butterfly->get_position() - position;
-        movement_direction = glm::normalize(direction_to_butterfly);
+    for (int i = 0; i < (int)g_bullets.size(); i++) {
+        glm::vec3 position = g_bullets[i].get_position();
+        if (position.x < -5.0f || position.x > 5.0f || position.y < -3.75f || position.y > 3.75f) {
+            g_bullet_commands.destroy(i);
+        }
     }
-    else {
-        // Move up and down if not near the butterfly
-        if (position.y <= minY || position.y >= maxY) {
-            movement_direction.y *= -1.0f; // Reverse vertical direction
+}
+
+// A bullet is spent on the first skull it hits. Skulls only deactivate, since the behaviours
+// refer to them by index.
+void check_bullet_collisions() {
+    for (int i = 0; i < (int)g_bullets.size(); i++) {
+        const Entity& bullet = g_bullets[i];
+        for (int j = 0; j < (int)g_skulls.size(); j++) {
+            const Entity& skull = g_skulls[j];
+            if (skull.is_active() && sprites_collide(&bullet, g_bullet_masks[0], &skull, g_skull_masks[skull.get_animation_frame()])) {
+                g_skull_commands.set_active(j, false);
+                g_bullet_commands.destroy(i);
+                break;
+            }
+        }
+    }
+}
+
+void check_game_over() {
+    bool any_skull_active = false;
+    bool butterfly_caught = false;
+
+    for (const Entity& skull : g_skulls) {
+        if (!skull.is_active()) continue;
+
+        any_skull_active = true;
+        if (sprites_collide(g_butterfly, g_butterfly_masks[g_butterfly->get_animation_frame()], &skull, g_skull_masks[skull.get_animation_frame()])) {
+            butterfly_caught = true;
         }
     }
 
-    glm::vec3 new_position = position + movement_direction * skull->get_speed() * delta_time;
+    if (!any_skull_active) {
+        g_game_over = true;
+        g_player_won = true;
+    }
+    else if (butterfly_caught) {
+        g_game_over = true;
+        g_player_won = false;
+        g_butterfly->set_active(false);  // Stop the butterfly from moving
+    }
+}
+
+// Fingerprint of everything the simulation touches, compared across replays
+std::uint64_t hash_game_state() {
+    std::uint64_t hash = hash_bytes(&g_tick, sizeof(g_tick));
+    hash = hash_bytes(&g_game_over, sizeof(g_game_over), hash);
+    hash = hash_bytes(&g_player_won, sizeof(g_player_won), hash);
+    hash = g_skull_behaviours.hash_state(hash);
+
+    glm::vec3 butterfly_position = g_butterfly->get_position();
+    bool butterfly_is_active = g_butterfly->is_active();
+    hash = hash_bytes(&butterfly_position, sizeof(butterfly_position), hash);
+    hash = hash_bytes(&butterfly_is_active, sizeof(butterfly_is_active), hash);
+
+    for (const Entity& skull : g_skulls) {
+        glm::vec3 position = skull.get_position();
+        bool is_active = skull.is_active();
+        hash = hash_bytes(&position, sizeof(position), hash);
+        hash = hash_bytes(&is_active, sizeof(is_active), hash);
+    }
+
+    for (const Entity& bullet : g_bullets) {
+        glm::vec3 position = bullet.get_position();
+        hash = hash_bytes(&position, sizeof(position), hash);
+    }
 
-    // Clamping the position to ensure it stays within the screen boundaries
-    new_position.x = glm::clamp(new_position.x, minX, maxX);
-    new_position.y = glm::clamp(new_position.y, minY, maxY);
+    return hash;
+}
 
-    skull->set_position(new_position);
+// ––––– SNAPSHOTS ––––– //
+void serialize_position(SnapshotStream& stream, glm::vec3& position) {
+    stream.serialize_float(position.x, -SNAPSHOT_POSITION_RANGE, SNAPSHOT_POSITION_RANGE, SNAPSHOT_POSITION_BITS);
+    stream.serialize_float(position.y, -SNAPSHOT_POSITION_RANGE, SNAPSHOT_POSITION_RANGE, SNAPSHOT_POSITION_BITS);
 }
 
-void check_bullet_collisions() {
-    for (auto bullet : g_bullets) {
-        glm::vec3 bullet_position = bullet->get_position();
+// Everything one tick hands on to the next. Reading writes straight into the live entities,
+// bullets included, and rebuilds their model matrices so the restored state renders as is.
+// The skulls must already be spawned; a snapshot with a different number of them is an error.
+void serialize_game_state(SnapshotStream& stream) {
+    PROFILE_SCOPE("serialize_game_state");
+    std::uint32_t tick = g_tick, held_buttons = g_held_buttons;
+    stream.serialize_bits(tick, 32);
+    stream.serialize_bits(held_buttons, 16);
+    stream.serialize_bool(g_game_over);
+    stream.serialize_bool(g_player_won);
+
+    glm::vec3 position = g_butterfly->get_position();
+    bool is_active = g_butterfly->is_active();
+    int animation_index = g_butterfly->get_animation_index();
+    float animation_time = g_butterfly->get_animation_time();
+    serialize_position(stream, position);
+    stream.serialize_bool(is_active);
+    stream.serialize_int(animation_index, 0, SPRITESHEET_DIMENSIONS - 1);
+    stream.serialize_float(animation_time, 0.0f, 1.0f / SECONDS_PER_FRAME, 8);
+
+    if (stream.is_reading()) {
+        g_tick = tick;
+        g_held_buttons = (Uint16)held_buttons;
+        g_butterfly->set_position(position);
+        g_butterfly->set_active(is_active);
+        g_butterfly->set_animation_state(animation_index, animation_time);
+    }
 
-        if (g_skull1->is_active() && is_nearby(bullet_position, g_skull1->get_position(), 0.5f)) {
-            g_skull1->set_active(false);
+    int skull_count = (int)g_skulls.size();
+    stream.serialize_int(skull_count, 0, SNAPSHOT_MAX_COUNT);
+    if (skull_count != (int)g_skulls.size()) {
+        stream.set_error();
+        return;
+    }
+    for (Entity& skull : g_skulls) {
+        position = skull.get_position();
+        is_active = skull.is_active();
+        serialize_position(stream, position);
+        stream.serialize_bool(is_active);
+
+        if (stream.is_reading()) {
+            skull.set_position(position);
+            skull.set_active(is_active);
         }
-        if (g_skull2->is_active() && is_nearby(bullet_position, g_skull2->get_position(), 0.5f)) {
-            g_skull2->set_active(false);
+    }
+    g_skull_behaviours.serialize(stream);
+
+    // Bullets come and go, so reading resizes the array to match (within its reserved capacity)
+    int bullet_count = (int)g_bullets.size();
+    stream.serialize_int(bullet_count, 0, SNAPSHOT_MAX_COUNT);
+    if (stream.is_reading()) {
+        while ((int)g_bullets.size() > bullet_count) g_bullets.pop_back();
+        while ((int)g_bullets.size() < bullet_count) {
+            g_bullets.emplace_back(glm::vec3(0.0f), BULLET_SCALE, glm::vec3(0.0f), g_bullet_texture_id, BULLET_SPEED);
         }
-        if (g_skull3->is_active() && is_nearby(bullet_position, g_skull3->get_position(), 0.5f)) {
-            g_skull3->set_active(false);
+    }
+    for (Entity& bullet : g_bullets) {
+        position = bullet.get_position();
+        serialize_position(stream, position);
+        if (stream.is_reading()) bullet.set_position(position);
+    }
+}
+
+void capture_state(std::vector<std::uint8_t>& bytes) {
+    g_snapshot_stream.begin_write(SNAPSHOT_LOSSLESS);
+    serialize_game_state(g_snapshot_stream);
+    bytes.assign(g_snapshot_stream.get_data(), g_snapshot_stream.get_data() + g_snapshot_stream.get_size());
+}
+
+// A snapshot that cannot be read, say from an older build's file, leaves the game as it was
+bool restore_state(const std::vector<std::uint8_t>& bytes) {
+    capture_state(g_state_backup);
+
+    g_snapshot_stream.begin_read(bytes.data(), bytes.size(), SNAPSHOT_LOSSLESS);
+    serialize_game_state(g_snapshot_stream);
+    if (g_snapshot_stream.has_error()) {
+        g_snapshot_stream.begin_read(g_state_backup.data(), g_state_backup.size(), SNAPSHOT_LOSSLESS);
+        serialize_game_state(g_snapshot_stream);
+        return false;
+    }
+
+    // Commands stamped for the old timeline would otherwise hold up the queue
+    g_input_queue.clear();
+    return true;
+}
+
+// Resumes from g_state_filepath if it holds a snapshot, then keeps the state for F8
+void start_snapshots() {
+    std::vector<std::uint8_t> saved;
+    if (g_state_filepath != nullptr && load_snapshot_file(g_state_filepath, saved)) {
+        if (g_record_filepath != nullptr) LOG("Not resuming from " << g_state_filepath << ", recordings start from a new game");
+        else if (restore_state(saved)) LOG("Resumed from " << g_state_filepath << " at tick " << g_tick);
+        else LOG("Unable to read the state in " << g_state_filepath);
+    }
+    capture_state(g_quick_save);
+}
+
+void quick_save() {
+    capture_state(g_quick_save);
+    if (g_state_filepath != nullptr && !save_snapshot_file(g_state_filepath, g_snapshot_stream)) {
+        LOG("Unable to save state to " << g_state_filepath);
+    }
+}
+
+void quick_load() {
+    // A recording has to run forwards from the start to replay
+    if (g_record_filepath != nullptr) {
+        LOG("Quick load is off while recording");
+        return;
+    }
+    if (!restore_state(g_quick_save)) return;
+
+    g_previous_ticks = (float)SDL_GetTicks() / MILLISECONDS_IN_SECOND;
+    g_accumulator = 0.0f;
+}
+
+// Size and cost of snapshots over a replay, gathered by --snapshot-check
+struct SnapshotCheck {
+    SnapshotStream stream;
+    SnapshotFields baseline, quantized_baseline;
+    std::vector<std::uint8_t> delta;
+
+    std::uint64_t ticks = 0;
+    std::uint64_t full_bytes = 0, delta_bytes = 0;
+    std::uint64_t quantized_bytes = 0, quantized_delta_bytes = 0;
+    double encode_seconds = 0.0, restore_seconds = 0.0;
+};
+
+// Encodes the state in full and as a delta against the last tick, both lossless and quantized,
+// then restores the lossless delta over the live state. Anything the snapshot misses or gets
+// wrong then shows up as a different end state for the replay.
+void check_snapshot_round_trip(SnapshotCheck& check) {
+    SnapshotStream& stream = check.stream;
+
+    stream.begin_write(SNAPSHOT_QUANTIZED);
+    serialize_game_state(stream);
+    check.quantized_bytes += stream.get_size();
+
+    stream.begin_write(SNAPSHOT_QUANTIZED, &check.quantized_baseline);
+    serialize_game_state(stream);
+    check.quantized_delta_bytes += stream.get_size();
+    check.quantized_baseline = stream.get_fields();
+
+    stream.begin_write(SNAPSHOT_LOSSLESS);
+    serialize_game_state(stream);
+    check.full_bytes += stream.get_size();
+
+    auto encode_start = std::chrono::steady_clock::now();
+    stream.begin_write(SNAPSHOT_LOSSLESS, &check.baseline);
+    serialize_game_state(stream);
+    check.encode_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - encode_start).count();
+
+    check.delta.assign(stream.get_data(), stream.get_data() + stream.get_size());
+    check.delta_bytes += check.delta.size();
+
+    auto restore_start = std::chrono::steady_clock::now();
+    stream.begin_read(check.delta.data(), check.delta.size(), SNAPSHOT_LOSSLESS, &check.baseline);
+    serialize_game_state(stream);
+    check.restore_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - restore_start).count();
+
+    if (stream.has_error()) LOG("Snapshot failed to read back at tick " << g_tick);
+    check.baseline = stream.get_fields();
+    check.ticks++;
+}
+
+void log_snapshot_check(const SnapshotCheck& check) {
+    if (check.ticks == 0) return;
+
+    double ticks = (double)check.ticks;
+    std::printf("Snapshots per tick: %.1f bytes full, %.1f delta, quantized %.1f full, %.1f delta; "
+        "encode %.2f us, restore %.2f us\n",
+        check.full_bytes / ticks, check.delta_bytes / ticks,
+        check.quantized_bytes / ticks, check.quantized_delta_bytes / ticks,
+        check.encode_seconds / ticks * 1e6, check.restore_seconds / ticks * 1e6);
+}
+
+// Runs a recorded session headless and as fast as possible. Returns non-zero if the
+// end state does not match expected_hash (when one is given). With check_snapshots, every
+// tick's state also goes through a snapshot and back.
+int replay(const char* filepath, const char* expected_hash, bool check_snapshots) {
+    if (!g_input_log.load(filepath)) {
+        LOG("Unable to load input recording " << filepath << ": " << g_input_log.get_error());
+        return 1;
+    }
+
+    initialise_scene();
+
+    SnapshotCheck check;
+    auto run_tick = [&]() {
+        update_tick();
+        if (check_snapshots) check_snapshot_round_trip(check);
+    };
+
+    while (g_input_log.has_next()) {
+        ALLOC_FRAME_BEGIN();
+        g_frame_arena.reset();
+
+        const InputFrame& frame = g_input_log.next();
+        while (g_tick < frame.tick) run_tick();
+        g_input_queue.push({ frame.tick, frame.buttons });
+
+        ALLOC_FRAME_END();
+    }
+    while (g_tick < g_input_log.get_end_tick()) run_tick();
+
+    std::uint64_t hash = hash_game_state();
+    LOG("Replayed " << g_input_log.get_frame_count() << " frames, " << g_tick << " ticks, end state " << std::hex << hash << std::dec);
+    log_snapshot_check(check);
+    PROFILE_WRITE_TRACE(g_profile_filepath);
+
+    ALLOC_WRITE_REPORT(stderr);
+    delete g_butterfly;
+
+    if (expected_hash != nullptr && std::strtoull(expected_hash, nullptr, 16) != hash) {
+        LOG("End state does not match " << expected_hash);
+        return 1;
+    }
+    return 0;
+}
+
+// ––––– BENCHMARKS ––––– //
+constexpr double BENCHMARK_REGRESSION_PERCENT = 10.0;
+constexpr int SCENE_BENCHMARK_SKULLS = 10000;
+
+// Hot paths timed without a window. Results go to save_filepath as JSON, or to stdout when
+// there is neither a save file nor a baseline; with a baseline, prints the change for each
+// benchmark and returns non-zero if anything got slower by more than the threshold.
+int run_benchmarks(const char* save_filepath, const char* baseline_filepath) {
+    BenchmarkSuite suite;
+
+    std::vector<Entity> entities;
+    for (int i = 0; i < 1000; i++) {
+        entities.push_back(Entity(glm::vec3(i % 10 - 5.0f, i / 100 - 5.0f, 0.0f), glm::vec3(1.0f), glm::vec3(0.0f, 0.01f * i, 0.0f), 0));
+    }
+    suite.run("Entity::update_model_matrix", (int)entities.size(), [&]() {
+        for (Entity& entity : entities) entity.update_model_matrix();
+        benchmark_sink(entities.data());
+    });
+
+    float tex_coords[12];
+    suite.run("get_atlas_tex_coords", SPRITESHEET_DIMENSIONS * SPRITESHEET_DIMENSIONS, [&]() {
+        for (int index = 0; index < SPRITESHEET_DIMENSIONS * SPRITESHEET_DIMENSIONS; index++) {
+            get_atlas_tex_coords(index, SPRITESHEET_DIMENSIONS, SPRITESHEET_DIMENSIONS, tex_coords);
+            benchmark_sink(tex_coords);
         }
+    });
+
+    // Fresh vectors from the frame arena each call, as draw_text does
+    const char* short_text = "You Lose";
+    const char* hud_text = "FRAME 16.7 MS  P50 16.6  P99 18.0";
+    suite.run("build_text_mesh/short", 1, [&]() {
+        g_frame_arena.reset();
+        FrameVector<float> vertices, texture_coordinates;
+        build_text_mesh(short_text, 1.0f, 0.05f, vertices, texture_coordinates);
+        benchmark_sink(vertices.data());
+    });
+    suite.run("build_text_mesh/hud", 1, [&]() {
+        g_frame_arena.reset();
+        FrameVector<float> vertices, texture_coordinates;
+        build_text_mesh(hud_text, HUD_FONT_SIZE, 0.0f, vertices, texture_coordinates);
+        benchmark_sink(vertices.data());
+    });
+
+    // The decode half of load_texture, from memory so disk speed doesn't count
+    std::ifstream file(SPRITESHEET_FILEPATH, std::ios::binary);
+    std::vector<unsigned char> encoded((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (encoded.empty()) LOG("Skipping image decode, " << SPRITESHEET_FILEPATH << " not found");
+    else {
+        suite.run("load_texture/decode", 1, [&]() {
+            int width, height, number_of_components;
+            unsigned char* image = stbi_load_from_memory(encoded.data(), (int)encoded.size(), &width, &height, &number_of_components, STBI_rgb_alpha);
+            benchmark_sink(image);
+            stbi_image_free(image);
+        });
+    }
+
+    // Every other bullet is off screen, so compaction moves half of them
+    const int bullet_counts[] = { 100, 1000 };
+    for (int count : bullet_counts) {
+        std::string name = "remove_offscreen_bullets/" + std::to_string(count);
+        suite.run_with_setup(name.c_str(), count, [&]() {
+            g_bullets.clear();
+            for (int i = 0; i < count; i++) {
+                glm::vec3 position(i % 2 == 0 ? 0.0f : -6.0f, 0.0f, 0.0f);
+                g_bullets.emplace_back(position, BULLET_SCALE, glm::vec3(0.0f), 0, 2.0f);
+            }
+        }, []() {
+            remove_offscreen_bullets();
+            g_bullet_commands.apply(g_bullets);
+        });
+    }
+    g_bullets.clear();
+
+    // A large level spawned from a compiled image, as initialise_scene does from a mapped file
+    std::vector<SceneSkull> level_skulls;
+    for (int i = 0; i < SCENE_BENCHMARK_SKULLS; i++) {
+        level_skulls.push_back({ std::fmod(i * 0.618034f, 1.0f) * 10.0f - 5.0f, std::fmod(i * 0.754878f, 1.0f) * 7.5f - 3.75f, 1.0f, (std::uint32_t)(i % 3) });
+    }
+    std::vector<std::uint8_t> level_image;
+    build_scene_image(PLAYER_SPAWN, g_george_walking, level_skulls.data(), level_skulls.size(), level_image);
+
+    SceneFile level;
+    level.open_image(std::move(level_image));
+    suite.run("scene/spawn/10000", SCENE_BENCHMARK_SKULLS, [&]() {
+        spawn_skulls(level.get_skulls(), (int)level.get_skull_count());
+        benchmark_sink(g_skulls.data());
+    });
+    g_skulls.clear();
+    g_skull_behaviours.clear();
+
+    // A thousand-skull scene with bullets in flight, each delta taken against the tick before
+    initialise_scene();
+    build_stress_scene(1000);
+    for (int i = 0; i < 30; i++) update_tick();
+
+    SnapshotStream stream;
+    stream.begin_write(SNAPSHOT_LOSSLESS);
+    serialize_game_state(stream);
+    SnapshotFields baseline = stream.get_fields();
+    update_tick();
+
+    suite.run("serialize_game_state/encode", 1, [&]() {
+        stream.begin_write(SNAPSHOT_LOSSLESS);
+        serialize_game_state(stream);
+        benchmark_sink(stream.get_data());
+    });
+    suite.run("serialize_game_state/encode_delta", 1, [&]() {
+        stream.begin_write(SNAPSHOT_LOSSLESS, &baseline);
+        serialize_game_state(stream);
+        benchmark_sink(stream.get_data());
+    });
+    suite.run("serialize_game_state/encode_quantized", 1, [&]() {
+        stream.begin_write(SNAPSHOT_QUANTIZED);
+        serialize_game_state(stream);
+        benchmark_sink(stream.get_data());
+    });
+
+    // Restoring the current tick's delta over itself leaves the state unchanged between runs
+    stream.begin_write(SNAPSHOT_LOSSLESS, &baseline);
+    serialize_game_state(stream);
+    std::vector<std::uint8_t> delta(stream.get_data(), stream.get_data() + stream.get_size());
+    suite.run("serialize_game_state/restore_delta", 1, [&]() {
+        stream.begin_read(delta.data(), delta.size(), SNAPSHOT_LOSSLESS, &baseline);
+        serialize_game_state(stream);
+        benchmark_sink(g_skulls.data());
+    });
+
+    g_skulls.clear();
+    g_bullets.clear();
+    delete g_butterfly;
+
+    if (save_filepath != nullptr) {
+        if (!suite.save_json(save_filepath)) LOG("Unable to save benchmark results to " << save_filepath);
     }
+    else if (baseline_filepath == nullptr) suite.write_json(stdout);
+
+    if (baseline_filepath == nullptr) return 0;
+
+    int regressions = suite.compare_with_baseline(baseline_filepath, BENCHMARK_REGRESSION_PERCENT);
+    if (regressions < 0) LOG("Unable to read benchmark baseline " << baseline_filepath);
+    return regressions == 0 ? 0 : 1;
 }
 
-void check_game_over() {
-    if (!g_skull1->is_active() && !g_skull2->is_active() && !g_skull3->is_active()) {
-        g_game_over = true;
-        g_player_won = true;
+// ––––– STRESS TEST ––––– //
+const int STRESS_COUNTS[] = { 10, 100, 1000, 10000, 100000 };
+constexpr int STRESS_TICKS = 120;
+
+// Puts count skulls around the arena, cycling through the behaviours, and a butterfly holding
+// fire so bullets stream through them, ready for a fresh run
+void build_stress_scene(int count) {
+    const BehaviourType behaviours[] = { PATROL, BOUNCE_AND_CHASE, CHASE };
+    std::vector<SceneSkull> spawns;
+    for (int i = 0; i < count; i++) {
+        float x = std::fmod(i * 0.618034f, 1.0f) * 10.0f - 5.0f;
+        float y = std::fmod(i * 0.754878f, 1.0f) * 7.5f - 3.75f;
+        spawns.push_back({ x, y, 1.0f + 0.5f * (i % 2), (std::uint32_t)behaviours[i % 3] });
     }
+    spawn_skulls(spawns.data(), count);
 
-    if (!g_game_over && (g_skull1->is_active() && is_nearby(g_butterfly->get_position(), g_skull1->get_position(), 0.5f)) ||
-        (g_skull2->is_active() && is_nearby(g_butterfly->get_position(), g_skull2->get_position(), 0.5f)) ||
-        (g_skull3->is_active() && is_nearby(g_butterfly->get_position(), g_skull3->get_position(), 0.5f))) {
-        g_game_over = true;
-        g_player_won = false;
-        g_butterfly->set_active(false);  // Stop the butterfly from moving
+    g_bullets.clear();
+
+    g_butterfly->set_position(glm::vec3(0.0f));
+    g_butterfly->set_active(true);
+    g_game_over = false;
+    g_player_won = false;
+
+    g_input_queue.push({ g_tick, INPUT_FIRE });
+}
+
+// Runs the game's own tick for the given number of ticks at each size in STRESS_COUNTS, and
+// prints update and render time per tick as CSV. Headless runs leave the render column empty.
+int run_stress_test(bool windowed, int ticks) {
+    if (windowed) {
+        initialise();
+        SDL_GL_SetSwapInterval(0);  // Time the work, not the display's refresh
     }
+    else {
+        initialise_scene();
+    }
+
+    std::printf("scene,entities,ticks,update_us_per_tick,render_us_per_tick\n");
+
+    for (int count : STRESS_COUNTS) {
+        build_stress_scene(count);
+
+        double update_seconds = 0.0, render_seconds = 0.0;
+        for (int tick = 0; tick < ticks; tick++) {
+            auto update_start = std::chrono::steady_clock::now();
+            update_tick();
+            update_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - update_start).count();
+
+            if (!windowed) continue;
+
+            auto render_start = std::chrono::steady_clock::now();
+            render();
+            render_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - render_start).count();
+        }
+
+        if (windowed) std::printf("skulls,%d,%d,%.2f,%.2f\n", count, ticks, update_seconds * 1.0e6 / ticks, render_seconds * 1.0e6 / ticks);
+        else std::printf("skulls,%d,%d,%.2f,\n", count, ticks, update_seconds * 1.0e6 / ticks);
+        std::fflush(stdout);
+    }
+
+    if (windowed) shutdown();
+    return 0;
+}
+
+// ––––– SCENE COMPILER ––––– //
+// Turns a scene's text form into the binary image --scene maps in place
+int run_scene_compiler(const char* text_filepath, const char* binary_filepath) {
+    std::ifstream input(text_filepath, std::ios::binary);
+    if (!input) {
+        LOG("Unable to read scene " << text_filepath);
+        return 1;
+    }
+    std::string text((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+
+    std::vector<std::uint8_t> image;
+    std::string error;
+    if (!compile_scene(text.c_str(), image, error)) {
+        LOG(text_filepath << ": " << error);
+        return 1;
+    }
+
+    std::FILE* output = std::fopen(binary_filepath, "wb");
+    bool written = output != nullptr && std::fwrite(image.data(), 1, image.size(), output) == image.size();
+    if (output != nullptr) written = std::fclose(output) == 0 && written;
+    if (!written) {
+        LOG("Unable to write scene " << binary_filepath);
+        return 1;
+    }
+
+    const SceneHeader* header = reinterpret_cast<const SceneHeader*>(image.data());
+    LOG("Compiled " << header->skull_count << " skulls into " << image.size() << " bytes");
+    return 0;
 }
 
+// Usage: --record <file> to capture a session, --replay <file> [--expect <hash>] to re-run one,
+// --profile <file> to choose where a profiler build writes its trace, --benchmark to time the
+// hot paths, with --benchmark-save <file> to keep the results and --benchmark-baseline <file>
+// to compare against kept results, --stress or --stress-windowed [--stress-ticks <n>] to print
+// a CSV scaling curve, --zero-alloc-after <frames> to abort on any frame that allocates once
+// warmed up (needs a build with -DENABLE_ALLOC_TRACKING), --gl-capture <file> [--gl-capture-frames <n>]
+// to record the GL calls of the first frames for the GL Replay tool, --state-file <file> to resume
+// from and quick save (F5) to a file, --snapshot-check with --replay to put every tick's state
+// through a snapshot and back and print snapshot sizes and times, --dynamic-resolution <ms> to
+// lower the scene's resolution whenever rendering takes longer than that, --texture-budget <KB>
+// to cap the memory textures take on the GPU, reloading evicted ones when next drawn, --scene <file>
+// to play a level from a scene file instead of the built-in one, --compile-scene <text> <binary>
+// to compile a scene's text form for --scene to map
 int main(int argc, char* argv[]) {
+    const char* replay_filepath = nullptr;
+    const char* expected_hash = nullptr;
+    const char* benchmark_save_filepath = nullptr;
+    const char* benchmark_baseline_filepath = nullptr;
+    bool benchmark = false;
+    bool stress = false, stress_windowed = false;
+    int stress_ticks = STRESS_TICKS;
+    int gl_capture_frames = GL_CAPTURE_FRAMES;
+    bool check_snapshots = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--benchmark") == 0) {
+            benchmark = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--snapshot-check") == 0) {
+            check_snapshots = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--stress") == 0) {
+            stress = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--stress-windowed") == 0) {
+            stress = stress_windowed = true;
+            continue;
+        }
+        if (std::strcmp(argv[i], "--compile-scene") == 0 && i + 2 < argc) return run_scene_compiler(argv[i + 1], argv[i + 2]);
+        if (i + 1 >= argc) break;
+
+        if (std::strcmp(argv[i], "--record") == 0) g_record_filepath = argv[++i];
+        else if (std::strcmp(argv[i], "--replay") == 0) replay_filepath = argv[++i];
+        else if (std::strcmp(argv[i], "--expect") == 0) expected_hash = argv[++i];
+        else if (std::strcmp(argv[i], "--profile") == 0) g_profile_filepath = argv[++i];
+        else if (std::strcmp(argv[i], "--gl-capture") == 0) g_gl_capture_filepath = argv[++i];
+        else if (std::strcmp(argv[i], "--gl-capture-frames") == 0) gl_capture_frames = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--benchmark-save") == 0) benchmark_save_filepath = argv[++i];
+        else if (std::strcmp(argv[i], "--benchmark-baseline") == 0) benchmark_baseline_filepath = argv[++i];
+        else if (std::strcmp(argv[i], "--stress-ticks") == 0) stress_ticks = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--state-file") == 0) g_state_filepath = argv[++i];
+        else if (std::strcmp(argv[i], "--scene") == 0) g_scene_filepath = argv[++i];
+        else if (std::strcmp(argv[i], "--texture-budget") == 0) g_texture_residency.set_budget((std::size_t)std::max(0, std::atoi(argv[++i])) * 1024);
+        else if (std::strcmp(argv[i], "--dynamic-resolution") == 0) {
+            g_use_dynamic_resolution = true;
+            g_resolution_settings.target_milliseconds = std::max(1.0f, (float)std::atof(argv[++i]));
+        }
+        else if (std::strcmp(argv[i], "--zero-alloc-after") == 0) {
+            if (!ALLOC_REQUIRE_STEADY_STATE(std::atoi(argv[++i]))) LOG("--zero-alloc-after needs a build with -DENABLE_ALLOC_TRACKING");
+        }
+    }
+
+    if (g_scene_filepath != nullptr) {
+        auto open_start = std::chrono::steady_clock::now();
+        if (!g_scene.open(g_scene_filepath)) {
+            LOG("Unable to load scene " << g_scene_filepath << ": " << g_scene.get_error());
+            return 1;
+        }
+        double open_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - open_start).count();
+        LOG("Opened scene " << g_scene_filepath << ", " << g_scene.get_skull_count() << " skulls, in " << open_ms << " ms");
+    }
+
+    if (stress) return run_stress_test(stress_windowed, stress_ticks);
+
+    if (benchmark || benchmark_save_filepath != nullptr || benchmark_baseline_filepath != nullptr) {
+        return run_benchmarks(benchmark_save_filepath, benchmark_baseline_filepath);
+    }
+    if (replay_filepath != nullptr) return replay(replay_filepath, expected_hash, check_snapshots);
+
+    if (g_gl_capture_filepath != nullptr && !g_gl_capture.start(g_gl_capture_filepath, gl_capture_frames)) {
+        LOG("Unable to write GL trace to " << g_gl_capture_filepath);
+    }
+
     initialise();
+    g_gl_capture.end_setup();
+    start_snapshots();
 
     while (g_app_status == RUNNING) {
+        PROFILE_SCOPE("frame");
+        ALLOC_FRAME_BEGIN();
+        g_frame_arena.reset();
+
         process_input();
         update();
         render();
+
+        ALLOC_FRAME_END();
     }
 
     shutdown();
@@ -0,0 +1,387 @@
+/**
+* GL Replay
+* Re-issues a GL trace recorded by one of the assignments with --gl-capture and times every
+* frame, so driver and backend cost can be measured apart from the game's simulation.
+**/
+
+#define LOG(argument) std::cout << argument << '\n'
+#define GL_SILENCE_DEPRECATION
+#define GL_GLEXT_PROTOTYPES 1
+
+#ifdef _WINDOWS
+#include <GL/glew.h>
+#endif
+
+#include <SDL.h>
+#include <SDL_opengl.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <vector>
+#include "GlTrace.h"
+
+constexpr int WINDOW_WIDTH = 640,
+WINDOW_HEIGHT = 480;
+
+// The course's textured shader, with the attribute and uniform names ShaderProgram looks up
+const char* VERTEX_SHADER_SOURCE =
+    "attribute vec4 position;\n"
+    "attribute vec2 texCoord;\n"
+    "uniform mat4 modelMatrix;\n"
+    "uniform mat4 viewMatrix;\n"
+    "uniform mat4 projectionMatrix;\n"
+    "varying vec2 texCoordVar;\n"
+    "void main() {\n"
+    "    texCoordVar = texCoord;\n"
+    "    gl_Position = projectionMatrix * viewMatrix * modelMatrix * position;\n"
+    "}\n";
+
+const char* FRAGMENT_SHADER_SOURCE =
+    "uniform sampler2D diffuse;\n"
+    "varying vec2 texCoordVar;\n"
+    "void main() {\n"
+    "    gl_FragColor = texture2D(diffuse, texCoordVar);\n"
+    "}\n";
+
+// ––––– TRACE ––––– //
+struct TraceCommand {
+    std::uint16_t op;
+    const unsigned char* payload;  // Points into Trace::bytes
+    std::uint32_t payload_bytes;
+};
+
+struct Trace {
+    std::vector<unsigned char> bytes;
+    std::vector<TraceCommand> setup;
+    std::vector<std::vector<TraceCommand>> frames;
+};
+
+// Splits the trace into its setup and frames. Commands after the last FRAME_END, from a
+// capture cut short, are dropped.
+bool load_trace(const char* filepath, Trace& trace) {
+    std::ifstream file(filepath, std::ios::binary);
+    if (!file) return false;
+    trace.bytes.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+
+    GlTraceHeader header;
+    if (trace.bytes.size() < sizeof(header)) return false;
+    std::memcpy(&header, trace.bytes.data(), sizeof(header));
+    if (header.magic != GL_TRACE_MAGIC || header.version != GL_TRACE_VERSION) return false;
+
+    std::vector<TraceCommand> current;
+    bool in_setup = true;
+    std::size_t cursor = sizeof(header);
+
+    while (cursor + sizeof(GlTraceCommand) <= trace.bytes.size()) {
+        GlTraceCommand command;
+        std::memcpy(&command, trace.bytes.data() + cursor, sizeof(command));
+        cursor += sizeof(command);
+        if (cursor + command.payload_bytes > trace.bytes.size()) return false;
+
+        if (command.op == TRACE_SETUP_END && in_setup) {
+            trace.setup.swap(current);
+            in_setup = false;
+        }
+        else if (command.op == TRACE_FRAME_END) {
+            // A trace without a SETUP_END has nothing to run once; its first frame does the setup
+            trace.frames.push_back(current);
+            current.clear();
+            in_setup = false;
+        }
+        else {
+            current.push_back({ command.op, trace.bytes.data() + cursor, command.payload_bytes });
+        }
+        cursor += command.payload_bytes;
+    }
+    return !trace.frames.empty();
+}
+
+// ––––– REPLAY ––––– //
+struct ReplayState {
+    GLuint program = 0;
+    GLint matrix_uniforms[3] = { -1, -1, -1 };  // Indexed by GlTraceMatrix
+    std::map<std::uint32_t, GLuint> programs;   // Recorded names to ours
+    std::map<std::uint32_t, GLuint> textures;
+    std::map<std::uint32_t, GLuint> framebuffers;
+};
+
+GLuint compile_shader(GLenum type, const char* source) {
+    GLuint shader = glCreateShader(type);
+    glShaderSource(shader, 1, &source, nullptr);
+    glCompileShader(shader);
+
+    GLint compiled = GL_FALSE;
+    glGetShaderiv(shader, GL_COMPILE_STATUS, &compiled);
+    if (!compiled) {
+        char message[512];
+        glGetShaderInfoLog(shader, sizeof(message), nullptr, message);
+        LOG("Shader failed to compile: " << message);
+    }
+    return shader;
+}
+
+// Attributes are bound to the locations the game's program used, so recorded indices line up
+GLuint create_program(GLuint position_attribute, GLuint tex_coordinate_attribute) {
+    GLuint program = glCreateProgram();
+    glAttachShader(program, compile_shader(GL_VERTEX_SHADER, VERTEX_SHADER_SOURCE));
+    glAttachShader(program, compile_shader(GL_FRAGMENT_SHADER, FRAGMENT_SHADER_SOURCE));
+    glBindAttribLocation(program, position_attribute, "position");
+    glBindAttribLocation(program, tex_coordinate_attribute, "texCoord");
+    glLinkProgram(program);
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) LOG("Replay shader failed to link");
+    return program;
+}
+
+template <typename Payload>
+Payload read_payload(const TraceCommand& command) {
+    Payload payload = {};
+    std::memcpy(&payload, command.payload, std::min<std::size_t>(sizeof(payload), command.payload_bytes));
+    return payload;
+}
+
+// Whatever follows the op's struct, or null if there is nothing
+template <typename Payload>
+const void* trailing_data(const TraceCommand& command) {
+    return command.payload_bytes > sizeof(Payload) ? command.payload + sizeof(Payload) : nullptr;
+}
+
+void issue(const TraceCommand& command, ReplayState& state) {
+    switch (command.op) {
+    case TRACE_VIEWPORT: {
+        TraceViewport payload = read_payload<TraceViewport>(command);
+        glViewport(payload.x, payload.y, payload.width, payload.height);
+        break;
+    }
+    case TRACE_CLEAR_COLOR: {
+        TraceClearColor payload = read_payload<TraceClearColor>(command);
+        glClearColor(payload.red, payload.green, payload.blue, payload.alpha);
+        break;
+    }
+    case TRACE_CLEAR:
+        glClear(read_payload<TraceClear>(command).mask);
+        break;
+    case TRACE_ENABLE:
+        glEnable(read_payload<TraceEnable>(command).capability);
+        break;
+    case TRACE_BLEND_FUNC: {
+        TraceBlendFunc payload = read_payload<TraceBlendFunc>(command);
+        glBlendFunc(payload.source, payload.destination);
+        break;
+    }
+    case TRACE_BLEND_FUNC_SEPARATE: {
+        TraceBlendFuncSeparate payload = read_payload<TraceBlendFuncSeparate>(command);
+        glBlendFuncSeparate(payload.source_rgb, payload.destination_rgb, payload.source_alpha, payload.destination_alpha);
+        break;
+    }
+    case TRACE_PROGRAM: {
+        TraceProgram payload = read_payload<TraceProgram>(command);
+        state.program = create_program(payload.position_attribute, payload.tex_coordinate_attribute);
+        state.programs[payload.program] = state.program;
+        state.matrix_uniforms[TRACE_MODEL_MATRIX] = glGetUniformLocation(state.program, "modelMatrix");
+        state.matrix_uniforms[TRACE_VIEW_MATRIX] = glGetUniformLocation(state.program, "viewMatrix");
+        state.matrix_uniforms[TRACE_PROJECTION_MATRIX] = glGetUniformLocation(state.program, "projectionMatrix");
+
+        // Matrices can be set before the game first binds its program
+        glUseProgram(state.program);
+        break;
+    }
+    case TRACE_USE_PROGRAM: {
+        auto found = state.programs.find(read_payload<TraceUseProgram>(command).program);
+        glUseProgram(found != state.programs.end() ? found->second : state.program);
+        break;
+    }
+    case TRACE_UNIFORM_MATRIX: {
+        TraceUniformMatrix payload = read_payload<TraceUniformMatrix>(command);
+        if (payload.matrix <= TRACE_PROJECTION_MATRIX) {
+            glUniformMatrix4fv(state.matrix_uniforms[payload.matrix], 1, GL_FALSE, payload.values);
+        }
+        break;
+    }
+    case TRACE_GEN_TEXTURE: {
+        GLuint texture;
+        glGenTextures(1, &texture);
+        state.textures[read_payload<TraceTexture>(command).texture] = texture;
+        break;
+    }
+    case TRACE_BIND_TEXTURE: {
+        TraceBindTexture payload = read_payload<TraceBindTexture>(command);
+        auto found = state.textures.find(payload.texture);
+        glBindTexture(payload.target, found != state.textures.end() ? found->second : 0);
+        break;
+    }
+    case TRACE_TEX_IMAGE_2D: {
+        TraceTexImage2D payload = read_payload<TraceTexImage2D>(command);
+        glTexImage2D(payload.target, payload.level, payload.internal_format, payload.width, payload.height, 0,
+            payload.format, payload.type, trailing_data<TraceTexImage2D>(command));
+        break;
+    }
+    case TRACE_TEX_PARAMETER: {
+        TraceTexParameter payload = read_payload<TraceTexParameter>(command);
+        glTexParameteri(payload.target, payload.name, payload.value);
+        break;
+    }
+    case TRACE_ENABLE_ATTRIBUTE:
+        glEnableVertexAttribArray(read_payload<TraceAttributeArray>(command).index);
+        break;
+    case TRACE_DISABLE_ATTRIBUTE:
+        glDisableVertexAttribArray(read_payload<TraceAttributeArray>(command).index);
+        break;
+    case TRACE_ATTRIBUTE_DATA: {
+        TraceAttributeData payload = read_payload<TraceAttributeData>(command);
+        glVertexAttribPointer(payload.index, payload.components, GL_FLOAT, GL_FALSE, 0, trailing_data<TraceAttributeData>(command));
+        break;
+    }
+    case TRACE_DRAW_ARRAYS: {
+        TraceDrawArrays payload = read_payload<TraceDrawArrays>(command);
+        glDrawArrays(payload.mode, payload.first, payload.count);
+        break;
+    }
+    case TRACE_GEN_FRAMEBUFFER: {
+        GLuint framebuffer;
+        glGenFramebuffers(1, &framebuffer);
+        state.framebuffers[read_payload<TraceFramebuffer>(command).framebuffer] = framebuffer;
+        break;
+    }
+    case TRACE_BIND_FRAMEBUFFER: {
+        TraceBindFramebuffer payload = read_payload<TraceBindFramebuffer>(command);
+        auto found = state.framebuffers.find(payload.framebuffer);
+        glBindFramebuffer(payload.target, found != state.framebuffers.end() ? found->second : 0);
+        break;
+    }
+    case TRACE_FRAMEBUFFER_TEXTURE: {
+        TraceFramebufferTexture payload = read_payload<TraceFramebufferTexture>(command);
+        auto found = state.textures.find(payload.texture);
+        glFramebufferTexture2D(payload.target, payload.attachment, payload.texture_target,
+            found != state.textures.end() ? found->second : 0, payload.level);
+        break;
+    }
+    default:
+        break;  // From a newer capture; skipped rather than guessed at
+    }
+}
+
+// ––––– REPORT ––––– //
+float percentile(std::vector<float> values, float fraction) {
+    if (values.empty()) return 0.0f;
+
+    int index = std::min((int)values.size() - 1, (int)(fraction * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+float mean(const std::vector<float>& values) {
+    if (values.empty()) return 0.0f;
+
+    double total = 0.0;
+    for (float value : values) total += value;
+    return (float)(total / values.size());
+}
+
+void print_trace_summary(const Trace& trace) {
+    std::size_t commands = 0, draws = 0, payload_bytes = 0;
+    for (const std::vector<TraceCommand>& frame : trace.frames) {
+        for (const TraceCommand& command : frame) {
+            commands++;
+            payload_bytes += command.payload_bytes;
+            if (command.op == TRACE_DRAW_ARRAYS) draws++;
+        }
+    }
+
+    std::size_t frames = trace.frames.size();
+    LOG(trace.setup.size() << " setup commands, " << frames << " frames");
+    LOG("Per frame: " << commands / frames << " commands, " << draws / frames << " draws, "
+        << payload_bytes / frames << " payload bytes");
+}
+
+// Usage: <trace> [--loops <n>] to replay every frame n times, [--csv <file>] to write each
+// frame's timing, [--dry-run] to decode the trace without creating a GL context
+int main(int argc, char* argv[])
+{
+    const char* trace_filepath = nullptr;
+    const char* csv_filepath = nullptr;
+    int loops = 10;
+    bool dry_run = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (std::strcmp(argv[i], "--dry-run") == 0) dry_run = true;
+        else if (std::strcmp(argv[i], "--loops") == 0 && i + 1 < argc) loops = std::max(1, std::atoi(argv[++i]));
+        else if (std::strcmp(argv[i], "--csv") == 0 && i + 1 < argc) csv_filepath = argv[++i];
+        else trace_filepath = argv[i];
+    }
+
+    if (trace_filepath == nullptr) {
+        LOG("Usage: gl_replay <trace> [--loops <n>] [--csv <file>] [--dry-run]");
+        return 1;
+    }
+
+    Trace trace;
+    if (!load_trace(trace_filepath, trace)) {
+        LOG("Unable to read GL trace " << trace_filepath);
+        return 1;
+    }
+    print_trace_summary(trace);
+    if (dry_run) return 0;
+
+    SDL_Init(SDL_INIT_VIDEO);
+    SDL_Window* window = SDL_CreateWindow("GL Replay", SDL_WINDOWPOS_CENTERED, SDL_WINDOWPOS_CENTERED,
+        WINDOW_WIDTH, WINDOW_HEIGHT, SDL_WINDOW_OPENGL | SDL_WINDOW_HIDDEN);
+    if (window == nullptr) {
+        LOG("Unable to create a window for the GL context");
+        SDL_Quit();
+        return 1;
+    }
+
+    SDL_GLContext context = SDL_GL_CreateContext(window);
+    SDL_GL_MakeCurrent(window, context);
+
+#ifdef _WINDOWS
+    glewInit();
+#endif
+
+    LOG("Renderer: " << (const char*)glGetString(GL_RENDERER) << ", " << (const char*)glGetString(GL_VERSION));
+
+    ReplayState state;
+    for (const TraceCommand& command : trace.setup) issue(command, state);
+    glFinish();
+
+    // Submit is the time to issue a frame's calls; total adds waiting for the GPU to finish them
+    std::vector<float> submit_microseconds, total_microseconds;
+    std::FILE* csv = csv_filepath != nullptr ? std::fopen(csv_filepath, "w") : nullptr;
+    if (csv != nullptr) std::fprintf(csv, "loop,frame,submit_us,total_us\n");
+
+    for (int loop = 0; loop < loops; loop++) {
+        for (std::size_t frame = 0; frame < trace.frames.size(); frame++) {
+            auto start = std::chrono::steady_clock::now();
+            for (const TraceCommand& command : trace.frames[frame]) issue(command, state);
+            auto submitted = std::chrono::steady_clock::now();
+            glFinish();
+            auto finished = std::chrono::steady_clock::now();
+
+            float submit = std::chrono::duration<float, std::micro>(submitted - start).count();
+            float total = std::chrono::duration<float, std::micro>(finished - start).count();
+            submit_microseconds.push_back(submit);
+            total_microseconds.push_back(total);
+            if (csv != nullptr) std::fprintf(csv, "%d,%zu,%.2f,%.2f\n", loop, frame, submit, total);
+        }
+    }
+    if (csv != nullptr) std::fclose(csv);
+
+    LOG("Submit us: mean " << mean(submit_microseconds) << ", p50 " << percentile(submit_microseconds, 0.5f)
+        << ", p99 " << percentile(submit_microseconds, 0.99f));
+    LOG("Total us:  mean " << mean(total_microseconds) << ", p50 " << percentile(total_microseconds, 0.5f)
+        << ", p99 " << percentile(total_microseconds, 0.99f));
+
+    SDL_GL_DeleteContext(context);
+    SDL_DestroyWindow(window);
+    SDL_Quit();
+    return 0;
+}